@@ -3,6 +3,7 @@
 #include "assets/asset_id.hpp"
 #include "assets/glyph_mesh_create_args.hpp"
 #include "assets/spine_load_args.hpp"
+#include "assets/texture_atlas_load_args.hpp"
 #include "assets/texture_load_args.hpp"
 #include "assets/texture_create_args.hpp"
 #include <memory>
@@ -69,6 +70,12 @@ public:
         const std::string& path,
         const TextureCreateArgs args = {}
     );
+    //  Packs images into one texture. Returns the texture ID; texture
+    //  coordinates of the entries are returned through the load args promise.
+    AssetId load_texture_atlas(
+        TextureAtlasLoadArgs& load_args,
+        const TextureCreateArgs args = {}
+    );
     void unload_model(const AssetId id);
     void unload_models();
     void shutdown();
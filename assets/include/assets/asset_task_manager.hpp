@@ -4,6 +4,7 @@
 #include "assets/glyph_mesh_create_args.hpp"
 #include "assets/spine_load_args.hpp"
 #include "assets/texture_asset.hpp"
+#include "assets/texture_atlas_load_args.hpp"
 #include "assets/texture_create_args.hpp"
 #include "assets/texture_load_args.hpp"
 #include <future>
@@ -47,5 +48,12 @@ public:
         TextureLoadArgs& load_args,
         const TextureCreateArgs& args
     ) = 0;
+    //  Enqueues a job packing images into a single texture for worker
+    //  threads to complete
+    virtual void load_texture_atlas(
+        AssetId id,
+        TextureAtlasLoadArgs& load_args,
+        const TextureCreateArgs& args
+    ) = 0;
 };
 }
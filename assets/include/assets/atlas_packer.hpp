@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace assets
+{
+//  Rectangle in pixels
+struct AtlasRect
+{
+    uint32_t x {0};
+    uint32_t y {0};
+    uint32_t width {0};
+    uint32_t height {0};
+};
+
+//  Packs rectangles into a fixed size page using the skyline bottom-left
+//  heuristic. Each rectangle is placed where its top edge is lowest, so
+//  packing them in order of decreasing height gives the best results.
+class AtlasPacker
+{
+    //  Horizontal segment of the skyline
+    struct Node
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    uint32_t m_width {0};
+    uint32_t m_height {0};
+    //  Gap left to the right of and below each rectangle
+    uint32_t m_padding {0};
+    //  Segments sorted by x that together span the page width
+    std::vector<Node> m_skyline;
+
+    bool fits(
+        const size_t index,
+        const uint32_t width,
+        const uint32_t height,
+        uint32_t& y
+    ) const;
+    void merge();
+
+public:
+    AtlasPacker(
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t padding = 1
+    );
+    inline uint32_t get_height() const {
+        return m_height;
+    }
+    inline uint32_t get_width() const {
+        return m_width;
+    }
+    //  Finds space for a rectangle. Returns false if the page is full.
+    bool pack(const uint32_t width, const uint32_t height, AtlasRect& rect);
+    void reset();
+};
+}
@@ -16,6 +16,8 @@ struct GlyphMeshCreateArgs
         glm::vec3 position;
         glm::vec4 bg_color;
         glm::vec4 fg_color;
+        //  Texture coordinates within the texture. Offset is xy and size is zw.
+        glm::vec4 uv_rect {0.0f, 0.0f, 1.0f, 1.0f};
     };
 
     std::vector<Glyph> glyphs;
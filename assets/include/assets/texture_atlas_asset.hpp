@@ -0,0 +1,20 @@
+#pragma once
+
+#include "assets/asset_id.hpp"
+#include <glm/vec4.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace assets
+{
+struct TextureAtlasAsset
+{
+    //  Texture holding every entry
+    AssetId texture_id {0};
+    uint32_t width     {0};
+    uint32_t height    {0};
+    //  Texture coordinates of each entry in load order. Offset is xy and
+    //  size is zw.
+    std::vector<glm::vec4> uv_rects;
+};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "assets/texture_atlas_asset.hpp"
+#include <cassert>
+#include <future>
+#include <optional>
+
+namespace assets
+{
+using TextureAtlasAssetPromise = std::optional<std::promise<TextureAtlasAsset>>;
+using TextureAtlasAssetFuture = std::future<TextureAtlasAsset>;
+
+inline TextureAtlasAssetPromise make_texture_atlas_asset_promise() {
+    return std::make_optional<std::promise<TextureAtlasAsset>>();
+}
+
+inline TextureAtlasAssetFuture get_texture_atlas_asset_future(
+    TextureAtlasAssetPromise& promise
+) {
+    assert(promise.has_value());
+    return promise.value().get_future();
+}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "assets/texture_atlas_asset_promise.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace assets
+{
+struct TextureAtlasLoadArgs
+{
+    //  Unique name of the atlas, used in place of a texture path
+    std::string name;
+    //  Paths to image files packed into the atlas
+    std::vector<std::string> paths;
+    //  Size of the atlas page. Loading fails if the images do not fit.
+    uint32_t width  {1024};
+    uint32_t height {1024};
+    //  Optional promise fulfilled after the atlas has loaded
+    TextureAtlasAssetPromise promise;
+};
+}
@@ -2,6 +2,7 @@
 
 #include "assets/texture_address_mode.hpp"
 #include "assets/texture_filter.hpp"
+#include "assets/texture_format.hpp"
 
 namespace assets
 {
@@ -12,5 +13,7 @@ struct TextureCreateArgs
     TextureAddressMode address_mode {TextureAddressMode::Clamp};
     TextureFilter mag_filter {TextureFilter::Linear};
     TextureFilter min_filter {TextureFilter::Linear};
+    //  Falls back to Rgba8 if the device can't sample the format
+    TextureFormat format {TextureFormat::Rgba8};
 };
 }
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "assets/texture_format.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace assets
+{
+//  Bytes needed for one mip level of a texture
+size_t get_texture_level_size(
+    const TextureFormat format,
+    const uint32_t width,
+    const uint32_t height
+);
+
+//  Block compressed formats can't be blitted, so their mip levels must be
+//  built on the CPU
+bool is_block_compressed(const TextureFormat format);
+
+//  Converts 8-bit RGBA pixels to a texture format. Writes level_count mip
+//  levels one after the other, each half the size of the previous one.
+void encode_texture(
+    const std::vector<unsigned char>& image,
+    const uint32_t width,
+    const uint32_t height,
+    const TextureFormat format,
+    const uint32_t level_count,
+    std::vector<unsigned char>& data
+);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace assets
+{
+//  Format textures are stored in on the GPU. Images are always decoded to
+//  8-bit RGBA and converted when the texture is created.
+enum class TextureFormat
+{
+    //  Uncompressed sRGB color with alpha
+    Rgba8,
+    //  Alpha mask. Sampled as white with the stored value as alpha.
+    R8,
+    //  Luminance and alpha. Sampled as gray from red with alpha from green.
+    R8G8,
+    //  Block compressed sRGB color without alpha (4 bits per pixel)
+    Bc1,
+    //  Block compressed sRGB color with alpha (8 bits per pixel)
+    Bc3,
+};
+}
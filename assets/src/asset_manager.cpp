@@ -199,6 +199,36 @@ AssetId AssetManager::load_texture(
     return load_texture(load_args, args);
 }
 
+//  ----------------------------------------------------------------------------
+AssetId AssetManager::load_texture_atlas(
+    TextureAtlasLoadArgs& load_args,
+    const TextureCreateArgs create_args
+) {
+    //  Atlases share the texture list, keyed by name
+    const AssetId existing_id = get_texture_id(load_args.name);
+    if (existing_id != 0) {
+        return existing_id;
+    }
+
+    const AssetId id = get_unique_texture_id();
+
+    m_asset_task_mgr->load_texture_atlas(id, load_args, create_args);
+
+    Entry entry{};
+    entry.id = id;
+    entry.path = load_args.name;
+    m_textures.push_back(entry);
+
+    log_debug(
+        "Loaded texture atlas '%s' (%d) with %d entries.",
+        load_args.name.c_str(),
+        id,
+        static_cast<int>(load_args.paths.size())
+    );
+
+    return id;
+}
+
 //  ----------------------------------------------------------------------------
 void AssetManager::unload_model(const AssetId id) {
     auto find = std::find_if(
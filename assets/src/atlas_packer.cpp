@@ -0,0 +1,140 @@
+#include "assets/atlas_packer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace assets
+{
+//  ----------------------------------------------------------------------------
+AtlasPacker::AtlasPacker(
+    const uint32_t width,
+    const uint32_t height,
+    const uint32_t padding
+)
+: m_width(width),
+  m_height(height),
+  m_padding(padding) {
+    reset();
+}
+
+//  ----------------------------------------------------------------------------
+//  Checks if a rectangle fits with its left edge at the start of a skyline
+//  segment. y is set to the lowest position the rectangle can rest at.
+bool AtlasPacker::fits(
+    const size_t index,
+    const uint32_t width,
+    const uint32_t height,
+    uint32_t& y
+) const {
+    const uint32_t x = m_skyline[index].x;
+    if (x + width > m_width) {
+        return false;
+    }
+
+    //  Rest on the highest segment under the rectangle
+    y = 0;
+    int64_t width_left = width;
+    for (size_t n = index; width_left > 0; ++n) {
+        assert(n < m_skyline.size());
+
+        y = std::max(y, m_skyline[n].y);
+        if (y + height > m_height) {
+            return false;
+        }
+
+        width_left -= m_skyline[n].width;
+    }
+
+    return true;
+}
+
+//  ----------------------------------------------------------------------------
+//  Joins neighboring segments at the same height
+void AtlasPacker::merge() {
+    for (size_t n = 1; n < m_skyline.size();) {
+        if (m_skyline[n - 1].y == m_skyline[n].y) {
+            m_skyline[n - 1].width += m_skyline[n].width;
+            m_skyline.erase(m_skyline.begin() + n);
+        } else {
+            ++n;
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+bool AtlasPacker::pack(
+    const uint32_t width,
+    const uint32_t height,
+    AtlasRect& rect
+) {
+    const uint32_t padded_width = width + m_padding;
+    const uint32_t padded_height = height + m_padding;
+
+    //  Find the position with the lowest top edge, then the narrowest segment
+    size_t best_index = SIZE_MAX;
+    uint32_t best_top = std::numeric_limits<uint32_t>::max();
+    uint32_t best_width = std::numeric_limits<uint32_t>::max();
+    uint32_t best_y = 0;
+
+    for (size_t n = 0; n < m_skyline.size(); ++n) {
+        uint32_t y = 0;
+        if (!fits(n, padded_width, padded_height, y)) {
+            continue;
+        }
+
+        const uint32_t top = y + padded_height;
+        if (
+            top < best_top ||
+            (top == best_top && m_skyline[n].width < best_width)
+        ) {
+            best_index = n;
+            best_top = top;
+            best_width = m_skyline[n].width;
+            best_y = y;
+        }
+    }
+
+    if (best_index == SIZE_MAX) {
+        return false;
+    }
+
+    rect.x = m_skyline[best_index].x;
+    rect.y = best_y;
+    rect.width = width;
+    rect.height = height;
+
+    //  Raise the skyline under the rectangle
+    const Node node {rect.x, best_top, padded_width};
+    m_skyline.insert(m_skyline.begin() + best_index, node);
+
+    //  Trim segments now covered by the new one
+    const uint32_t right = node.x + node.width;
+    for (size_t n = best_index + 1; n < m_skyline.size();) {
+        Node& next = m_skyline[n];
+        if (next.x >= right) {
+            break;
+        }
+
+        const uint32_t overlap = right - next.x;
+        if (next.width <= overlap) {
+            m_skyline.erase(m_skyline.begin() + n);
+        } else {
+            next.x += overlap;
+            next.width -= overlap;
+            break;
+        }
+    }
+
+    merge();
+
+    return true;
+}
+
+//  ----------------------------------------------------------------------------
+void AtlasPacker::reset() {
+    m_skyline.clear();
+    m_skyline.push_back({0, 0, m_width});
+}
+}
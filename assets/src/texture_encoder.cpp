@@ -0,0 +1,303 @@
+#include "assets/texture_encoder.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace assets
+{
+//  ----------------------------------------------------------------------------
+static uint16_t pack_565(const int r, const int g, const int b) {
+    return static_cast<uint16_t>(
+        ((r * 31 + 127) / 255) << 11 |
+        ((g * 63 + 127) / 255) << 5 |
+        ((b * 31 + 127) / 255)
+    );
+}
+
+//  ----------------------------------------------------------------------------
+static void unpack_565(const uint16_t color, int rgb[3]) {
+    const int r = (color >> 11) & 31;
+    const int g = (color >> 5) & 63;
+    const int b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+//  ----------------------------------------------------------------------------
+//  Encodes the color of a 4x4 block as BC1 using the corners of the block's
+//  bounding box as endpoints. Always uses the four color mode.
+static void encode_bc1_block(const unsigned char block[64], unsigned char* out) {
+    int min_rgb[3] {255, 255, 255};
+    int max_rgb[3] {0, 0, 0};
+    for (int n = 0; n < 16; ++n) {
+        for (int c = 0; c < 3; ++c) {
+            min_rgb[c] = std::min<int>(min_rgb[c], block[n * 4 + c]);
+            max_rgb[c] = std::max<int>(max_rgb[c], block[n * 4 + c]);
+        }
+    }
+
+    //  Inset the box slightly to reduce the error of the end points
+    for (int c = 0; c < 3; ++c) {
+        const int inset = (max_rgb[c] - min_rgb[c]) / 16;
+        min_rgb[c] += inset;
+        max_rgb[c] -= inset;
+    }
+
+    uint16_t color0 = pack_565(max_rgb[0], max_rgb[1], max_rgb[2]);
+    uint16_t color1 = pack_565(min_rgb[0], min_rgb[1], min_rgb[2]);
+
+    //  Four color mode requires color0 > color1
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int n = 0; n < 16; ++n) {
+            int best_index = 0;
+            int best_error = INT32_MAX;
+            for (int i = 0; i < 4; ++i) {
+                int error = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const int d = block[n * 4 + c] - palette[i][c];
+                    error += d * d;
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = i;
+                }
+            }
+            indices |= static_cast<uint32_t>(best_index) << (n * 2);
+        }
+    }
+
+    out[0] = color0 & 0xff;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xff;
+    out[3] = color1 >> 8;
+    for (int n = 0; n < 4; ++n) {
+        out[4 + n] = (indices >> (n * 8)) & 0xff;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+//  Encodes the alpha of a 4x4 block as a BC3 alpha block using the eight
+//  value mode
+static void encode_bc3_alpha_block(const unsigned char block[64], unsigned char* out) {
+    int alpha0 = 0;
+    int alpha1 = 255;
+    for (int n = 0; n < 16; ++n) {
+        alpha0 = std::max<int>(alpha0, block[n * 4 + 3]);
+        alpha1 = std::min<int>(alpha1, block[n * 4 + 3]);
+    }
+
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        int palette[8];
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+
+        for (int n = 0; n < 16; ++n) {
+            const int alpha = block[n * 4 + 3];
+            int best_index = 0;
+            int best_error = INT32_MAX;
+            for (int i = 0; i < 8; ++i) {
+                const int error = std::abs(alpha - palette[i]);
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = i;
+                }
+            }
+            indices |= static_cast<uint64_t>(best_index) << (n * 3);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(alpha0);
+    out[1] = static_cast<unsigned char>(alpha1);
+    for (int n = 0; n < 6; ++n) {
+        out[2 + n] = (indices >> (n * 8)) & 0xff;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+static void encode_blocks(
+    const unsigned char* image,
+    const uint32_t width,
+    const uint32_t height,
+    const TextureFormat format,
+    unsigned char* out
+) {
+    const uint32_t block_size = format == TextureFormat::Bc1 ? 8 : 16;
+
+    unsigned char block[64];
+    for (uint32_t by = 0; by < height; by += 4) {
+        for (uint32_t bx = 0; bx < width; bx += 4) {
+            //  Repeat edge pixels of partial blocks
+            for (uint32_t y = 0; y < 4; ++y) {
+                for (uint32_t x = 0; x < 4; ++x) {
+                    const uint32_t sx = std::min(bx + x, width - 1);
+                    const uint32_t sy = std::min(by + y, height - 1);
+                    std::memcpy(
+                        &block[(y * 4 + x) * 4],
+                        &image[(size_t(sy) * width + sx) * 4],
+                        4
+                    );
+                }
+            }
+
+            if (format == TextureFormat::Bc3) {
+                encode_bc3_alpha_block(block, out);
+                encode_bc1_block(block, out + 8);
+            } else {
+                encode_bc1_block(block, out);
+            }
+
+            out += block_size;
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+//  Halves the size of an image with a box filter
+static void downsample(
+    const std::vector<unsigned char>& src,
+    const uint32_t width,
+    const uint32_t height,
+    std::vector<unsigned char>& dst
+) {
+    const uint32_t dst_width = std::max(width / 2, 1u);
+    const uint32_t dst_height = std::max(height / 2, 1u);
+    dst.resize(size_t(dst_width) * dst_height * 4);
+
+    for (uint32_t y = 0; y < dst_height; ++y) {
+        const uint32_t y0 = std::min(y * 2, height - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < dst_width; ++x) {
+            const uint32_t x0 = std::min(x * 2, width - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c = 0; c < 4; ++c) {
+                const int sum =
+                    src[(size_t(y0) * width + x0) * 4 + c] +
+                    src[(size_t(y0) * width + x1) * 4 + c] +
+                    src[(size_t(y1) * width + x0) * 4 + c] +
+                    src[(size_t(y1) * width + x1) * 4 + c];
+                dst[(size_t(y) * dst_width + x) * 4 + c] =
+                    static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void encode_texture(
+    const std::vector<unsigned char>& image,
+    const uint32_t width,
+    const uint32_t height,
+    const TextureFormat format,
+    const uint32_t level_count,
+    std::vector<unsigned char>& data
+) {
+    assert(image.size() == size_t(width) * height * 4);
+    assert(level_count > 0);
+
+    size_t data_size = 0;
+    for (uint32_t n = 0; n < level_count; ++n) {
+        data_size += get_texture_level_size(
+            format,
+            std::max(width >> n, 1u),
+            std::max(height >> n, 1u)
+        );
+    }
+    data.resize(data_size);
+
+    std::vector<unsigned char> level;
+    std::vector<unsigned char> next_level;
+    const std::vector<unsigned char>* src = &image;
+
+    uint32_t level_width = width;
+    uint32_t level_height = height;
+    unsigned char* out = data.data();
+
+    for (uint32_t n = 0; n < level_count; ++n) {
+        const size_t pixel_count = size_t(level_width) * level_height;
+
+        switch (format) {
+            default:
+                throw std::runtime_error("Texture format not implemented.");
+            case TextureFormat::Rgba8:
+                std::memcpy(out, src->data(), pixel_count * 4);
+                break;
+            case TextureFormat::R8:
+                for (size_t p = 0; p < pixel_count; ++p) {
+                    out[p] = (*src)[p * 4 + 3];
+                }
+                break;
+            case TextureFormat::R8G8:
+                for (size_t p = 0; p < pixel_count; ++p) {
+                    out[p * 2] = (*src)[p * 4];
+                    out[p * 2 + 1] = (*src)[p * 4 + 3];
+                }
+                break;
+            case TextureFormat::Bc1:
+            case TextureFormat::Bc3:
+                encode_blocks(src->data(), level_width, level_height, format, out);
+                break;
+        }
+
+        out += get_texture_level_size(format, level_width, level_height);
+
+        if (n + 1 < level_count) {
+            downsample(*src, level_width, level_height, next_level);
+            std::swap(level, next_level);
+            src = &level;
+            level_width = std::max(level_width / 2, 1u);
+            level_height = std::max(level_height / 2, 1u);
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+size_t get_texture_level_size(
+    const TextureFormat format,
+    const uint32_t width,
+    const uint32_t height
+) {
+    const size_t block_count =
+        size_t((width + 3) / 4) * ((height + 3) / 4);
+
+    switch (format) {
+        default:
+            throw std::runtime_error("Texture format not implemented.");
+        case TextureFormat::Rgba8:
+            return size_t(width) * height * 4;
+        case TextureFormat::R8:
+            return size_t(width) * height;
+        case TextureFormat::R8G8:
+            return size_t(width) * height * 2;
+        case TextureFormat::Bc1:
+            return block_count * 8;
+        case TextureFormat::Bc3:
+            return block_count * 16;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+bool is_block_compressed(const TextureFormat format) {
+    return format == TextureFormat::Bc1 || format == TextureFormat::Bc3;
+}
+}
@@ -0,0 +1,104 @@
+#include "common/job_queue.hpp"
+#include "common/mpmc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace common;
+
+//  Compares MpmcQueue against JobQueue moving pointer sized values between
+//  producer and consumer threads.
+//
+//  Usage: mpmc_queue_bench [threads] [values]
+
+//  ----------------------------------------------------------------------------
+template <typename Queue, typename Push>
+static double run(
+    Queue& queue,
+    Push push,
+    const size_t producer_count,
+    const size_t consumer_count,
+    const size_t value_count
+) {
+    std::atomic<size_t> consumed {0};
+    std::vector<std::thread> threads;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t n = 0; n < consumer_count; ++n) {
+        threads.emplace_back([&queue, &consumed, value_count]() {
+            size_t value = 0;
+            while (queue.wait_and_pop(value)) {
+                if (consumed.fetch_add(1) + 1 == value_count) {
+                    queue.cancel();
+                }
+            }
+        });
+    }
+
+    for (size_t n = 0; n < producer_count; ++n) {
+        const size_t first = value_count * n / producer_count;
+        const size_t last = value_count * (n + 1) / producer_count;
+        threads.emplace_back([&queue, push, first, last]() {
+            for (size_t value = first; value < last; ++value) {
+                push(queue, value);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return value_count / elapsed.count();
+}
+
+//  ----------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+    const size_t thread_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    const size_t value_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000000;
+
+    for (size_t producers = 1; producers <= thread_count; producers *= 2) {
+        const size_t consumers = thread_count;
+
+        JobQueue<size_t> job_queue;
+        const double job_rate = run(
+            job_queue,
+            [](JobQueue<size_t>& queue, size_t value) {
+                queue.push(std::move(value));
+            },
+            producers,
+            consumers,
+            value_count
+        );
+
+        MpmcQueue<size_t> mpmc_queue(4096);
+        const double mpmc_rate = run(
+            mpmc_queue,
+            [](MpmcQueue<size_t>& queue, const size_t value) {
+                while (!queue.try_push(value)) {
+                    std::this_thread::yield();
+                }
+            },
+            producers,
+            consumers,
+            value_count
+        );
+
+        std::printf(
+            "%zu producers, %zu consumers: JobQueue %.2f M/s, MpmcQueue %.2f M/s\n",
+            producers,
+            consumers,
+            job_rate / 1e6,
+            mpmc_rate / 1e6
+        );
+    }
+
+    return 0;
+}
@@ -1,5 +1,13 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
 #include <stdlib.h>
 
 namespace common
@@ -8,4 +16,163 @@ namespace common
 //  Wrapper functions for aligned memory allocation.
 //  Requires alignment to be a power of two.
 void* aligned_alloc(size_t size, size_t alignment);
+void aligned_free(void* data);
+
+//  ----------------------------------------------------------------------------
+//  Standard allocator that aligns storage to Alignment bytes, e.g. so arrays
+//  can be loaded with aligned SIMD instructions.
+template <typename T, size_t Alignment = 32>
+class AlignedAllocator
+{
+    static_assert(
+        (Alignment & (Alignment - 1)) == 0,
+        "Alignment must be a power of two."
+    );
+
+    static_assert(
+        Alignment >= alignof(T),
+        "Alignment must be at least the alignment of T."
+    );
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {
+    }
+
+    T* allocate(const size_t count) {
+        //  posix_memalign requires at least pointer alignment
+        const size_t alignment =
+            Alignment < sizeof(void*) ? sizeof(void*) : Alignment;
+
+        void* data = aligned_alloc(count * sizeof(T), alignment);
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<T*>(data);
+    }
+
+    void deallocate(T* data, const size_t) {
+        aligned_free(data);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const {
+        return false;
+    }
+};
+
+//  ----------------------------------------------------------------------------
+//  Bump allocator for transient data, e.g. data that only lives for a frame.
+//  Allocations are never freed individually; reset() releases everything at
+//  once. Memory is allocated in blocks that are kept between resets, so once
+//  the arena has grown to fit a frame's data it stops allocating.
+//
+//  Not thread-safe. Use one arena per thread.
+class LinearArena
+{
+    struct BlockDeleter
+    {
+        void operator()(uint8_t* data) const {
+            aligned_free(data);
+        }
+    };
+
+    struct Block
+    {
+        std::unique_ptr<uint8_t, BlockDeleter> data;
+        size_t size {0};
+        size_t used {0};
+    };
+
+    //  Alignment of each block
+    static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+    size_t m_block_size;
+    //  Index of the block currently being allocated from
+    size_t m_block_index {0};
+    std::vector<Block> m_blocks;
+
+    void add_block(size_t size);
+
+public:
+    LinearArena(size_t block_size = 64 * 1024);
+    LinearArena(LinearArena&&) = default;
+    LinearArena& operator=(LinearArena&&) = default;
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    //  Requires alignment to be a power of two no greater than 64
+    void* allocate(size_t size, size_t alignment);
+    //  Total size of all blocks
+    size_t get_capacity() const;
+    //  Bytes allocated since the last reset (including alignment padding)
+    size_t get_used() const;
+    //  Releases all allocations. If more than one block was needed, they are
+    //  replaced with one block large enough for all of them.
+    void reset();
+};
+
+//  ----------------------------------------------------------------------------
+//  Standard allocator that allocates from a LinearArena. deallocate() does
+//  nothing, so containers that grow should reserve up front.
+template <typename T>
+class ArenaAllocator
+{
+    LinearArena* m_arena;
+
+public:
+    using value_type = T;
+
+    ArenaAllocator(LinearArena& arena)
+    : m_arena(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+    : m_arena(other.get_arena()) {
+    }
+
+    T* allocate(const size_t count) {
+        return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, const size_t) {
+    }
+
+    LinearArena* get_arena() const {
+        return m_arena;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return m_arena == other.get_arena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return m_arena != other.get_arena();
+    }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename K, typename V, typename Compare = std::less<K>>
+using ArenaMap = std::map<K, V, Compare, ArenaAllocator<std::pair<const K, V>>>;
 }
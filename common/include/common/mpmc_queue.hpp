@@ -0,0 +1,260 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace common
+{
+//  Bounded lock-free multi-producer multi-consumer queue (Vyukov).
+//
+//  Each cell holds a sequence number that tells producers and consumers
+//  whether it is free for the position they claimed, so pushing and popping
+//  only contend on the position counters. Positions and cells are padded to
+//  cache lines to avoid false sharing.
+//
+//  try_push() fails when the queue is full and try_pop() fails when it is
+//  empty. wait_and_pop() blocks until a value is available or the queue is
+//  canceled; the mutex it sleeps on is only used when a consumer is waiting.
+//
+//  T must be default constructible and move assignable.
+template <typename T>
+class MpmcQueue
+{
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct alignas(CACHE_LINE_SIZE) Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueue_pos {0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeue_pos {0};
+
+    //  Consumers sleeping in wait_and_pop()
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_waiting {0};
+    std::atomic<bool> m_cancel {false};
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    template <typename U>
+    bool push_value(U&& value) {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                //  Cell is free, try to claim it
+                if (m_enqueue_pos.compare_exchange_weak(
+                    pos,
+                    pos + 1,
+                    std::memory_order_relaxed
+                )) {
+                    break;
+                }
+            } else if (diff < 0) {
+                //  Full
+                return false;
+            } else {
+                //  Another producer claimed the position
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::forward<U>(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //  True once the value at the dequeue position is published. A producer
+    //  that claimed a position but hasn't stored its value yet doesn't count.
+    bool has_value() const {
+        const size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        const Cell& cell = m_cells[pos & m_mask];
+        return cell.sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    void notify_waiting() {
+        //  Pairs with the increment in wait_and_pop() so either the consumer
+        //  sees the value or this sees the consumer.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_condition.notify_one();
+        }
+    }
+
+public:
+    //  capacity must be a power of two
+    MpmcQueue(const size_t capacity)
+    : m_mask(capacity - 1) {
+        if (capacity < 2 || (capacity & m_mask) != 0) {
+            throw std::runtime_error("MPMC queue capacity must be a power of two.");
+        }
+
+        m_cells.reset(new Cell[capacity]);
+        for (size_t n = 0; n < capacity; ++n) {
+            m_cells[n].sequence.store(n, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancel = true;
+        }
+        m_condition.notify_all();
+    }
+
+    size_t capacity() const {
+        return m_mask + 1;
+    }
+
+    //  Only exact while no other thread is using the queue
+    bool empty() const {
+        return size() == 0;
+    }
+
+    bool is_canceled() const {
+        return m_cancel;
+    }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancel = false;
+    }
+
+    //  Only exact while no other thread is using the queue
+    size_t size() const {
+        const size_t dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        const size_t enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+    bool try_pop(T& value) {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                //  Cell has a value, try to claim it
+                if (m_dequeue_pos.compare_exchange_weak(
+                    pos,
+                    pos + 1,
+                    std::memory_order_relaxed
+                )) {
+                    break;
+                }
+            } else if (diff < 0) {
+                //  Empty
+                return false;
+            } else {
+                //  Another consumer claimed the position
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    //  Appends up to max_count values to values. Returns the number popped.
+    size_t try_pop_batch(std::vector<T>& values, const size_t max_count) {
+        size_t count = 0;
+        T value;
+        while (count < max_count && try_pop(value)) {
+            values.push_back(std::move(value));
+            ++count;
+        }
+        return count;
+    }
+
+    bool try_push(const T& value) {
+        if (!push_value(value)) {
+            return false;
+        }
+        notify_waiting();
+        return true;
+    }
+
+    bool try_push(T&& value) {
+        if (!push_value(std::move(value))) {
+            return false;
+        }
+        notify_waiting();
+        return true;
+    }
+
+    //  Moves values from [first, last) until the queue is full and wakes at
+    //  most one waiting consumer per value. Returns the number pushed.
+    template <typename Iterator>
+    size_t try_push_batch(Iterator first, const Iterator last) {
+        size_t count = 0;
+        for (; first != last && push_value(std::move(*first)); ++first) {
+            ++count;
+        }
+
+        if (count > 0) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waiting.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (count == 1) {
+                    m_condition.notify_one();
+                } else {
+                    m_condition.notify_all();
+                }
+            }
+        }
+
+        return count;
+    }
+
+    //  Waits until a value is popped or the queue is canceled.
+    //  Returns true if the value was popped from the queue.
+    //  Returns false if the queue was canceled.
+    bool wait_and_pop(T& value) {
+        while (true) {
+            if (m_cancel) {
+                return false;
+            }
+
+            if (try_pop(value)) {
+                return true;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waiting.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_condition.wait(
+                lock,
+                [this] {
+                    return has_value() || m_cancel;
+                }
+            );
+            m_waiting.fetch_sub(1);
+        }
+    }
+};
+}
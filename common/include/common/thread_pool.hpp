@@ -0,0 +1,123 @@
+#pragma once
+
+#include "common/work_stealing_deque.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace common
+{
+//  Engine-wide set of worker threads shared by systems that need to split
+//  work across cores.
+//
+//  Each worker owns a work-stealing deque. Tasks pushed by a worker go to its
+//  own deque and are run newest first; tasks pushed by other threads go to a
+//  shared queue and are run in the order they were pushed. Idle workers take
+//  from their own deque, then the shared queue, then steal from other
+//  workers.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+    //  Processes the range [begin, end).
+    using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+    //  Returned by get_worker_index() for threads that are not workers
+    static constexpr size_t NOT_WORKER = std::numeric_limits<size_t>::max();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> m_deques;
+
+    //  Tasks pushed by threads that are not workers
+    std::mutex m_queue_mutex;
+    std::deque<Task*> m_queue;
+
+    //  Tasks pushed but not yet taken by a thread
+    std::atomic<size_t> m_pending {0};
+    //  Workers waiting on m_wake_condition
+    std::atomic<size_t> m_sleeping {0};
+    bool m_stop {false};
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake_condition;
+
+    void thread_main(size_t thread_id);
+    Task* take_task(size_t worker_index);
+
+public:
+    ThreadPool() = default;
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t get_thread_count() const {
+        return m_threads.size();
+    }
+
+    //  Gets the index [0, thread count) of the calling worker thread or
+    //  NOT_WORKER if the calling thread is not a worker of this pool.
+    size_t get_worker_index() const;
+
+    //  Splits [0, count) into chunks of at most chunk_size and processes them
+    //  on the worker threads and the calling thread. Each index belongs to
+    //  exactly one chunk. Blocks until every chunk has been processed.
+    //  Runs on the calling thread only if there are no workers or the range
+    //  fits in a single chunk.
+    void parallel_for(size_t count, size_t chunk_size, const RangeFunc& func);
+    void push(Task task);
+    void start(size_t thread_count);
+    //  Runs tasks that are still queued then joins the worker threads.
+    void stop();
+    //  Runs one queued task on the calling worker thread. Returns false if
+    //  there was no task or the calling thread is not a worker.
+    bool try_run_task();
+};
+
+//  Set of tasks that can be waited on together.
+//
+//  Waiting from a worker thread runs other queued tasks until the group is
+//  complete, so groups can be nested without blocking workers. The first
+//  exception thrown by a task is rethrown by wait().
+class TaskGroup
+{
+    using Task = ThreadPool::Task;
+
+    ThreadPool& m_thread_pool;
+    std::atomic<size_t> m_pending {0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    //  Set by the last task to complete. Only changed while m_mutex is held
+    //  so waiters can't return before the completing task is done with the
+    //  group.
+    bool m_idle {true};
+    std::exception_ptr m_exception;
+    std::vector<Task> m_continuations;
+
+    void complete_task();
+
+public:
+    TaskGroup(ThreadPool& thread_pool);
+    ~TaskGroup();
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    bool is_complete() const {
+        return m_pending.load() == 0;
+    }
+
+    void run(Task task);
+    //  Pushes continuation to the pool once every task in the group has
+    //  completed, or immediately if the group is already complete.
+    void then(Task continuation);
+    void wait();
+};
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace common
+{
+//  Chase-Lev work-stealing deque.
+//
+//  The owning thread pushes and pops at the bottom (LIFO), other threads
+//  steal from the top (FIFO). Only push() and pop() take the owner path so
+//  they must only be called by the owning thread. steal() can be called by
+//  any thread. The array grows when full; retired arrays are kept until the
+//  deque is destroyed because a thief may still be reading from them.
+//
+//  Memory orders follow Le et al., "Correct and Efficient Work-Stealing for
+//  Weak Memory Models" (2013).
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "WorkStealingDeque elements must be trivially copyable."
+    );
+
+    class Array
+    {
+        int64_t m_capacity;
+        int64_t m_mask;
+        std::unique_ptr<std::atomic<T>[]> m_items;
+
+    public:
+        Array(const int64_t capacity)
+        : m_capacity(capacity),
+          m_mask(capacity - 1),
+          m_items(std::make_unique<std::atomic<T>[]>(capacity)) {
+            assert((capacity & m_mask) == 0);
+        }
+
+        int64_t capacity() const {
+            return m_capacity;
+        }
+
+        T get(const int64_t index) const {
+            return m_items[index & m_mask].load(std::memory_order_relaxed);
+        }
+
+        void put(const int64_t index, const T value) {
+            m_items[index & m_mask].store(value, std::memory_order_relaxed);
+        }
+
+        //  Copies [top, bottom) into a new array twice the size
+        Array* grow(const int64_t top, const int64_t bottom) const {
+            Array* array = new Array(m_capacity * 2);
+            for (int64_t n = top; n < bottom; ++n) {
+                array->put(n, get(n));
+            }
+            return array;
+        }
+    };
+
+    std::atomic<int64_t> m_top {0};
+    std::atomic<int64_t> m_bottom {0};
+    std::atomic<Array*> m_array;
+    //  Every array allocated, including the current one
+    std::vector<std::unique_ptr<Array>> m_arrays;
+
+public:
+    WorkStealingDeque(const int64_t capacity = 1024) {
+        m_arrays.push_back(std::make_unique<Array>(capacity));
+        m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    bool empty() const {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_relaxed);
+        return bottom <= top;
+    }
+
+    //  Owner only. Returns false if the deque is empty.
+    bool pop(T& value) {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array* array = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            //  Empty
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const T item = array->get(bottom);
+
+        if (top == bottom) {
+            //  Last item, race against thieves for it
+            const bool won = m_top.compare_exchange_strong(
+                top,
+                top + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed
+            );
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                //  A thief took it, leave value untouched
+                return false;
+            }
+        }
+
+        value = item;
+        return true;
+    }
+
+    //  Owner only
+    void push(const T value) {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        Array* array = m_array.load(std::memory_order_relaxed);
+
+        if (bottom - top > array->capacity() - 1) {
+            array = array->grow(top, bottom);
+            m_arrays.emplace_back(array);
+            m_array.store(array, std::memory_order_release);
+        }
+
+        array->put(bottom, value);
+        //  Release store instead of a release fence, equivalent here and
+        //  understood by thread sanitizers
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    //  Any thread. Returns false if the deque is empty or another thread
+    //  took the item first.
+    bool steal(T& value) {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return false;
+        }
+
+        Array* array = m_array.load(std::memory_order_acquire);
+        value = array->get(top);
+
+        return m_top.compare_exchange_strong(
+            top,
+            top + 1,
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed
+        );
+    }
+};
+}
@@ -1,3 +1,6 @@
+#include "common/alloc.hpp"
+#include <algorithm>
+#include <cassert>
 #include <malloc.h>
 #include <stdlib.h>
 
@@ -21,4 +24,91 @@ void* aligned_alloc(size_t size, size_t alignment)
 
 	return data;
 }
+
+//  ----------------------------------------------------------------------------
+//  Frees memory allocated with aligned_alloc.
+void aligned_free(void* data)
+{
+    #if defined(_MSC_VER) || defined(__MINGW32__)
+    _aligned_free(data);
+    #else
+    free(data);
+    #endif
+}
+
+//  ----------------------------------------------------------------------------
+LinearArena::LinearArena(const size_t block_size)
+: m_block_size(block_size) {
+}
+
+//  ----------------------------------------------------------------------------
+void LinearArena::add_block(const size_t size) {
+    uint8_t* data = static_cast<uint8_t*>(aligned_alloc(size, BLOCK_ALIGNMENT));
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    Block block{};
+    block.data.reset(data);
+    block.size = size;
+    m_blocks.push_back(std::move(block));
+}
+
+//  ----------------------------------------------------------------------------
+void* LinearArena::allocate(const size_t size, const size_t alignment) {
+    assert((alignment & (alignment - 1)) == 0);
+    assert(alignment <= BLOCK_ALIGNMENT);
+
+    //  Find a block with space, starting with the current one
+    for (; m_block_index < m_blocks.size(); ++m_block_index) {
+        Block& block = m_blocks[m_block_index];
+        const size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= block.size) {
+            block.used = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+
+    //  Larger allocations get their own block
+    add_block(std::max(m_block_size, size));
+    m_block_index = m_blocks.size() - 1;
+
+    Block& block = m_blocks.back();
+    block.used = size;
+    return block.data.get();
+}
+
+//  ----------------------------------------------------------------------------
+size_t LinearArena::get_capacity() const {
+    size_t capacity = 0;
+    for (const Block& block : m_blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+//  ----------------------------------------------------------------------------
+size_t LinearArena::get_used() const {
+    size_t used = 0;
+    for (const Block& block : m_blocks) {
+        used += block.used;
+    }
+    return used;
+}
+
+//  ----------------------------------------------------------------------------
+void LinearArena::reset() {
+    //  Coalesce so the next frame's data fits in one block
+    if (m_blocks.size() > 1) {
+        const size_t capacity = get_capacity();
+        m_blocks.clear();
+        add_block(capacity);
+    }
+
+    for (Block& block : m_blocks) {
+        block.used = 0;
+    }
+
+    m_block_index = 0;
+}
 }
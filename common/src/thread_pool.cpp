@@ -0,0 +1,342 @@
+#include "common/log.hpp"
+#include "common/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace common
+{
+//  Pool and index of the worker running on this thread
+static thread_local const ThreadPool* t_thread_pool = nullptr;
+static thread_local size_t t_worker_index = ThreadPool::NOT_WORKER;
+
+//  ----------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+//  ----------------------------------------------------------------------------
+void ThreadPool::parallel_for(
+    const size_t count,
+    const size_t chunk_size,
+    const RangeFunc& func
+) {
+    assert(chunk_size > 0);
+
+    if (count == 0) {
+        return;
+    }
+
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+    //  Not worth waking workers
+    if (m_threads.empty() || chunk_count == 1) {
+        func(0, count);
+        return;
+    }
+
+    //  Shared with the worker tasks, which may start after this call has
+    //  returned if the caller and other workers processed every chunk.
+    struct State
+    {
+        std::atomic<size_t> next_chunk {0};
+        size_t complete {0};
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    auto state = std::make_shared<State>();
+
+    //  Chunks are claimed from a shared counter so a thread that finishes
+    //  early picks up the next chunk instead of idling. func is only
+    //  referenced while unclaimed chunks remain, which the caller waits for.
+    auto run_chunks = [state, chunk_count, chunk_size, count, &func]() {
+        while (true) {
+            const size_t chunk = state->next_chunk.fetch_add(1);
+            if (chunk >= chunk_count) {
+                break;
+            }
+
+            const size_t begin = chunk * chunk_size;
+            const size_t end = std::min(begin + chunk_size, count);
+            func(begin, end);
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (++state->complete == chunk_count) {
+                state->condition.notify_one();
+            }
+        }
+    };
+
+    //  The calling thread processes chunks too, so one less task is needed
+    const size_t task_count = std::min(m_threads.size(), chunk_count - 1);
+    for (size_t n = 0; n < task_count; ++n) {
+        push(run_chunks);
+    }
+
+    //  The caller can always finish the remaining chunks itself, so this is
+    //  safe to call from a task running on the pool.
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(
+        lock,
+        [&state, chunk_count]() {
+            return state->complete == chunk_count;
+        }
+    );
+}
+
+//  ----------------------------------------------------------------------------
+size_t ThreadPool::get_worker_index() const {
+    return t_thread_pool == this ? t_worker_index : NOT_WORKER;
+}
+
+//  ----------------------------------------------------------------------------
+void ThreadPool::push(Task task) {
+    Task* ptr = new Task(std::move(task));
+
+    //  Counted before it is published so a thief taking it straight away
+    //  can't decrement m_pending below zero
+    m_pending.fetch_add(1);
+
+    const size_t worker_index = get_worker_index();
+    if (worker_index != NOT_WORKER) {
+        m_deques[worker_index]->push(ptr);
+    } else {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_queue.push_back(ptr);
+    }
+
+    //  Workers increment m_sleeping before checking m_pending, so either the
+    //  worker sees the task or this sees the sleeping worker.
+    if (m_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_wake_condition.notify_one();
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void ThreadPool::start(const size_t thread_count) {
+    assert(m_threads.empty());
+
+    m_deques.clear();
+    for (size_t n = 0; n < thread_count; ++n) {
+        m_deques.push_back(std::make_unique<WorkStealingDeque<Task*>>());
+    }
+
+    for (size_t n = 0; n < thread_count; ++n) {
+        m_threads.emplace_back(&ThreadPool::thread_main, this, n);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_stop = true;
+    }
+    m_wake_condition.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+
+    //  Run anything pushed after the workers exited
+    while (!m_queue.empty()) {
+        Task* task = m_queue.front();
+        m_queue.pop_front();
+        m_pending.fetch_sub(1);
+        (*task)();
+        delete task;
+    }
+
+    m_stop = false;
+}
+
+//  ----------------------------------------------------------------------------
+ThreadPool::Task* ThreadPool::take_task(const size_t worker_index) {
+    Task* task = nullptr;
+
+    if (!m_deques[worker_index]->pop(task)) {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        if (!m_queue.empty()) {
+            task = m_queue.front();
+            m_queue.pop_front();
+        }
+    }
+
+    //  Steal from the other workers, starting with the next one
+    const size_t deque_count = m_deques.size();
+    for (size_t n = 1; task == nullptr && n < deque_count; ++n) {
+        WorkStealingDeque<Task*>& deque = *m_deques[(worker_index + n) % deque_count];
+        if (!deque.steal(task)) {
+            task = nullptr;
+        }
+    }
+
+    if (task != nullptr) {
+        m_pending.fetch_sub(1);
+    }
+
+    return task;
+}
+
+//  ----------------------------------------------------------------------------
+void ThreadPool::thread_main(const size_t thread_id) {
+    log_debug("Pool thread %zu started.", thread_id);
+
+    t_thread_pool = this;
+    t_worker_index = thread_id;
+
+    while (true) {
+        Task* task = take_task(thread_id);
+        if (task != nullptr) {
+            (*task)();
+            delete task;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_sleeping.fetch_add(1);
+        m_wake_condition.wait(
+            lock,
+            [this]() {
+                return m_pending.load() > 0 || m_stop;
+            }
+        );
+        m_sleeping.fetch_sub(1);
+
+        //  Queued tasks are run before exiting
+        if (m_stop && m_pending.load() == 0) {
+            break;
+        }
+    }
+
+    t_thread_pool = nullptr;
+    t_worker_index = NOT_WORKER;
+
+    log_debug("Pool thread %zu exited.", thread_id);
+}
+
+//  ----------------------------------------------------------------------------
+bool ThreadPool::try_run_task() {
+    const size_t worker_index = get_worker_index();
+    if (worker_index == NOT_WORKER) {
+        return false;
+    }
+
+    Task* task = take_task(worker_index);
+    if (task == nullptr) {
+        return false;
+    }
+
+    (*task)();
+    delete task;
+    return true;
+}
+
+//  ----------------------------------------------------------------------------
+TaskGroup::TaskGroup(ThreadPool& thread_pool)
+: m_thread_pool(thread_pool) {
+}
+
+//  ----------------------------------------------------------------------------
+TaskGroup::~TaskGroup() {
+    //  Tasks reference the group so they must complete first
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(
+        lock,
+        [this]() {
+            return m_idle;
+        }
+    );
+}
+
+//  ----------------------------------------------------------------------------
+void TaskGroup::complete_task() {
+    if (m_pending.fetch_sub(1) != 1) {
+        return;
+    }
+
+    ThreadPool& thread_pool = m_thread_pool;
+    std::vector<Task> continuations;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        //  Another task may have been added since the count reached zero
+        m_idle = m_pending.load() == 0;
+        if (m_idle) {
+            continuations.swap(m_continuations);
+        }
+
+        m_condition.notify_all();
+    }
+
+    //  The group may be destroyed by now so only use locals
+    for (Task& continuation : continuations) {
+        thread_pool.push(std::move(continuation));
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void TaskGroup::run(Task task) {
+    if (m_pending.fetch_add(1) == 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle = false;
+    }
+
+    m_thread_pool.push(
+        [this, task = std::move(task)]() {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_exception) {
+                    m_exception = std::current_exception();
+                }
+            }
+
+            complete_task();
+        }
+    );
+}
+
+//  ----------------------------------------------------------------------------
+void TaskGroup::then(Task continuation) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle) {
+            m_continuations.push_back(std::move(continuation));
+            return;
+        }
+    }
+
+    m_thread_pool.push(std::move(continuation));
+}
+
+//  ----------------------------------------------------------------------------
+void TaskGroup::wait() {
+    //  Workers run other tasks instead of blocking
+    while (m_pending.load() > 0 && m_thread_pool.try_run_task()) {
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(
+        lock,
+        [this]() {
+            return m_idle;
+        }
+    );
+
+    if (m_exception) {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+}
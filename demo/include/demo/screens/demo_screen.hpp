@@ -2,6 +2,12 @@
 
 #include "assets/glyph_mesh_asset.hpp"
 #include "engine/screens/screen.hpp"
+#include "engine/system_scheduler.hpp"
+#include "render/glyph_batch.hpp"
+#include "render/model_batch.hpp"
+#include "render/spine_sprite_batch.hpp"
+#include "render/sprite_batch.hpp"
+#include <vector>
 
 namespace demo
 {
@@ -10,6 +16,14 @@ class DemoScreen : public engine::Screen
     using Game = engine::Game;
 
     assets::AssetId m_glyph_mesh;
+    engine::SystemScheduler m_scheduler;
+
+    //  Batches are kept between frames so their vectors are reused
+    std::vector<render::ModelBatch> m_model_batches;
+    std::vector<render::SpriteBatch> m_billboard_batches;
+    std::vector<render::SpineSpriteBatch> m_spine_sprite_batches;
+    std::vector<render::SpriteBatch> m_sprite_batches;
+    render::GlyphBatch m_glyph_batch;
 
 protected:
     virtual void on_activate(Game& game) override;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/alloc.hpp"
 #include "common/system.hpp"
 #include "render/glyph_batch.hpp"
 #include "render/model_batch.hpp"
@@ -21,9 +22,16 @@ const common::SystemId SYSTEM_ID_DEMO = systems::SYSTEM_ID_LAST + 1;
 class DemoSystem : public common::System
 {
 private:
+    //  Maps batch keys to batch indices. Reset at the start of each batch
+    //  call, so it only holds data for a single call on the main thread.
+    common::LinearArena m_arena;
+    //  Glyphs being batched, reused across frames
+    std::vector<render::GlyphBatch::Glyph> m_glyphs;
 
 public:
     DemoSystem();
+    //  Batchers refill the batches handed back by the renderer's draw calls,
+    //  reusing their vectors, and drop any that aren't needed.
     void batch_billboards(
         engine::Game& game,
         glm::mat4 view,
@@ -12,6 +12,7 @@
 #include "platform/window.hpp"
 #include "render/renderer.hpp"
 #include "systems/camera_system.hpp"
+#include "systems/glyph_system.hpp"
 #include "systems/model_system.hpp"
 #include "systems/move_system.hpp"
 #include "systems/position_system.hpp"
@@ -53,7 +54,9 @@ void DemoScreen::on_load(Game& game) {
     Random& random = game.get_random();
     std::uniform_int_distribution<int> glyph_dist(0, 255);
 
-    AssetId texture_id = asset_mgr.get_texture_id("assets/textures/cp437_20x20.png");
+    //  Glyphs come from the glyph set added by the init screen
+    SystemManager& sys_mgr = game.get_system_manager();
+    const GlyphSystem& glyph_sys = get_glyph_system(sys_mgr);
 
     for (float y = 0; y < 10; ++y) {
         for (float x = 0; x < 10; ++x) {
@@ -62,12 +65,22 @@ void DemoScreen::on_load(Game& game) {
             glyph.size = size;
             glyph.bg_color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
             glyph.fg_color = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
-            glyph.texture_id = texture_id + 1 +  glyph_dist(random.get_rng());
+
+            GlyphComponentData glyph_data {};
+            glyph_data.ch = static_cast<uint16_t>(glyph_dist(random.get_rng()));
+            glyph_data.glyph_set_id = 0;
+            glyph.texture_id = glyph_sys.get_texture_id(glyph_data);
+            glyph.uv_rect = glyph_sys.get_uv_rect(glyph_data);
 
             args.glyphs.push_back(glyph);
         }
     }
     m_glyph_mesh = asset_mgr.create_glyph_mesh(args);
+
+    //  Schedule system updates
+    m_scheduler.clear();
+    m_scheduler.add_system(get_move_system(sys_mgr));
+    m_scheduler.add_system(get_camera_system(sys_mgr));
 }
 
 //  ----------------------------------------------------------------------------
@@ -118,44 +131,30 @@ void DemoScreen::on_render(Game& game) {
     DemoSystem& demo_sys = sys_mgr.get_system<DemoSystem>(SYSTEM_ID_DEMO);
 
     //  Batch models
-    std::vector<ModelBatch> model_batches;
-    demo_sys.batch_models(game, view, proj, model_batches);
-    render_sys.draw_models(model_batches);
+    demo_sys.batch_models(game, view, proj, m_model_batches);
+    render_sys.draw_models(m_model_batches);
 
     //  Batch billboards
-    std::vector<SpriteBatch> billboard_batches;
-    demo_sys.batch_billboards(game, view, proj, billboard_batches);
-    render_sys.draw_billboards(billboard_batches);
+    demo_sys.batch_billboards(game, view, proj, m_billboard_batches);
+    render_sys.draw_billboards(m_billboard_batches);
 
     //  Batch Spine sprites
-    std::vector<SpineSpriteBatch> spine_sprite_batches;
-    demo_sys.batch_spines(game, view, proj, spine_sprite_batches);
-    render_sys.draw_spines(spine_sprite_batches);
+    demo_sys.batch_spines(game, view, proj, m_spine_sprite_batches);
+    render_sys.draw_spines(m_spine_sprite_batches);
 
     //  Batch sprites
-    std::vector<SpriteBatch> sprite_batches;
-    demo_sys.batch_sprites(game, ortho_view, ortho_proj, sprite_batches);
-    render_sys.draw_sprites(sprite_batches);
+    demo_sys.batch_sprites(game, ortho_view, ortho_proj, m_sprite_batches);
+    render_sys.draw_sprites(m_sprite_batches);
 
     //  Batch glyphs
-    GlyphBatch glyph_batch;
-    demo_sys.batch_glyphs(game, ortho_view, ortho_proj, glyph_batch);
-    render_sys.draw_glyphs(glyph_batch);
+    demo_sys.batch_glyphs(game, ortho_view, ortho_proj, m_glyph_batch);
+    render_sys.draw_glyphs(m_glyph_batch);
 
     render_sys.draw_glyph_mesh(m_glyph_mesh);
 }
 
 //  ----------------------------------------------------------------------------
 void DemoScreen::on_update(Game& game) {
-    SystemManager& sys_mgr = game.get_system_manager();
-
-    MoveSystem& move_sys = get_move_system(sys_mgr);
-    move_sys.update(game);
-
-    CameraSystem& camera_sys = get_camera_system(sys_mgr);
-    camera_sys.update(game);
-
-    // DemoSystem& demo_sys = sys_mgr.get_system<DemoSystem>(SYSTEM_ID_DEMO);
-    // demo_sys.update(game);
+    m_scheduler.update(game);
 }
 }
@@ -32,6 +32,7 @@
 #include "systems/sprite_system.hpp"
 #include "systems/system_util.hpp"
 #include <set>
+#include <vector>
 
 using namespace assets;
 using namespace common;
@@ -224,9 +225,12 @@ static void init_assets(Game& game) {
 
     //  Load textures
     // asset_mgr.load_texture("assets/textures/missing.png");
-    asset_mgr.load_texture("assets/textures/model.png");
-    asset_mgr.load_texture("assets/textures/model2.png");
-    asset_mgr.load_texture("assets/textures/model3.png");
+    TextureCreateArgs model_tex_args{};
+    model_tex_args.format = TextureFormat::Bc1;
+
+    asset_mgr.load_texture("assets/textures/model.png", model_tex_args);
+    asset_mgr.load_texture("assets/textures/model2.png", model_tex_args);
+    asset_mgr.load_texture("assets/textures/model3.png", model_tex_args);
 
     //  Pixel sprites
     TextureCreateArgs tex_args{};
@@ -239,16 +243,6 @@ static void init_assets(Game& game) {
 
     //  Load Spine assets
     asset_mgr.load_spine("assets/spine/spineboy/spineboy", tex_args);
-
-    //  Load glyph textures
-    asset_mgr.load_texture("assets/textures/cp437_20x20.png", tex_args);
-    for (int n = 0; n < 256; ++n) {
-        const std::string filename =
-            "assets/textures/cp437_20x20/cp437_20x20_" +
-            std::to_string(n) +
-            ".png";
-        asset_mgr.load_texture(filename, tex_args);
-    }
 }
 
 //  ----------------------------------------------------------------------------
@@ -279,9 +273,12 @@ static void init_billboards(Game& game) {
     NameSystem& name_sys = get_name_system(sys_mgr);
     PositionSystem& pos_sys = get_position_system(sys_mgr);
 
+    std::vector<Entity> entities;
+    ecs.create_entities(positions.size(), entities);
+
     const int entity_count = positions.size();
     for (int n = 0; n < entity_count; ++n) {
-        Entity entity = ecs.create_entity();
+        const Entity entity = entities[n];
 
         const std::string name = "entity_" + std::to_string(entity.id);
 
@@ -307,7 +304,7 @@ static void init_glyphs(Game& game) {
     EcsRoot& ecs = game.get_ecs_root();
     SystemManager& sys_mgr = game.get_system_manager();
 
-    std::uniform_int_distribution<int> glyph_dist(0, 256);
+    std::uniform_int_distribution<int> glyph_dist(0, 255);
     std::uniform_int_distribution<int> x_dist(0, 191);
     std::uniform_int_distribution<int> y_dist(0, 76);
     std::uniform_real_distribution<float> color_dist(0, 1.0);
@@ -316,7 +313,32 @@ static void init_glyphs(Game& game) {
 
     AssetManager& asset_mgr = game.get_engine().get_asset_manager();
 
-    const int glyph_set_texture_id = asset_mgr.get_texture_id("assets/textures/cp437_20x20.png");
+    //  Pack the glyphs into one texture so they draw with a single binding
+    TextureAtlasLoadArgs atlas_args {};
+    atlas_args.name = "cp437_20x20";
+    atlas_args.width = 512;
+    atlas_args.height = 512;
+    for (int n = 0; n < 256; ++n) {
+        atlas_args.paths.push_back(
+            "assets/textures/cp437_20x20/cp437_20x20_" +
+            std::to_string(n) +
+            ".png"
+        );
+    }
+    atlas_args.promise = make_texture_atlas_asset_promise();
+    TextureAtlasAssetFuture atlas_future =
+        get_texture_atlas_asset_future(atlas_args.promise);
+
+    TextureCreateArgs tex_args{};
+    tex_args.mag_filter = TextureFilter::Nearest;
+    tex_args.min_filter = TextureFilter::Nearest;
+    tex_args.mipmaps = false;
+    //  Glyphs are masks, so only keep alpha
+    tex_args.format = TextureFormat::R8;
+
+    asset_mgr.load_texture_atlas(atlas_args, tex_args);
+    TextureAtlasAsset atlas = atlas_future.get();
+
     const int glyph_set_width = 20;
     const int glyph_set_height = 20;
 
@@ -335,14 +357,22 @@ static void init_glyphs(Game& game) {
     std::copy(position_set.begin(), position_set.end(), std::back_inserter(positions));
 
     GlyphSystem& glyph_sys = get_glyph_system(sys_mgr);
-    glyph_sys.add_glyph_set(glyph_set_texture_id, glyph_set_width, glyph_set_height);
+    glyph_sys.add_glyph_set(
+        atlas.texture_id,
+        glyph_set_width,
+        glyph_set_height,
+        std::move(atlas.uv_rects)
+    );
 
     NameSystem& name_sys = get_name_system(sys_mgr);
     PositionSystem& pos_sys = get_position_system(sys_mgr);
 
+    std::vector<Entity> entities;
+    ecs.create_entities(positions.size(), entities);
+
     const int entity_count = positions.size();
     for (int n = 0; n < entity_count; ++n) {
-        Entity entity = ecs.create_entity();
+        const Entity entity = entities[n];
 
         const std::string name = "entity_" + std::to_string(entity.id);
 
@@ -403,9 +433,12 @@ static void init_models(Game& game) {
     ModelSystem& model_sys = get_model_system(sys_mgr);
     NameSystem& name_sys = get_name_system(sys_mgr);
 
+    std::vector<Entity> entities;
+    ecs.create_entities(positions.size(), entities);
+
     const int entity_count = positions.size();
     for (int n = 0; n < entity_count; ++n) {
-        Entity entity = ecs.create_entity();
+        const Entity entity = entities[n];
 
         const std::string name = "entity_" + std::to_string(entity.id);
 
@@ -454,9 +487,12 @@ static void init_spines(Game& game) {
     PositionSystem& pos_sys = get_position_system(sys_mgr);
     SpineSystem& spine_sys = get_spine_system(sys_mgr);
 
+    std::vector<Entity> entities;
+    ecs.create_entities(positions.size(), entities);
+
     const int entity_count = positions.size();
     for (int n = 0; n < entity_count; ++n) {
-        Entity entity = ecs.create_entity();
+        const Entity entity = entities[n];
 
         const std::string name = "entity_" + std::to_string(entity.id);
 
@@ -500,9 +536,12 @@ static void init_sprites(Game& game) {
     PositionSystem& pos_sys = get_position_system(sys_mgr);
     SpriteSystem& sprite_sys = get_sprite_system(sys_mgr);
 
+    std::vector<Entity> entities;
+    ecs.create_entities(positions.size(), entities);
+
     const int entity_count = positions.size();
     for (int n = 0; n < entity_count; ++n) {
-        Entity entity = ecs.create_entity();
+        const Entity entity = entities[n];
 
         const std::string name = "entity_" + std::to_string(entity.id);
 
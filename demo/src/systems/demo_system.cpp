@@ -2,6 +2,7 @@
 #include "assets/spine_asset.hpp"
 #include "assets/spine_manager.hpp"
 #include "demo/systems/demo_system.hpp"
+#include "ecs/view.hpp"
 #include "engine/engine.hpp"
 #include "engine/game.hpp"
 #include "engine/system_manager.hpp"
@@ -18,10 +19,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
 #include <algorithm>
-#include <map>
 #include <unordered_map>
+#include <utility>
 
 using namespace assets;
+using namespace common;
 using namespace ecs;
 using namespace engine;
 using namespace render;
@@ -29,6 +31,29 @@ using namespace systems;
 
 namespace demo
 {
+//  ----------------------------------------------------------------------------
+//  Gets the batch for a key. New keys reuse the next batch left in batches
+//  by an earlier frame, so its vectors keep their capacity.
+template <typename Batch, typename IndexMap, typename Key>
+static Batch& get_batch(
+    IndexMap& indices,
+    const Key& key,
+    std::vector<Batch>& batches,
+    size_t& batch_count
+) {
+    const auto result = indices.try_emplace(key, batch_count);
+    if (result.second) {
+        if (batch_count == batches.size()) {
+            batches.emplace_back();
+        } else {
+            batches[batch_count].clear();
+        }
+        ++batch_count;
+    }
+
+    return batches[result.first->second];
+}
+
 struct EntitySort
 {
     Entity entity;
@@ -86,24 +111,38 @@ void DemoSystem::batch_billboards(
 
     //  Get drawable entities
     const BillboardSystem& billboard_sys = get_billboard_system(sys_mgr);
-    std::vector<Entity> entities;
-    billboard_sys.get_entities(entities);
-
-    const size_t entity_count = entities.size();
+    const PositionSystem& pos_sys = get_position_system(sys_mgr);
+    View<const BillboardSystem, const PositionSystem> billboards(
+        billboard_sys,
+        pos_sys
+    );
 
-    std::map<uint32_t, SpriteBatch> batches;
+    m_arena.reset();
+    using IndexMap = ArenaMap<uint32_t, size_t>;
+    IndexMap indices{IndexMap::allocator_type(m_arena)};
+    size_t batch_count = 0;
 
     Frustum frustum(proj * view);
 
-    const PositionSystem& pos_sys = get_position_system(sys_mgr);
-    for (size_t n = 0; n < entity_count; ++n) {
-        //  Get positions
-        const auto pos_cmpnt = pos_sys.get_component(entities[n]);
-        glm::vec3 position = pos_sys.get_position(pos_cmpnt);
-
-        const auto billboard_cmpnt = billboard_sys.get_component(entities[n]);
-        const uint32_t texture_id = billboard_sys.get_texture_id(billboard_cmpnt);
-        const glm::vec2 size = billboard_sys.get_size(billboard_cmpnt);
+    //  Pixels per world unit at a distance of one
+    const glm::vec2 viewport = game.get_engine().get_render_system().get_size();
+    const float pixel_scale = proj[1][1] * viewport.y * 0.5f;
+
+    billboards.for_each([
+        &indices,
+        &billboard_batches,
+        &batch_count,
+        &frustum,
+        &view,
+        pixel_scale
+    ](
+        const Entity entity,
+        const BillboardComponentData& billboard_data,
+        const PositionComponentData& pos_data
+    ) {
+        const glm::vec3 position = pos_data.position;
+        const uint32_t texture_id = billboard_data.texture_id;
+        const glm::vec2 size = billboard_data.size;
 
         //  Billboard bounding box
         const glm::vec3 maxp(
@@ -120,18 +159,36 @@ void DemoSystem::batch_billboards(
 
         //  Skip objects outside frustum
         if (!frustum.is_box_visible(minp, maxp)) {
-            continue;
+            return;
         }
 
-        SpriteBatch& batch = batches[texture_id];
+        SpriteBatch& batch = get_batch(
+            indices,
+            texture_id,
+            billboard_batches,
+            batch_count
+        );
         batch.texture_id = texture_id;
         batch.positions.push_back(position);
         batch.sizes.push_back({size.x, 1.0f, size.y});
-    }
 
-    for (const auto& pair : batches) {
-        billboard_batches.push_back(pair.second);
-    }
+        //  Billboards at or behind the camera use the full resolution
+        const float depth = -(view * glm::vec4(position, 1.0f)).z;
+        const float screen_size =
+            depth > 0.0f ?
+            std::max(size.x, size.y) * pixel_scale / depth :
+            0.0f;
+        if (batch.positions.size() == 1) {
+            batch.screen_size = screen_size;
+        } else if (screen_size <= 0.0f || batch.screen_size <= 0.0f) {
+            batch.screen_size = 0.0f;
+        } else {
+            batch.screen_size = std::max(batch.screen_size, screen_size);
+        }
+    });
+
+    //  Drop batches left over from an earlier frame
+    billboard_batches.resize(batch_count);
 }
 
 //  ----------------------------------------------------------------------------
@@ -145,58 +202,56 @@ void DemoSystem::batch_glyphs(
 
     //  Get drawable entities
     const GlyphSystem& glyph_sys = get_glyph_system(sys_mgr);
-    std::vector<Entity> entities;
-    entities.reserve(glyph_sys.get_component_count());
-    glyph_sys.get_entities(entities);
-
-    const size_t entity_count = entities.size();
+    const PositionSystem& pos_sys = get_position_system(sys_mgr);
+    View<const GlyphSystem, const PositionSystem> glyph_view(
+        glyph_sys,
+        pos_sys
+    );
 
     using Glyph = GlyphBatch::Glyph;
 
-    std::vector<Glyph> glyphs(entity_count);
-
-    //  Get position component data
-    const PositionSystem& pos_sys = get_position_system(sys_mgr);
-    for (size_t n = 0; n < entity_count; ++n) {
-        const auto pos_cmpnt = pos_sys.get_component(entities[n]);
-        glyphs[n].position = pos_sys.get_position(pos_cmpnt);
-    }
-
-    //  Get glyph component data
-    for (size_t n = 0; n < entity_count; ++n) {
-        const auto glyph_cmpnt = glyph_sys.get_component(entities[n]);
-        glyphs[n].texture_id = glyph_sys.get_texture_id(glyph_cmpnt);
-        glyphs[n].size = glyph_sys.get_size(glyph_cmpnt);
-        glyphs[n].bg_color = glyph_sys.get_bg_color(glyph_cmpnt);
-        glyphs[n].fg_color = glyph_sys.get_fg_color(glyph_cmpnt);
-    }
+    //  Reuses the storage handed back by the previous add_move
+    std::vector<Glyph>& glyphs = m_glyphs;
+    glyphs.clear();
+    glyphs.reserve(glyph_sys.get_component_count());
 
     //  Cull glyphs outside of frustum
     Frustum frustum(proj * view);
-    glyphs.erase(
-        std::remove_if(
-            glyphs.begin(),
-            glyphs.end(),
-            [&frustum](const Glyph& glyph) {
-                //  Glyph bounding box
-                const glm::vec3 maxp(
-                    glyph.position.x + glyph.size.x,
-                    glyph.position.y + glyph.size.y,
-                    1.0f
-                );
-
-                const glm::vec3 minp(
-                    glyph.position.x - glyph.size.x,
-                    glyph.position.y - glyph.size.y,
-                    0.0f
-                );
-
-                //  Skip objects outside frustum
-                return !frustum.is_box_visible(minp, maxp);
-            }
-        ),
-        glyphs.end()
-    );
+
+    glyph_view.for_each([&glyph_sys, &glyphs, &frustum](
+        const Entity entity,
+        const GlyphComponentData& glyph_data,
+        const PositionComponentData& pos_data
+    ) {
+        Glyph glyph;
+        glyph.position = pos_data.position;
+        glyph.size = glyph_sys.get_size(glyph_data);
+
+        //  Glyph bounding box
+        const glm::vec3 maxp(
+            glyph.position.x + glyph.size.x,
+            glyph.position.y + glyph.size.y,
+            1.0f
+        );
+
+        const glm::vec3 minp(
+            glyph.position.x - glyph.size.x,
+            glyph.position.y - glyph.size.y,
+            0.0f
+        );
+
+        //  Skip objects outside frustum
+        if (!frustum.is_box_visible(minp, maxp)) {
+            return;
+        }
+
+        glyph.texture_id = glyph_sys.get_texture_id(glyph_data);
+        glyph.uv_rect = glyph_sys.get_uv_rect(glyph_data);
+        glyph.bg_color = glyph_data.bg;
+        glyph.fg_color = glyph_data.fg;
+
+        glyphs.push_back(glyph);
+    });
 
     glyph_batch.add_move(glyphs);
 }
@@ -212,21 +267,23 @@ void DemoSystem::batch_models(
 
     //  Get drawable entities
     const ModelSystem& model_sys = get_model_system(sys_mgr);
-    std::vector<Entity> entities;
-    model_sys.get_entities(entities);
-
-    const size_t entity_count = entities.size();
+    const PositionSystem& pos_sys = get_position_system(sys_mgr);
+    View<const ModelSystem, const PositionSystem> models(model_sys, pos_sys);
 
+    m_arena.reset();
     using Key = std::pair<uint32_t, uint32_t>;
-    std::map<Key, ModelBatch> batches;
+    using IndexMap = ArenaMap<Key, size_t>;
+    IndexMap indices{IndexMap::allocator_type(m_arena)};
+    size_t batch_count = 0;
 
     Frustum frustum(proj * view);
 
-    const PositionSystem& pos_sys = get_position_system(sys_mgr);
-    for (size_t n = 0; n < entity_count; ++n) {
-        //  Get positions
-        const auto pos_cmpnt = pos_sys.get_component(entities[n]);
-        const glm::vec3 position = pos_sys.get_position(pos_cmpnt);
+    models.for_each([&indices, &model_batches, &batch_count, &frustum](
+        const Entity entity,
+        const ModelComponentData& model_data,
+        const PositionComponentData& pos_data
+    ) {
+        const glm::vec3 position = pos_data.position;
 
         //  Model bounding box
         const float size = 1.0f;
@@ -244,22 +301,25 @@ void DemoSystem::batch_models(
 
         //  Skip objects outside frustum
         if (!frustum.is_box_visible(minp, maxp)) {
-            continue;
+            return;
         }
 
-        const auto model_cmpnt = model_sys.get_component(entities[n]);
-        const uint32_t model_id = model_sys.get_model_id(model_cmpnt);
-        const uint32_t texture_id = model_sys.get_texture_id(model_cmpnt);
+        const uint32_t model_id = model_data.model_id;
+        const uint32_t texture_id = model_data.texture_id;
 
-        ModelBatch& batch = batches[{model_id, texture_id}];
+        ModelBatch& batch = get_batch(
+            indices,
+            Key(model_id, texture_id),
+            model_batches,
+            batch_count
+        );
         batch.model_id = model_id;
         batch.texture_id = texture_id;
         batch.positions.push_back(position);
-    }
+    });
 
-    for (const auto& pair : batches) {
-        model_batches.push_back(pair.second);
-    }
+    //  Drop batches left over from an earlier frame
+    model_batches.resize(batch_count);
 }
 
 //  ----------------------------------------------------------------------------
@@ -273,12 +333,13 @@ void DemoSystem::batch_spines(
 
     //  Get drawable entities
     const SpineSystem& spine_sys = get_spine_system(sys_mgr);
-    std::vector<Entity> entities;
-    spine_sys.get_entities(entities);
-
-    const size_t entity_count = entities.size();
+    const PositionSystem& pos_sys = get_position_system(sys_mgr);
+    View<const SpineSystem, const PositionSystem> spines(spine_sys, pos_sys);
 
-    std::map<uint32_t, SpineSpriteBatch> batches;
+    m_arena.reset();
+    using IndexMap = ArenaMap<uint32_t, size_t>;
+    IndexMap indices{IndexMap::allocator_type(m_arena)};
+    size_t batch_count = 0;
 
     // Frustum frustum(proj * view);
 
@@ -286,21 +347,21 @@ void DemoSystem::batch_spines(
     AssetManager& asset_mgr = engine.get_asset_manager();
     SpineManager& spine_mgr = asset_mgr.get_spine_manager();
 
-    const PositionSystem& pos_sys = get_position_system(sys_mgr);
-
-    for (size_t n = 0; n < entity_count; ++n) {
-        const auto spine_cmpnt = spine_sys.get_component(entities[n]);
-        const uint32_t spine_id = spine_sys.get_spine_id(spine_cmpnt);
+    spines.for_each([&indices, &spine_batches, &batch_count, &spine_mgr](
+        const Entity entity,
+        const SpineComponentData& spine_data,
+        const PositionComponentData& pos_data
+    ) {
+        const uint32_t spine_id = spine_data.spine_id;
 
         //  Check if assets are ready
         const SpineAsset* asset = spine_mgr.get_asset(spine_id);
         if (asset == nullptr) {
-            continue;
+            return;
         }
 
         //  Get positions
-        const auto pos_cmpnt = pos_sys.get_component(entities[n]);
-        glm::vec3 position = pos_sys.get_position(pos_cmpnt);
+        glm::vec3 position = pos_data.position;
 
         //  Sprite bounding box
         // const glm::vec3 maxp(
@@ -317,19 +378,23 @@ void DemoSystem::batch_spines(
 
         //  Skip objects outside frustum
         // if (!frustum.is_box_visible(minp, maxp)) {
-        //     continue;
+        //     return;
         // }
 
-        SpineSpriteBatch& batch = batches[spine_id];
+        SpineSpriteBatch& batch = get_batch(
+            indices,
+            spine_id,
+            spine_batches,
+            batch_count
+        );
         batch.spine_id = spine_id;
         batch.texture_id = asset->texture_id;
         batch.positions.push_back(position);
         batch.sizes.push_back({1.0f, 1.0f, 1.0f});
-    }
+    });
 
-    for (const auto& pair : batches) {
-        spine_batches.push_back(pair.second);
-    }
+    //  Drop batches left over from an earlier frame
+    spine_batches.resize(batch_count);
 }
 
 //  ----------------------------------------------------------------------------
@@ -343,24 +408,24 @@ void DemoSystem::batch_sprites(
 
     //  Get drawable entities
     const SpriteSystem& sprite_sys = get_sprite_system(sys_mgr);
-    std::vector<Entity> entities;
-    sprite_sys.get_entities(entities);
-
-    const size_t entity_count = entities.size();
+    const PositionSystem& pos_sys = get_position_system(sys_mgr);
+    View<const SpriteSystem, const PositionSystem> sprites(sprite_sys, pos_sys);
 
-    std::map<uint32_t, SpriteBatch> batches;
+    m_arena.reset();
+    using IndexMap = ArenaMap<uint32_t, size_t>;
+    IndexMap indices{IndexMap::allocator_type(m_arena)};
+    size_t batch_count = 0;
 
     Frustum frustum(proj * view);
 
-    const PositionSystem& pos_sys = get_position_system(sys_mgr);
-    for (size_t n = 0; n < entity_count; ++n) {
-        //  Get positions
-        const auto pos_cmpnt = pos_sys.get_component(entities[n]);
-        glm::vec3 position = pos_sys.get_position(pos_cmpnt);
-
-        const auto sprite_cmpnt = sprite_sys.get_component(entities[n]);
-        const uint32_t texture_id = sprite_sys.get_texture_id(sprite_cmpnt);
-        const glm::vec2 size = sprite_sys.get_size(sprite_cmpnt);
+    sprites.for_each([&indices, &sprite_batches, &batch_count, &frustum](
+        const Entity entity,
+        const SpriteComponentData& sprite_data,
+        const PositionComponentData& pos_data
+    ) {
+        const glm::vec3 position = pos_data.position;
+        const uint32_t texture_id = sprite_data.texture_id;
+        const glm::vec2 size = sprite_data.size;
 
         //  Sprite bounding box
         const glm::vec3 maxp(
@@ -377,17 +442,30 @@ void DemoSystem::batch_sprites(
 
         //  Skip objects outside frustum
         if (!frustum.is_box_visible(minp, maxp)) {
-            continue;
+            return;
         }
 
-        SpriteBatch& batch = batches[texture_id];
+        SpriteBatch& batch = get_batch(
+            indices,
+            texture_id,
+            sprite_batches,
+            batch_count
+        );
         batch.texture_id = texture_id;
         batch.positions.push_back(position);
         batch.sizes.push_back({size.x, size.y, 1.0f});
-    }
+        batch.uv_rects.push_back(sprite_data.uv_rect);
+
+        //  Orthographic sizes are in pixels. Atlas sprites show part of the
+        //  texture, so scale up to the size of the whole texture.
+        const glm::vec4& uv_rect = sprite_data.uv_rect;
+        batch.screen_size = std::max(
+            batch.screen_size,
+            std::max(size.x / uv_rect.z, size.y / uv_rect.w)
+        );
+    });
 
-    for (const auto& pair : batches) {
-        sprite_batches.push_back(pair.second);
-    }
+    //  Drop batches left over from an earlier frame
+    sprite_batches.resize(batch_count);
 }
 }
@@ -1,11 +1,6 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(push_constant) uniform VertexPushConstants {
-    layout(offset = 0) mat4 model;
-    // layout(offset = 64) vec2 size;
-} vpc;
-
 layout(set = 0, binding = 0) uniform FrameUniformBufferObject {
     mat4 view;
     mat4 proj;
@@ -17,8 +12,16 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 
+//  Per-instance
+layout(location = 3) in vec3 instancePosition;
+layout(location = 4) in vec3 instanceSize;
+layout(location = 5) in uint instanceTextureIndex;
+//  Texture coordinate offset in xy and size in zw
+layout(location = 6) in vec4 instanceUvRect;
+
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out flat uint fragTextureIndex;
 
 void main() {
     mat4 view = frame_ubo.view;
@@ -34,7 +37,10 @@ void main() {
         (camera_forward * center.y) +
         (camera_up      * center.z);
 
-    gl_Position = frame_ubo.proj * frame_ubo.view * vpc.model * vec4(pos, 1.0);
+    pos = instancePosition + instanceSize * pos;
+
+    gl_Position = frame_ubo.proj * frame_ubo.view * vec4(pos, 1.0);
     fragColor = inColor;
-    fragTexCoord = inTexCoord;
+    fragTexCoord = instanceUvRect.xy + inTexCoord * instanceUvRect.zw;
+    fragTextureIndex = instanceTextureIndex;
 }
@@ -18,6 +18,6 @@ void main() {
     gl_Position = mvp * vec4(vertex_position, 1.0);
 
     frag_color = vertex_color;
-    frag_uv = vertex_uv;
+    frag_uv = glyph.uv_rect.xy + vertex_uv * glyph.uv_rect.zw;
     instance_index = gl_InstanceIndex;
 }
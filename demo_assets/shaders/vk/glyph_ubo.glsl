@@ -5,6 +5,8 @@ struct Glyph
     mat4 model;
     vec4 bg_color;
     vec4 fg_color;
+    //  Texture coordinate offset in xy and size in zw
+    vec4 uv_rect;
     uint texture_index;
 };
 
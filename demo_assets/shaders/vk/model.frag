@@ -2,10 +2,6 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_EXT_nonuniform_qualifier : enable
 
-layout(push_constant) uniform FragmentPushConstants {
-    layout(offset = 64) uint texture_index;
-} fpc;
-
 // layout(set = 1, binding = 0) uniform ObjectUniformBufferObject {
 //     mat4 model;
 //     uint texture_index;
@@ -15,10 +11,11 @@ layout(set = 1, binding = 0) uniform sampler2D texSampler[];
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) in flat uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
     // outColor = vec4(fragTexCoord, 0.0, 1.0);
-    outColor = texture(texSampler[nonuniformEXT(fpc.texture_index)], fragTexCoord);
+    outColor = texture(texSampler[nonuniformEXT(fragTextureIndex)], fragTexCoord);
 }
@@ -1,10 +1,6 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(push_constant) uniform VertexPushConstants {
-    layout(offset = 0) mat4 model;
-} vpc;
-
 layout(set = 0, binding = 0) uniform FrameUniformBufferObject {
     mat4 view;
     mat4 proj;
@@ -19,11 +15,17 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 
+//  Per-instance
+layout(location = 3) in mat4 instanceModel;
+layout(location = 7) in uint instanceTextureIndex;
+
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out flat uint fragTextureIndex;
 
 void main() {
-    gl_Position = frame_ubo.proj * frame_ubo.view * vpc.model * vec4(inPosition, 1.0);
+    gl_Position = frame_ubo.proj * frame_ubo.view * instanceModel * vec4(inPosition, 1.0);
     fragColor = inColor;
     fragTexCoord = inTexCoord;
+    fragTextureIndex = instanceTextureIndex;
 }
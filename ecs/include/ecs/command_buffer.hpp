@@ -0,0 +1,179 @@
+#pragma once
+
+#include "common/system_id.hpp"
+#include "ecs/entity.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace ecs
+{
+class EcsRoot;
+class EntitySystemBase;
+
+//  Entity that will be created when a command buffer is played back.
+//  Only valid with the command buffer that created it.
+struct PendingEntity
+{
+    uint32_t index;
+};
+
+//  Records structural changes (entity creation/destruction, adding/removing
+//  components) and component data writes so they can be made from worker
+//  threads and applied later in one batch by EcsRoot::update().
+//
+//  Each thread records into its own buffer (see
+//  EcsRoot::get_command_buffer()), so recording does not lock. Component data
+//  is copied into blocks owned by the buffer that are reused between frames.
+class CommandBuffer
+{
+    using SystemId = common::SystemId;
+
+public:
+    //  Commands are played back grouped by type in this order
+    enum class CommandType : uint8_t
+    {
+        CreateEntity,
+        AddComponent,
+        SetComponentData,
+        RemoveComponent,
+        DestroyEntity,
+    };
+
+    using ApplyFunc = void (*)(EntitySystemBase&, Entity, const void*);
+    using DestroyFunc = void (*)(void*);
+
+    static constexpr uint32_t NOT_PENDING = std::numeric_limits<uint32_t>::max();
+
+    struct Command
+    {
+        CommandType type;
+        SystemId system_id {common::SYSTEM_ID_UNASSIGNED};
+        Entity entity {0};
+        //  Index of pending entity or NOT_PENDING if entity is set
+        uint32_t pending {NOT_PENDING};
+        //  Copy of the component data for SetComponentData
+        void* data {nullptr};
+        ApplyFunc apply {nullptr};
+        DestroyFunc destroy {nullptr};
+    };
+
+private:
+    //  Size of each arena block. Larger allocations get their own block.
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size {0};
+        size_t used {0};
+    };
+
+    uint32_t m_pending_count {0};
+    //  Index of the block currently being allocated from
+    size_t m_block_index {0};
+    std::vector<Block> m_blocks;
+    std::vector<Command> m_commands;
+
+    void* allocate(size_t size, size_t alignment);
+    void record(
+        CommandType type,
+        SystemId system_id,
+        Entity entity,
+        uint32_t pending
+    );
+
+    template <typename System, typename T>
+    void record_set_data(
+        const Entity entity,
+        const uint32_t pending,
+        const T& data
+    ) {
+        void* copy = allocate(sizeof(T), alignof(T));
+        new (copy) T(data);
+
+        Command command{};
+        command.type = CommandType::SetComponentData;
+        command.system_id = System::Id;
+        command.entity = entity;
+        command.pending = pending;
+        command.data = copy;
+
+        command.apply = [](
+            EntitySystemBase& base,
+            const Entity target,
+            const void* value
+        ) {
+            System& system = static_cast<System&>(base);
+            system.set_component_data(
+                system.get_component(target),
+                *static_cast<const T*>(value)
+            );
+        };
+
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            command.destroy = [](void* value) {
+                static_cast<T*>(value)->~T();
+            };
+        }
+
+        m_commands.push_back(command);
+    }
+
+public:
+    CommandBuffer() = default;
+    ~CommandBuffer();
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    template <typename System>
+    void add_component(const Entity entity) {
+        record(CommandType::AddComponent, System::Id, entity, NOT_PENDING);
+    }
+
+    template <typename System>
+    void add_component(const PendingEntity entity) {
+        record(CommandType::AddComponent, System::Id, Entity(0), entity.index);
+    }
+
+    //  Releases recorded commands and component data. Blocks are kept.
+    void clear();
+    PendingEntity create_entity();
+    void destroy_entity(const Entity entity);
+
+    bool empty() const {
+        return m_commands.empty();
+    }
+
+    //  Commands in the order they were recorded
+    std::vector<Command>& get_commands() {
+        return m_commands;
+    }
+
+    uint32_t get_pending_count() const {
+        return m_pending_count;
+    }
+
+    template <typename System>
+    void remove_component(const Entity entity) {
+        record(CommandType::RemoveComponent, System::Id, entity, NOT_PENDING);
+    }
+
+    //  Copies data to be set on the component when played back.
+    //  The component must exist when played back (it can be added by an
+    //  earlier command in any buffer).
+    template <typename System, typename T>
+    void set_component_data(const Entity entity, const T& data) {
+        record_set_data<System>(entity, NOT_PENDING, data);
+    }
+
+    template <typename System, typename T>
+    void set_component_data(const PendingEntity entity, const T& data) {
+        record_set_data<System>(Entity(0), entity.index, data);
+    }
+};
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "common/alloc.hpp"
+#include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecs
+{
+//  Storage layouts for EntitySystem component data.
+
+//  ----------------------------------------------------------------------------
+//  Array of structures (default). Components are stored contiguously in a
+//  single vector.
+struct AosLayout
+{
+    template <typename T>
+    using Storage = std::vector<T>;
+};
+
+//  ----------------------------------------------------------------------------
+//  Gets the class and field types of a data member pointer.
+template <typename M>
+struct MemberTraits;
+
+template <typename C, typename F>
+struct MemberTraits<F C::*>
+{
+    using Class = C;
+    using Field = F;
+};
+
+//  ----------------------------------------------------------------------------
+//  True if A and B point to the same data member.
+template <auto A, auto B>
+constexpr bool is_same_field() {
+    if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+        return A == B;
+    } else {
+        return false;
+    }
+}
+
+//  Number of times Field appears in Fields
+template <auto Field, auto... Fields>
+inline constexpr size_t field_count_v =
+    (size_t(is_same_field<Field, Fields>()) + ...);
+
+//  ----------------------------------------------------------------------------
+//  Structure of arrays. Each listed field of the component is stored in its
+//  own aligned array so loops that only touch some fields do not load the
+//  rest of the component, e.g.
+//
+//  EntitySystem<MoveComponentData, SoaLayout<
+//      &MoveComponentData::direction,
+//      &MoveComponentData::move
+//  >>
+//
+//  Every field of the component must be listed exactly once, otherwise its
+//  value is not stored. Storage checks that the listed fields account for
+//  the size of the component.
+template <auto... Fields>
+struct SoaLayout
+{
+    static_assert(sizeof...(Fields) > 0, "SoaLayout requires at least one field.");
+    static_assert(
+        ((field_count_v<Fields, Fields...> == 1) && ...),
+        "SoaLayout fields must be listed once."
+    );
+
+    //  Alignment of each field array
+    static const size_t ALIGNMENT = 32;
+
+    template <typename T>
+    class Storage
+    {
+        static_assert(
+            (std::is_same_v<typename MemberTraits<decltype(Fields)>::Class, T> && ...),
+            "SoaLayout fields must be members of the component type."
+        );
+
+        template <auto Field>
+        using FieldType = typename MemberTraits<decltype(Field)>::Field;
+
+        //  Offsets and sizes of the fields are multiples of the smallest
+        //  field alignment, so padding before a field is at most its
+        //  alignment less this, and likewise for padding at the end.
+        static constexpr size_t MIN_FIELD_ALIGNMENT =
+            std::min({alignof(FieldType<Fields>)...});
+
+        //  Largest size T can have if it only contains the listed fields
+        static constexpr size_t MAX_FIELDS_SIZE =
+            (alignof(T) - MIN_FIELD_ALIGNMENT) +
+            ((
+                sizeof(FieldType<Fields>) +
+                alignof(FieldType<Fields>) -
+                MIN_FIELD_ALIGNMENT
+            ) + ...);
+
+        static_assert(
+            sizeof(T) <= MAX_FIELDS_SIZE,
+            "SoaLayout must list every field of the component."
+        );
+
+        template <typename F>
+        using Array = std::vector<F, common::AlignedAllocator<F, ALIGNMENT>>;
+
+        std::tuple<Array<FieldType<Fields>>...> m_arrays;
+
+        //  Gets the position of the field in the Fields pack
+        template <auto Field>
+        static constexpr size_t field_index() {
+            constexpr bool matches[] = {is_same_field<Fields, Field>()...};
+            for (size_t n = 0; n < sizeof...(Fields); ++n) {
+                if (matches[n]) {
+                    return n;
+                }
+            }
+            return sizeof...(Fields);
+        }
+
+        template <size_t... Is>
+        void get(const size_t index, T& data, std::index_sequence<Is...>) const {
+            ((data.*Fields = std::get<Is>(m_arrays)[index]), ...);
+        }
+
+        template <size_t... Is>
+        void push_back(const T& data, std::index_sequence<Is...>) {
+            (std::get<Is>(m_arrays).push_back(data.*Fields), ...);
+        }
+
+        template <size_t... Is>
+        void set(const size_t index, const T& data, std::index_sequence<Is...>) {
+            ((std::get<Is>(m_arrays)[index] = data.*Fields), ...);
+        }
+
+    public:
+        size_t capacity() const {
+            return std::get<0>(m_arrays).capacity();
+        }
+
+        //  Copies the component at index into data
+        void get(const size_t index, T& data) const {
+            assert(index < size());
+            get(index, data, std::index_sequence_for<decltype(Fields)...>{});
+        }
+
+        //  Gets the array storing Field
+        template <auto Field>
+        Array<FieldType<Field>>& get_array() {
+            constexpr size_t n = field_index<Field>();
+            static_assert(n < sizeof...(Fields), "Field is not stored by layout.");
+            return std::get<n>(m_arrays);
+        }
+
+        template <auto Field>
+        const Array<FieldType<Field>>& get_array() const {
+            constexpr size_t n = field_index<Field>();
+            static_assert(n < sizeof...(Fields), "Field is not stored by layout.");
+            return std::get<n>(m_arrays);
+        }
+
+        void push_back(const T& data) {
+            push_back(data, std::index_sequence_for<decltype(Fields)...>{});
+        }
+
+        void reserve(const size_t capacity) {
+            std::apply(
+                [capacity](auto&... arrays) {
+                    (arrays.reserve(capacity), ...);
+                },
+                m_arrays
+            );
+        }
+
+        template <typename Archive>
+        void serialize(Archive& ar) {
+            std::apply(
+                [&ar](auto&... arrays) {
+                    ar(arrays...);
+                },
+                m_arrays
+            );
+        }
+
+        //  Copies data into the component at index
+        void set(const size_t index, const T& data) {
+            assert(index < size());
+            set(index, data, std::index_sequence_for<decltype(Fields)...>{});
+        }
+
+        size_t size() const {
+            return std::get<0>(m_arrays).size();
+        }
+
+        //  Removes the component at index by moving the last component into
+        //  its place in every array.
+        void swap_remove(const size_t index) {
+            assert(index < size());
+
+            std::apply(
+                [index](auto&... arrays) {
+                    ((
+                        index + 1 != arrays.size() ?
+                            void(std::swap(arrays[index], arrays.back())) :
+                            void(),
+                        arrays.pop_back()
+                    ), ...);
+                },
+                m_arrays
+            );
+        }
+    };
+};
+
+//  ----------------------------------------------------------------------------
+template <typename Layout>
+inline constexpr bool is_aos_layout_v = std::is_same_v<Layout, AosLayout>;
+}
@@ -1,11 +1,16 @@
 #pragma once
 
+#include "ecs/command_buffer.hpp"
 #include "ecs/entity_manager.hpp"
 #include "ecs/entity_system_base.hpp"
 #include "common/system_id.hpp"
 #include <cereal/types/vector.hpp>
-#include <algorithm>
+#include <cassert>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace ecs
@@ -15,16 +20,37 @@ class EcsRoot
     using SystemId = common::SystemId;
 
     EntityManager m_entity_manager;
+    //  Alive entities
     std::vector<Entity> m_entities;
+    //  Position of each alive entity in m_entities by entity index
+    std::vector<uint32_t> m_entity_positions;
+    //  Destroyed entities that still have components, in destruction order
     std::vector<Entity> m_removed_entities;
     std::vector<EntitySystemBase*> m_systems;
+    //  Systems indexed by ID (IDs are small and dense)
+    std::vector<EntitySystemBase*> m_system_table;
 
+    //  Command buffer for each thread that has requested one
+    std::mutex m_command_buffers_mutex;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>> m_command_buffers;
+    //  Commands from all buffers being played back
+    std::vector<CommandBuffer::Command> m_playback;
+
+    void play_commands();
     void remove_expired_entities();
 
 public:
     void add_system(EntitySystemBase* entity_system);
     Entity create_entity();
+    //  Appends count new entities to entities
+    void create_entities(size_t count, std::vector<Entity>& entities);
     void destroy_entity(const Entity entity);
+    void destroy_entities(const std::vector<Entity>& entities);
+
+    //  Gets the command buffer for the calling thread. Commands are played
+    //  back by update(), which must not be called while other threads are
+    //  recording.
+    CommandBuffer& get_command_buffer();
 
     const std::vector<Entity>& get_entities() const {
         return m_entities;
@@ -32,22 +58,21 @@ public:
 
     template <typename T>
     T& get_system(const SystemId id) {
-        auto find = std::find_if(
-            m_systems.begin(),
-            m_systems.end(),
-            [id](const EntitySystemBase* system) {
-                return system->get_id() == id;
-            }
-        );
-
-        if (find == m_systems.end()) {
+        if (id >= m_system_table.size() || m_system_table[id] == nullptr) {
             throw std::runtime_error("System not found.");
         }
 
-        EntitySystemBase* system = (*find);
+        EntitySystemBase* system = m_system_table[id];
+        assert(dynamic_cast<T*>(system) != nullptr);
         return *(static_cast<T*>(system));
     }
 
+    //  Gets a system by its static T::Id
+    template <typename T>
+    T& get_system() {
+        return get_system<T>(T::Id);
+    }
+
     bool is_alive(const Entity entity) const;
 
     template <typename Archive>
@@ -56,12 +81,14 @@ public:
 
         ar(
             m_entities,
+            m_entity_positions,
             m_removed_entities,
             // m_systems,
             m_entity_manager
         );
     }
 
+    //  Plays back command buffers then removes destroyed entities
     void update();
 };
 };
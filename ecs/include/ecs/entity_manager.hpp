@@ -1,35 +1,65 @@
 #pragma once
 
 #include "ecs/entity.hpp"
-#include <cereal/types/deque.hpp>
 #include <cereal/types/vector.hpp>
-#include <deque>
+#include <cstdint>
 #include <istream>
 #include <ostream>
 #include <vector>
 
 namespace ecs
 {
+//  Allocates entity indices and tracks their generations.
+//  Free indices form a FIFO list threaded through the slot array: a free
+//  slot stores the index of the next free slot above its generation bits.
+//  Indices are only reused once more than MINIMUM_FREE_INDICES are free so
+//  the 8-bit generation of a single index does not wrap around quickly.
 class EntityManager
 {
-    const unsigned MINIMUM_FREE_INDICES = 1024;
+    static const uint32_t MINIMUM_FREE_INDICES = 1024;
+    static const uint32_t NO_INDEX = ENTITY_INDEX_MASK;
 
-    std::deque<unsigned> m_free_indices;
-    std::vector<unsigned> m_generations;
+    //  Generation in the low bits, next free index in the high bits
+    std::vector<uint32_t> m_slots;
+    uint32_t m_free_head {NO_INDEX};
+    uint32_t m_free_tail {NO_INDEX};
+    uint32_t m_free_count {0};
+
+    static uint32_t get_generation(const uint32_t slot) {
+        return slot & ENTITY_GENERATION_MASK;
+    }
+
+    static uint32_t get_next(const uint32_t slot) {
+        return slot >> ENTITY_GENERATION_BITS;
+    }
+
+    static uint32_t make_slot(const uint32_t generation, const uint32_t next) {
+        return (next << ENTITY_GENERATION_BITS) | (generation & ENTITY_GENERATION_MASK);
+    }
+
+    uint32_t pop_free_index();
 
 public:
     EntityManager();
     EntityManager(const EntityManager&) = delete;
     EntityManager& operator=(const EntityManager&) = delete;
     Entity create_entity();
+    //  Appends count new entities to entities
+    void create_entities(size_t count, std::vector<Entity>& entities);
+    //  Invalidates the entity. Its index is not reused until freed.
     void destroy_entity(const Entity entity);
+    void destroy_entities(const std::vector<Entity>& entities);
+    //  Allows indices of destroyed entities to be reused
+    void free_entities(const std::vector<Entity>& entities);
     bool is_alive(const Entity entity) const;
 
     template <typename Archive>
     void serialize(Archive& ar) {
         ar(
-            m_free_indices,
-            m_generations
+            m_slots,
+            m_free_head,
+            m_free_tail,
+            m_free_count
         );
     }
 };
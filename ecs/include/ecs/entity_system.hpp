@@ -1,15 +1,34 @@
 #pragma once
 
+#include "common/thread_pool.hpp"
 #include "common/vector.hpp"
+#include "ecs/component_layout.hpp"
 #include "ecs/entity_system_base.hpp"
 #include <cereal/types/vector.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 
 namespace ecs
 {
-template <typename T>
+//  Layout selects how component data is stored (see component_layout.hpp).
+//  Systems using SoaLayout access fields through get_field() and
+//  get_field_array() instead of references to whole components.
+//
+//  Systems can opt in to change tracking with enable_change_tracking(). Each
+//  component then stores the system version it was last changed in. Taking
+//  a mutable reference to a component counts as a change, since whether it is
+//  written through can't be known.
+template <typename T, typename Layout = AosLayout>
 class EntitySystem : public EntitySystemBase
 {
     using SystemId = common::SystemId;
+    using Storage = typename Layout::template Storage<T>;
+
+    static constexpr bool IS_AOS = is_aos_layout_v<Layout>;
+
+    template <typename... Systems>
+    friend class View;
 
 public:
     struct Component
@@ -23,7 +42,25 @@ public:
 
 private:
     //  Component data
-    std::vector<T> m_data;
+    Storage m_data;
+
+    bool m_track_changes {false};
+    //  Version that changes are currently stamped with
+    uint32_t m_version {1};
+    //  Version each component was last changed in (parallel to m_data)
+    std::vector<uint32_t> m_versions;
+
+    inline void touch(const ComponentIndex index) {
+        if (m_track_changes) {
+            m_versions[index] = m_version;
+        }
+    }
+
+    inline void touch_all() {
+        if (m_track_changes) {
+            std::fill(m_versions.begin(), m_versions.end(), m_version);
+        }
+    }
 
 protected:
     virtual void initialize_component_data(size_t index, T& data) {};
@@ -32,25 +69,57 @@ protected:
     virtual void create_component() final {
         assert(m_data.capacity() > m_data.size());
 
-        m_data.emplace_back();
+        const size_t index = m_data.size();
 
-        const size_t index = m_data.size() - 1;
-        T& data = m_data.back();
+        //  New components are changed
+        if (m_track_changes) {
+            m_versions.push_back(m_version);
+        }
 
-        initialize_component_data(index, data);
+        if constexpr (IS_AOS) {
+            m_data.emplace_back();
+            initialize_component_data(index, m_data.back());
+        } else {
+            T data{};
+            initialize_component_data(index, data);
+            m_data.push_back(data);
+        }
     }
 
     virtual void destroy_component(ComponentIndex index) override {
-        release_component_data(index, m_data.at(index));
-        common::swap_remove(m_data, index);
+        if constexpr (IS_AOS) {
+            release_component_data(index, m_data.at(index));
+            common::swap_remove(m_data, index);
+        } else {
+            T data{};
+            m_data.get(index, data);
+            release_component_data(index, data);
+            m_data.swap_remove(index);
+        }
+
+        if (m_track_changes) {
+            common::swap_remove(m_versions, index);
+        }
     };
 
+    //  Starts tracking changes. All existing components count as changed.
+    void enable_change_tracking() {
+        m_track_changes = true;
+        m_versions.assign(m_data.size(), m_version);
+    }
+
+    //  Whole component accessors are only available with AosLayout
+
     T& get_component_data(const Component cmpnt) {
-        return m_data.at(cmpnt.index);
+        T& data = m_data.at(cmpnt.index);
+        touch(cmpnt.index);
+        return data;
     }
 
     T& get_component_data(const ComponentIndex& index) {
-        return m_data.at(index);
+        T& data = m_data.at(index);
+        touch(index);
+        return data;
     }
 
     const T& get_component_data(const Component cmpnt) const {
@@ -62,6 +131,7 @@ protected:
     }
 
     std::vector<T>& get_component_data() {
+        touch_all();
         return m_data;
     }
 
@@ -69,6 +139,36 @@ protected:
         return m_data;
     }
 
+    //  Field accessors are only available with SoaLayout
+
+    template <auto Field>
+    auto& get_field(const Component cmpnt) {
+        static_assert(!IS_AOS, "Fields require SoaLayout.");
+        auto& field = m_data.template get_array<Field>().at(cmpnt.index);
+        touch(cmpnt.index);
+        return field;
+    }
+
+    template <auto Field>
+    const auto& get_field(const Component cmpnt) const {
+        return get_field_array<Field>().at(cmpnt.index);
+    }
+
+    //  Gets the array of a single field for all components, indexed by
+    //  component index.
+    template <auto Field>
+    auto& get_field_array() {
+        static_assert(!IS_AOS, "Field arrays require SoaLayout.");
+        touch_all();
+        return m_data.template get_array<Field>();
+    }
+
+    template <auto Field>
+    const auto& get_field_array() const {
+        static_assert(!IS_AOS, "Field arrays require SoaLayout.");
+        return m_data.template get_array<Field>();
+    }
+
 public:
     EntitySystem(
         EcsRoot& ecs_root,
@@ -82,14 +182,71 @@ public:
 
     ~EntitySystem() {}
 
+    //  Returns the version changes are currently stamped with and starts a
+    //  new one, so changes made after this call compare greater. Pass the
+    //  returned value to the next for_each_changed() call.
+    uint32_t advance_version() {
+        return m_version++;
+    }
+
+    //  Calls func(Entity, Component) for each component changed since the
+    //  version returned by advance_version(). Pass 0 to visit all components.
+    template <typename Func>
+    void for_each_changed(const uint32_t since_version, Func func) const {
+        assert(m_track_changes);
+
+        const std::vector<Entity>& entities = get_entities();
+        for (size_t n = 0; n < m_versions.size(); ++n) {
+            if (m_versions[n] > since_version) {
+                func(entities[n], Component(static_cast<ComponentIndex>(n)));
+            }
+        }
+    }
+
     Component get_component(const Entity entity) const {
         return Component(get_component_index_by_entity(entity));
     }
 
+    bool is_tracking_changes() const {
+        return m_track_changes;
+    }
+
     //  Gets a copy of the component data
     //  Intended for initialization, editor, debugging, etc.
     void get_component_data(const Component cmpnt, T& data) const {
-        data = m_data.at(cmpnt.index);
+        if constexpr (IS_AOS) {
+            data = m_data.at(cmpnt.index);
+        } else {
+            m_data.get(cmpnt.index, data);
+        }
+    }
+
+    //  Calls func(Entity, T&) for each component, splitting the component
+    //  array into chunks of chunk_size that are processed on the pool.
+    //  Chunks cover disjoint index ranges so each component is only written
+    //  by one thread. func may also write components of the same entity in
+    //  other systems but must not touch other entities' components.
+    //  Components must not be added or removed while iterating.
+    template <typename Func>
+    void parallel_for_each(
+        common::ThreadPool& pool,
+        const size_t chunk_size,
+        Func func
+    ) {
+        static_assert(IS_AOS, "parallel_for_each requires AosLayout.");
+
+        const std::vector<Entity>& entities = get_entities();
+
+        pool.parallel_for(
+            m_data.size(),
+            chunk_size,
+            [this, &entities, &func](const size_t begin, const size_t end) {
+                for (size_t n = begin; n < end; ++n) {
+                    touch(static_cast<ComponentIndex>(n));
+                    func(entities[n], m_data[n]);
+                }
+            }
+        );
     }
 
     template <typename Archive>
@@ -99,12 +256,23 @@ public:
             cereal::base_class<EntitySystemBase>(this),
             m_data
         );
+
+        //  Versions are not saved so loaded components count as changed
+        if (m_track_changes) {
+            m_versions.assign(m_data.size(), m_version);
+        }
     }
 
     //  Sets component data
     //  Intended for initialization, editor, debugging, etc.
     void set_component_data(const Component cmpnt, const T& data) {
-        m_data.at(cmpnt.index) = data;
+        if constexpr (IS_AOS) {
+            m_data.at(cmpnt.index) = data;
+        } else {
+            m_data.set(cmpnt.index, data);
+        }
+
+        touch(cmpnt.index);
     }
 };
 }
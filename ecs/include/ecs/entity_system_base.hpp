@@ -2,33 +2,43 @@
 
 #include "common/system.hpp"
 #include "ecs/entity.hpp"
+#include "ecs/sparse_set.hpp"
 #include <cereal/types/base_class.hpp>
-#include <cereal/types/unordered_map.hpp>
 #include <cereal/types/vector.hpp>
-#include <unordered_map>
 #include <vector>
 
 namespace ecs
 {
 class EcsRoot;
 
-using ComponentIndex = EntityId;
+template <typename... Systems>
+class View;
 
 class EntitySystemBase : public common::System
 {
     using SystemId = common::SystemId;
 
-    size_t m_component_count;
+    template <typename... Systems>
+    friend class View;
+
     EcsRoot& m_ecs_root;
-    std::unordered_map<Entity, ComponentIndex> m_component_indices_by_entity;
-    std::unordered_map<ComponentIndex, Entity> m_entities_by_component_indices;
+    //  Entity to component index lookup and component index to entity
+    //  (parallel to component data)
+    SparseSet m_components;
 
 protected:
     virtual void create_component() = 0;
     virtual void destroy_component(ComponentIndex index) = 0;
     bool entity_is_alive(const Entity entity) const;
-    ComponentIndex get_component_index_by_entity(const Entity entity) const;
-    const Entity get_entity_by_component_index(const ComponentIndex index) const;
+
+    ComponentIndex get_component_index_by_entity(const Entity entity) const {
+        return m_components.get_index(entity);
+    }
+
+    const Entity get_entity_by_component_index(const ComponentIndex index) const {
+        return m_components.get_entity(index);
+    }
+
     EcsRoot& get_ecs_root();
     const EcsRoot& get_ecs_root() const;
 
@@ -43,22 +53,34 @@ public:
     EntitySystemBase& operator=(const EntitySystemBase&) = delete;
     ~EntitySystemBase() {}
     void add_component(const Entity entity);
+    //  Removes components of all entities that are no longer alive
     void garbage_collect();
-    size_t get_component_count() const;
-    std::vector<Entity> get_entities() const;
+
+    size_t get_component_count() const {
+        return m_components.size();
+    }
+
+    //  Entities in component index order
+    const std::vector<Entity>& get_entities() const {
+        return m_components.get_entities();
+    }
+
     void get_entities(std::vector<Entity>& entities) const;
-    bool has_component(const Entity entity) const;
+
+    bool has_component(const Entity entity) const {
+        return m_components.contains(entity);
+    }
+
     const size_t max_components;
     void remove_component(const Entity entity);
+    //  Removes components of the entities that have one
+    void remove_components(const std::vector<Entity>& entities);
 
     template <typename Archive>
     void serialize(Archive& ar) {
         ar(
-            cereal::base_class<EntitySystemBase>(this),
-            m_id,
-            m_component_count,
-            m_component_indices_by_entity,
-            m_entities_by_component_indices
+            cereal::base_class<common::System>(this),
+            m_components
         );
     }
 };
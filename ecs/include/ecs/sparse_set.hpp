@@ -0,0 +1,145 @@
+#pragma once
+
+#include "ecs/entity.hpp"
+#include <cereal/types/vector.hpp>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace ecs
+{
+using ComponentIndex = EntityId;
+
+const ComponentIndex INVALID_COMPONENT_INDEX =
+    std::numeric_limits<ComponentIndex>::max();
+
+//  Maps entities to densely packed component indices.
+//  The sparse array is indexed by entity index and split into pages that are
+//  only allocated once an entity in that range is added. The dense array holds
+//  the entity that owns each component index, so it stays parallel to the
+//  component data of the owning system.
+class SparseSet
+{
+    static const unsigned PAGE_BITS = 12;
+    static const unsigned PAGE_SIZE = 1 << PAGE_BITS;
+    static const unsigned PAGE_MASK = PAGE_SIZE - 1;
+
+    //  Component index by entity index (paged)
+    std::vector<std::vector<ComponentIndex>> m_pages;
+    //  Entity by component index
+    std::vector<Entity> m_dense;
+
+    inline ComponentIndex& get_sparse(const EntityId index) {
+        const size_t page = index >> PAGE_BITS;
+
+        if (page >= m_pages.size()) {
+            m_pages.resize(page + 1);
+        }
+
+        if (m_pages[page].empty()) {
+            m_pages[page].resize(PAGE_SIZE, INVALID_COMPONENT_INDEX);
+        }
+
+        return m_pages[page][index & PAGE_MASK];
+    }
+
+    inline ComponentIndex find_sparse(const EntityId index) const {
+        const size_t page = index >> PAGE_BITS;
+
+        if (page >= m_pages.size() || m_pages[page].empty()) {
+            return INVALID_COMPONENT_INDEX;
+        }
+
+        return m_pages[page][index & PAGE_MASK];
+    }
+
+public:
+    //  Returns the component index of the entity or INVALID_COMPONENT_INDEX
+    inline ComponentIndex find(const Entity entity) const {
+        const ComponentIndex cmpnt_index = find_sparse(entity.index());
+
+        //  Dense entry must match the full ID so that stale generations
+        //  sharing an entity index are not treated as present.
+        if (
+            cmpnt_index == INVALID_COMPONENT_INDEX ||
+            m_dense[cmpnt_index] != entity
+        ) {
+            return INVALID_COMPONENT_INDEX;
+        }
+
+        return cmpnt_index;
+    }
+
+    inline bool contains(const Entity entity) const {
+        return find(entity) != INVALID_COMPONENT_INDEX;
+    }
+
+    inline Entity get_entity(const ComponentIndex cmpnt_index) const {
+        assert(cmpnt_index < m_dense.size());
+        return m_dense[cmpnt_index];
+    }
+
+    inline const std::vector<Entity>& get_entities() const {
+        return m_dense;
+    }
+
+    inline ComponentIndex get_index(const Entity entity) const {
+        const ComponentIndex cmpnt_index = find(entity);
+
+        if (cmpnt_index == INVALID_COMPONENT_INDEX) {
+            throw std::out_of_range("Entity is not in sparse set.");
+        }
+
+        return cmpnt_index;
+    }
+
+    //  Adds the entity to the end of the dense array.
+    //  Returns the new component index.
+    ComponentIndex insert(const Entity entity) {
+        assert(!contains(entity));
+
+        const ComponentIndex cmpnt_index =
+            static_cast<ComponentIndex>(m_dense.size());
+
+        get_sparse(entity.index()) = cmpnt_index;
+        m_dense.push_back(entity);
+
+        return cmpnt_index;
+    }
+
+    //  Removes the entity by swapping the last entity into its slot.
+    //  Returns the component index that was vacated so the owner can
+    //  swap-remove its component data the same way.
+    ComponentIndex erase(const Entity entity) {
+        const ComponentIndex cmpnt_index = get_index(entity);
+        const Entity last = m_dense.back();
+
+        m_dense[cmpnt_index] = last;
+        get_sparse(last.index()) = cmpnt_index;
+
+        //  Invalidate after updating the swapped entry in case the entity
+        //  being removed is the last one.
+        get_sparse(entity.index()) = INVALID_COMPONENT_INDEX;
+        m_dense.pop_back();
+
+        return cmpnt_index;
+    }
+
+    void reserve(const size_t capacity) {
+        m_dense.reserve(capacity);
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+        ar(
+            m_pages,
+            m_dense
+        );
+    }
+
+    inline size_t size() const {
+        return m_dense.size();
+    }
+};
+}
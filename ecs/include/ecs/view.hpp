@@ -0,0 +1,190 @@
+#pragma once
+
+#include "common/thread_pool.hpp"
+#include "ecs/entity_system.hpp"
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ecs
+{
+//  Iterates entities that have a component in every one of the specified
+//  systems and passes references to each of their components to a function.
+//  The system with the fewest components drives the iteration and the other
+//  systems are resolved through their sparse sets.
+//
+//  Systems can be const-qualified for read-only access, e.g.
+//  View<const PositionSystem, MoveSystem>.
+//
+//  Components must not be added to or removed from the viewed systems while
+//  iterating. Systems must use AosLayout since components are passed by
+//  reference.
+template <typename... Systems>
+class View
+{
+    static_assert(sizeof...(Systems) > 0, "View requires at least one system.");
+
+    static const size_t SYSTEM_COUNT = sizeof...(Systems);
+
+    //  Number of entities ahead of the current one to prefetch components for
+    static const size_t PREFETCH_DISTANCE = 8;
+
+    std::tuple<Systems&...> m_systems;
+
+    template <typename System>
+    static inline decltype(auto) get_data(
+        System& system,
+        const ComponentIndex index
+    ) {
+        static_assert(
+            std::remove_const_t<System>::IS_AOS,
+            "View requires systems with AosLayout."
+        );
+
+        //  Mutable access counts as a change for systems tracking changes
+        if constexpr (!std::is_const_v<System>) {
+            system.touch(index);
+        }
+
+        return system.m_data[index];
+    }
+
+    template <typename System>
+    static inline ComponentIndex find(System& system, const Entity entity) {
+        const EntitySystemBase& base = system;
+        return base.m_components.find(entity);
+    }
+
+    template <typename System>
+    static inline void prefetch(System& system, const Entity entity) {
+        #if defined(__GNUC__) || defined(__clang__)
+        const ComponentIndex index = find(system, entity);
+        if (index != INVALID_COMPONENT_INDEX) {
+            __builtin_prefetch(&system.m_data[index]);
+        }
+        #endif
+    }
+
+    template <size_t... Is>
+    const std::vector<Entity>& get_smallest_entities(
+        size_t& driver,
+        std::index_sequence<Is...>
+    ) const {
+        const std::array<const EntitySystemBase*, SYSTEM_COUNT> systems = {
+            &std::get<Is>(m_systems)...
+        };
+
+        driver = 0;
+        for (size_t n = 1; n < SYSTEM_COUNT; ++n) {
+            if (
+                systems[n]->get_component_count() <
+                systems[driver]->get_component_count()
+            ) {
+                driver = n;
+            }
+        }
+
+        return systems[driver]->get_entities();
+    }
+
+    //  Processes driver entities in [begin, end)
+    template <typename Func, size_t... Is>
+    void for_each_range(
+        Func& func,
+        const std::vector<Entity>& entities,
+        const size_t driver,
+        const size_t begin,
+        const size_t end,
+        std::index_sequence<Is...>
+    ) {
+        for (size_t n = begin; n < end; ++n) {
+            if (n + PREFETCH_DISTANCE < end) {
+                const Entity ahead = entities[n + PREFETCH_DISTANCE];
+                (
+                    (Is != driver ?
+                        prefetch(std::get<Is>(m_systems), ahead) :
+                        void()),
+                    ...
+                );
+            }
+
+            const Entity entity = entities[n];
+
+            //  Driving system's component index is the iteration index
+            const std::array<ComponentIndex, SYSTEM_COUNT> indices = {
+                (Is == driver ?
+                    static_cast<ComponentIndex>(n) :
+                    find(std::get<Is>(m_systems), entity))...
+            };
+
+            if (
+                ((indices[Is] == INVALID_COMPONENT_INDEX) || ...)
+            ) {
+                continue;
+            }
+
+            func(entity, get_data(std::get<Is>(m_systems), indices[Is])...);
+        }
+    }
+
+    template <typename Func, size_t... Is>
+    void for_each(Func& func, std::index_sequence<Is...> seq) {
+        size_t driver;
+        const std::vector<Entity>& entities = get_smallest_entities(driver, seq);
+        for_each_range(func, entities, driver, 0, entities.size(), seq);
+    }
+
+    template <typename Func, size_t... Is>
+    void parallel_for_each(
+        common::ThreadPool& pool,
+        const size_t chunk_size,
+        Func& func,
+        std::index_sequence<Is...> seq
+    ) {
+        size_t driver;
+        const std::vector<Entity>& entities = get_smallest_entities(driver, seq);
+
+        pool.parallel_for(
+            entities.size(),
+            chunk_size,
+            [this, &func, &entities, driver, seq](
+                const size_t begin,
+                const size_t end
+            ) {
+                for_each_range(func, entities, driver, begin, end, seq);
+            }
+        );
+    }
+
+public:
+    View(Systems&... systems)
+    : m_systems(systems...) {
+    }
+
+    //  Calls func(Entity, Components&...) for each entity in the view.
+    //  Components are passed in the same order as the systems.
+    template <typename Func>
+    void for_each(Func func) {
+        for_each(func, std::index_sequence_for<Systems...>{});
+    }
+
+    //  Same as for_each but splits the driving system's entities into chunks
+    //  of chunk_size that are processed on the pool. Each entity is visited by
+    //  exactly one chunk, so no two threads write the same component. func
+    //  must not access components of entities other than the one passed.
+    template <typename Func>
+    void parallel_for_each(
+        common::ThreadPool& pool,
+        const size_t chunk_size,
+        Func func
+    ) {
+        parallel_for_each(
+            pool,
+            chunk_size,
+            func,
+            std::index_sequence_for<Systems...>{}
+        );
+    }
+};
+}
@@ -0,0 +1,83 @@
+#include "ecs/command_buffer.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace ecs
+{
+//  ----------------------------------------------------------------------------
+CommandBuffer::~CommandBuffer() {
+    clear();
+}
+
+//  ----------------------------------------------------------------------------
+void* CommandBuffer::allocate(const size_t size, const size_t alignment) {
+    assert((alignment & (alignment - 1)) == 0);
+
+    //  Find a block with enough space, starting at the current block
+    for (; m_block_index < m_blocks.size(); ++m_block_index) {
+        Block& block = m_blocks[m_block_index];
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        const uintptr_t start = (base + block.used + alignment - 1) & ~(alignment - 1);
+        const size_t offset = start - base;
+
+        if (offset + size <= block.size) {
+            block.used = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+
+    //  Add a new block, with room to align the allocation
+    Block block{};
+    block.size = std::max(BLOCK_SIZE, size + alignment);
+    block.data = std::make_unique<uint8_t[]>(block.size);
+    m_blocks.push_back(std::move(block));
+
+    m_block_index = m_blocks.size() - 1;
+    return allocate(size, alignment);
+}
+
+//  ----------------------------------------------------------------------------
+void CommandBuffer::clear() {
+    for (Command& command : m_commands) {
+        if (command.destroy != nullptr) {
+            command.destroy(command.data);
+        }
+    }
+
+    m_commands.clear();
+    m_pending_count = 0;
+
+    for (Block& block : m_blocks) {
+        block.used = 0;
+    }
+    m_block_index = 0;
+}
+
+//  ----------------------------------------------------------------------------
+PendingEntity CommandBuffer::create_entity() {
+    const uint32_t index = m_pending_count++;
+    record(CommandType::CreateEntity, common::SYSTEM_ID_UNASSIGNED, Entity(0), index);
+    return PendingEntity{index};
+}
+
+//  ----------------------------------------------------------------------------
+void CommandBuffer::destroy_entity(const Entity entity) {
+    record(CommandType::DestroyEntity, common::SYSTEM_ID_UNASSIGNED, entity, NOT_PENDING);
+}
+
+//  ----------------------------------------------------------------------------
+void CommandBuffer::record(
+    const CommandType type,
+    const SystemId system_id,
+    const Entity entity,
+    const uint32_t pending
+) {
+    Command command{};
+    command.type = type;
+    command.system_id = system_id;
+    command.entity = entity;
+    command.pending = pending;
+    m_commands.push_back(command);
+}
+}
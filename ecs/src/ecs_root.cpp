@@ -1,5 +1,7 @@
 #include "ecs/entity_system.hpp"
 #include "ecs/ecs_root.hpp"
+#include <algorithm>
+#include <cassert>
 
 namespace ecs
 {
@@ -10,73 +12,227 @@ void EcsRoot::add_system(EntitySystemBase* entity_system) {
     }
 
     //  Prevent duplicates
-    const auto& find = std::find_if(
-        m_systems.begin(),
-        m_systems.end(),
-        [entity_system](const auto& sys) {
-            return (sys->get_id() == entity_system->get_id());
-        }
-    );
-
-    if (find != m_systems.end()) {
+    const SystemId id = entity_system->get_id();
+    if (id < m_system_table.size() && m_system_table[id] != nullptr) {
         throw std::runtime_error("A system with the same ID was already added.");
     }
 
+    if (id >= m_system_table.size()) {
+        m_system_table.resize(id + 1, nullptr);
+    }
+
+    m_system_table[id] = entity_system;
     m_systems.push_back(entity_system);
 }
 
 //  ----------------------------------------------------------------------------
 Entity EcsRoot::create_entity() {
     Entity entity = m_entity_manager.create_entity();
+
+    const EntityId index = entity.index();
+    if (index >= m_entity_positions.size()) {
+        m_entity_positions.resize(index + 1);
+    }
+
+    m_entity_positions[index] = static_cast<uint32_t>(m_entities.size());
     m_entities.push_back(entity);
+
     return entity;
 }
 
+//  ----------------------------------------------------------------------------
+void EcsRoot::create_entities(const size_t count, std::vector<Entity>& entities) {
+    const size_t first = entities.size();
+    m_entity_manager.create_entities(count, entities);
+
+    m_entities.reserve(m_entities.size() + count);
+
+    //  New indices are allocated as a range so this resizes at most once
+    EntityId max_index = 0;
+    for (size_t n = first; n < entities.size(); ++n) {
+        max_index = std::max(max_index, entities[n].index());
+    }
+
+    if (count > 0 && max_index >= m_entity_positions.size()) {
+        m_entity_positions.resize(max_index + 1);
+    }
+
+    for (size_t n = first; n < entities.size(); ++n) {
+        const Entity entity = entities[n];
+        m_entity_positions[entity.index()] = static_cast<uint32_t>(m_entities.size());
+        m_entities.push_back(entity);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void EcsRoot::destroy_entities(const std::vector<Entity>& entities) {
+    m_removed_entities.reserve(m_removed_entities.size() + entities.size());
+
+    for (const Entity entity : entities) {
+        destroy_entity(entity);
+    }
+}
+
 //  ----------------------------------------------------------------------------
 void EcsRoot::destroy_entity(const Entity entity) {
+    if (!is_alive(entity)) {
+        return;
+    }
+
     m_entity_manager.destroy_entity(entity);
+
+    //  Swap remove from alive entities
+    const uint32_t position = m_entity_positions[entity.index()];
+    assert(m_entities[position] == entity);
+
+    const Entity last = m_entities.back();
+    m_entities[position] = last;
+    m_entity_positions[last.index()] = position;
+    m_entities.pop_back();
+
+    //  Components are removed in a batch by remove_expired_entities()
     m_removed_entities.push_back(entity);
 }
 
+//  ----------------------------------------------------------------------------
+CommandBuffer& EcsRoot::get_command_buffer() {
+    const std::thread::id thread_id = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(m_command_buffers_mutex);
+
+    for (auto& pair : m_command_buffers) {
+        if (pair.first == thread_id) {
+            return *pair.second;
+        }
+    }
+
+    m_command_buffers.emplace_back(thread_id, std::make_unique<CommandBuffer>());
+    return *m_command_buffers.back().second;
+}
+
 //  ----------------------------------------------------------------------------
 bool EcsRoot::is_alive(const Entity entity) const {
     return m_entity_manager.is_alive(entity);
 }
 
 //  ----------------------------------------------------------------------------
-void EcsRoot::remove_expired_entities() {
-    if (m_removed_entities.size() == 0) {
-        return;
+void EcsRoot::play_commands() {
+    using Command = CommandBuffer::Command;
+    using CommandType = CommandBuffer::CommandType;
+
+    std::lock_guard<std::mutex> lock(m_command_buffers_mutex);
+
+    //  Create pending entities and resolve commands that reference them
+    std::vector<Entity> created;
+    for (auto& pair : m_command_buffers) {
+        CommandBuffer& buffer = *pair.second;
+
+        created.clear();
+        for (uint32_t n = 0; n < buffer.get_pending_count(); ++n) {
+            created.push_back(create_entity());
+        }
+
+        for (const Command& command : buffer.get_commands()) {
+            if (command.type == CommandType::CreateEntity) {
+                continue;
+            }
+
+            m_playback.push_back(command);
+
+            if (command.pending != CommandBuffer::NOT_PENDING) {
+                m_playback.back().entity = created.at(command.pending);
+            }
+        }
     }
 
-    std::sort(m_entities.begin(), m_entities.end());
-    std::sort(m_removed_entities.begin(), m_removed_entities.end());
-
-    //  Removed expired entities from list of entities
-    m_entities.erase(
-        std::remove_if( begin(m_entities),end(m_entities),
-        [&](auto x) {
-            return find(
-                std::begin(m_removed_entities),
-                std::end(m_removed_entities),
-                x) != std::end(m_removed_entities);
-        }),
-        end(m_entities));
-
-    //  Remove expired entities from all systems
-    for (const Entity& entity : m_removed_entities) {
-        for (EntitySystemBase* system : m_systems) {
-            if (system->has_component(entity)) {
-                system->remove_component(entity);
+    //  Group by command type then system so each system is updated in one
+    //  pass. Sort is stable so data set on the same component by one thread
+    //  is applied in the order it was recorded.
+    std::stable_sort(
+        m_playback.begin(),
+        m_playback.end(),
+        [](const Command& a, const Command& b) {
+            if (a.type != b.type) {
+                return a.type < b.type;
             }
+
+            if (a.system_id != b.system_id) {
+                return a.system_id < b.system_id;
+            }
+
+            return a.entity < b.entity;
         }
+    );
+
+    EntitySystemBase* system = nullptr;
+    for (const Command& command : m_playback) {
+        if (
+            command.system_id != common::SYSTEM_ID_UNASSIGNED &&
+            (system == nullptr || system->get_id() != command.system_id)
+        ) {
+            system = &get_system<EntitySystemBase>(command.system_id);
+        }
+
+        const Entity entity = command.entity;
+
+        //  Commands for entities destroyed before playback are ignored
+        switch (command.type) {
+            case CommandType::CreateEntity:
+                break;
+
+            case CommandType::AddComponent:
+                if (is_alive(entity) && !system->has_component(entity)) {
+                    system->add_component(entity);
+                }
+                break;
+
+            case CommandType::SetComponentData:
+                if (system->has_component(entity)) {
+                    command.apply(*system, entity, command.data);
+                }
+                break;
+
+            case CommandType::RemoveComponent:
+                if (system->has_component(entity)) {
+                    system->remove_component(entity);
+                }
+                break;
+
+            case CommandType::DestroyEntity:
+                if (is_alive(entity)) {
+                    destroy_entity(entity);
+                }
+                break;
+        }
+    }
+
+    m_playback.clear();
+
+    for (auto& pair : m_command_buffers) {
+        pair.second->clear();
     }
+}
+
+//  ----------------------------------------------------------------------------
+void EcsRoot::remove_expired_entities() {
+    if (m_removed_entities.empty()) {
+        return;
+    }
+
+    //  Remove components of destroyed entities from all systems
+    for (EntitySystemBase* system : m_systems) {
+        system->remove_components(m_removed_entities);
+    }
+
+    //  Indices can only be reused once no system references them
+    m_entity_manager.free_entities(m_removed_entities);
 
     m_removed_entities.clear();
 }
 
 //  ----------------------------------------------------------------------------
 void EcsRoot::update() {
+    play_commands();
     remove_expired_entities();
 }
 }
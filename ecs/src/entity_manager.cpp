@@ -1,36 +1,123 @@
 #include "ecs/entity_manager.hpp"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
 
 namespace ecs
 {
 //  ----------------------------------------------------------------------------
 EntityManager::EntityManager() {
-    m_generations.reserve(MINIMUM_FREE_INDICES);
+    m_slots.reserve(MINIMUM_FREE_INDICES);
 }
 
 //  ----------------------------------------------------------------------------
 Entity EntityManager::create_entity() {
-    unsigned index;
+    uint32_t index;
 
-    if (m_free_indices.size() > MINIMUM_FREE_INDICES) {
-        index = m_free_indices.front();
-        m_free_indices.pop_front();
+    if (m_free_count > MINIMUM_FREE_INDICES) {
+        index = pop_free_index();
     } else {
-        m_generations.push_back(0);
-        index = (int)m_generations.size() - 1;
+        if (m_slots.size() >= NO_INDEX) {
+            throw std::runtime_error("Maximum number of entities exceeded.");
+        }
+
+        m_slots.push_back(make_slot(0, NO_INDEX));
+        index = static_cast<uint32_t>(m_slots.size() - 1);
     }
 
-    return Entity(index, m_generations[index]);
+    return Entity(index, get_generation(m_slots[index]));
+}
+
+//  ----------------------------------------------------------------------------
+void EntityManager::create_entities(
+    const size_t count,
+    std::vector<Entity>& entities
+) {
+    entities.reserve(entities.size() + count);
+
+    //  Reuse free indices first
+    size_t remaining = count;
+    while (remaining > 0 && m_free_count > MINIMUM_FREE_INDICES) {
+        const uint32_t index = pop_free_index();
+        entities.emplace_back(index, get_generation(m_slots[index]));
+        --remaining;
+    }
+
+    if (remaining == 0) {
+        return;
+    }
+
+    //  Add the rest as a single range
+    const size_t first = m_slots.size();
+    if (first + remaining > NO_INDEX) {
+        throw std::runtime_error("Maximum number of entities exceeded.");
+    }
+
+    m_slots.resize(first + remaining, make_slot(0, NO_INDEX));
+
+    for (size_t index = first; index < m_slots.size(); ++index) {
+        entities.emplace_back(static_cast<EntityId>(index), 0);
+    }
 }
 
 //  ----------------------------------------------------------------------------
 void EntityManager::destroy_entity(const Entity entity) {
-    const unsigned index = entity.index();
-    ++m_generations[index];
-    m_free_indices.push_back(index);
+    assert(is_alive(entity));
+
+    uint32_t& slot = m_slots[entity.index()];
+    slot = make_slot(get_generation(slot) + 1, NO_INDEX);
+}
+
+//  ----------------------------------------------------------------------------
+void EntityManager::destroy_entities(const std::vector<Entity>& entities) {
+    for (const Entity entity : entities) {
+        destroy_entity(entity);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void EntityManager::free_entities(const std::vector<Entity>& entities) {
+    for (const Entity entity : entities) {
+        assert(!is_alive(entity));
+
+        const uint32_t index = entity.index();
+
+        //  Append to tail
+        if (m_free_tail != NO_INDEX) {
+            uint32_t& tail = m_slots[m_free_tail];
+            tail = make_slot(get_generation(tail), index);
+        } else {
+            m_free_head = index;
+        }
+
+        uint32_t& slot = m_slots[index];
+        slot = make_slot(get_generation(slot), NO_INDEX);
+
+        m_free_tail = index;
+        ++m_free_count;
+    }
 }
 
 //  ----------------------------------------------------------------------------
 bool EntityManager::is_alive(const Entity entity) const {
-    return m_generations[entity.index()] == entity.generation();
+    return get_generation(m_slots[entity.index()]) == entity.generation();
+}
+
+//  ----------------------------------------------------------------------------
+uint32_t EntityManager::pop_free_index() {
+    assert(m_free_count > 0);
+
+    const uint32_t index = m_free_head;
+    uint32_t& slot = m_slots[index];
+
+    m_free_head = get_next(slot);
+    if (m_free_head == NO_INDEX) {
+        m_free_tail = NO_INDEX;
+    }
+
+    slot = make_slot(get_generation(slot), NO_INDEX);
+    --m_free_count;
+
+    return index;
 }
 }
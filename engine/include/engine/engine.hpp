@@ -8,6 +8,11 @@ namespace assets
 class AssetManager;
 }
 
+namespace common
+{
+class ThreadPool;
+}
+
 namespace input
 {
 class InputManager;
@@ -34,6 +39,7 @@ class Engine
     using AssetManager = assets::AssetManager;
     using InputManager = input::InputManager;
     using RenderSystem = render::Renderer;
+    using ThreadPool = common::ThreadPool;
     using Window = platform::Window;
     using WindowOptions = platform::WindowOptions;
 
@@ -41,6 +47,7 @@ class Engine
     std::unique_ptr<InputManager> m_input_mgr;
     std::unique_ptr<RenderSystem> m_render_sys;
     std::unique_ptr<ScreenManager> m_screen_mgr;
+    std::unique_ptr<ThreadPool> m_thread_pool;
     std::unique_ptr<UiStateManager> m_ui_state_mgr;
     std::unique_ptr<Window> m_window;
 
@@ -53,12 +60,16 @@ public:
     InputManager& get_input_manager();
     RenderSystem& get_render_system();
     ScreenManager& get_screen_manager();
+    ThreadPool& get_thread_pool();
     UiStateManager& get_ui_state_manager();
     Window& get_window();
+    //  thread_count is the number of thread pool workers. If 0, one less
+    //  than the number of cores is used.
     bool initialize(
         const std::string& base_name,
         const WindowOptions& window_options,
-        const size_t max_entities
+        const size_t max_entities,
+        const size_t thread_count = 0
     );
     void shutdown();
     void window_resized();
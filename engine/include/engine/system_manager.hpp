@@ -1,8 +1,9 @@
 #pragma once
 
 #include "common/system.hpp"
-#include <algorithm>
+#include <cassert>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace ecs
@@ -20,6 +21,10 @@ class SystemManager
 
     EcsRoot& m_ecs_root;
     std::vector<std::unique_ptr<System>> m_systems;
+    //  Systems indexed by ID (IDs are small and dense)
+    std::vector<System*> m_system_table;
+
+    void index_system(System* system);
 
 public:
     SystemManager(EcsRoot& ecs_root);
@@ -27,27 +32,31 @@ public:
 
     template <typename T>
     T& get_system(const SystemId id) {
-        auto find = std::find_if(
-            m_systems.begin(),
-            m_systems.end(),
-            [id](const auto& system) {
-                return system->get_id() == id;
-            }
-        );
-
-        if (find == m_systems.end()) {
+        if (id >= m_system_table.size() || m_system_table[id] == nullptr) {
             throw std::runtime_error("System not found.");
         }
 
-        System* system = (*find).get();
+        System* system = m_system_table[id];
+        assert(dynamic_cast<T*>(system) != nullptr);
         return *(static_cast<T*>(system));
     }
 
+    //  Gets a system by its static T::Id
+    template <typename T>
+    T& get_system() {
+        return get_system<T>(T::Id);
+    }
+
     template <typename Archive>
     void serialize(Archive& ar) {
         ar(
             m_systems
         );
+
+        m_system_table.clear();
+        for (const auto& system : m_systems) {
+            index_system(system.get());
+        }
     }
 };
 }
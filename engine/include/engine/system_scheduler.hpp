@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common/system_id.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace common
+{
+class ThreadPool;
+}
+
+namespace engine
+{
+class Game;
+
+//  Systems whose components a task reads or writes.
+struct SystemAccess
+{
+    std::vector<common::SystemId> reads;
+    std::vector<common::SystemId> writes;
+
+    SystemAccess& read(const common::SystemId id) {
+        reads.push_back(id);
+        return *this;
+    }
+
+    SystemAccess& write(const common::SystemId id) {
+        writes.push_back(id);
+        return *this;
+    }
+
+    //  True if the two tasks cannot safely run at the same time
+    bool conflicts(const SystemAccess& other) const;
+};
+
+//  Runs system updates in parallel where their declared component access
+//  allows it.
+//
+//  Tasks are ordered by a dependency graph built from their access: a task
+//  depends on every earlier task that writes a system it reads or writes, or
+//  that reads a system it writes. Running tasks one at a time in the order
+//  they were added is therefore always a valid order, and is used when the
+//  scheduler is serial (for debugging) or there are no worker threads.
+//
+//  Tasks must not create or destroy entities or add or remove components.
+class SystemScheduler
+{
+public:
+    using UpdateFunc = std::function<void(Game&)>;
+
+private:
+    struct Task
+    {
+        std::string name;
+        SystemAccess access;
+        UpdateFunc update;
+        //  Indices of tasks that depend on this task
+        std::vector<size_t> dependents;
+        //  Number of tasks this task depends on
+        size_t dependency_count {0};
+    };
+
+    struct UpdateState;
+
+    bool m_dirty {false};
+    bool m_serial {false};
+    std::vector<Task> m_tasks;
+
+    void build_graph();
+    //  Runs ready tasks from state until none are left, queuing worker
+    //  tasks for any extra dependents released along the way.
+    void run_ready_tasks(
+        const std::shared_ptr<UpdateState>& state,
+        Game& game,
+        common::ThreadPool& thread_pool
+    );
+    void update_parallel(Game& game, common::ThreadPool& thread_pool);
+    void update_serial(Game& game);
+
+public:
+    void add_task(
+        const std::string& name,
+        const SystemAccess& access,
+        UpdateFunc update
+    );
+
+    //  Adds a task that calls system.update(game) using the access declared
+    //  by T::get_update_access().
+    template <typename T>
+    void add_system(T& system) {
+        add_task(
+            system.get_system_name(),
+            T::get_update_access(),
+            [&system](Game& game) {
+                system.update(game);
+            }
+        );
+    }
+
+    void clear();
+
+    bool is_serial() const {
+        return m_serial;
+    }
+
+    //  Forces tasks to run one at a time on the calling thread in the order
+    //  they were added.
+    void set_serial(const bool serial) {
+        m_serial = serial;
+    }
+
+    //  Runs every task once and waits for them to complete.
+    void update(Game& game);
+};
+}
@@ -1,6 +1,7 @@
 #include "assets/asset_manager.hpp"
 #include "assets/spine_manager.hpp"
 #include "common/log.hpp"
+#include "common/thread_pool.hpp"
 #include "engine/engine.hpp"
 #include "engine/imgui/imgui_base.hpp"
 #include "engine/screens/screen_manager.hpp"
@@ -12,7 +13,9 @@
 // #include "render_gl/gl_renderer.hpp"
 #include "render_vk/vulkan_spine_manager.hpp"
 #include "render_vk/vulkan_render_system.hpp"
+#include <algorithm>
 #include <cassert>
+#include <thread>
 
 using namespace assets;
 using namespace common;
@@ -39,6 +42,7 @@ Engine::Engine()
 : m_input_mgr(nullptr),
   m_render_sys(nullptr),
   m_screen_mgr(std::make_unique<ScreenManager>()),
+  m_thread_pool(std::make_unique<ThreadPool>()),
   m_ui_state_mgr(std::make_unique<UiStateManager>()),
   m_window(nullptr) {
 }
@@ -71,6 +75,12 @@ ScreenManager& Engine::get_screen_manager() {
     return *m_screen_mgr;
 }
 
+//  ----------------------------------------------------------------------------
+ThreadPool& Engine::get_thread_pool() {
+    assert(m_thread_pool != nullptr);
+    return *m_thread_pool;
+}
+
 //  ----------------------------------------------------------------------------
 UiStateManager& Engine::get_ui_state_manager() {
     assert(m_ui_state_mgr != nullptr);;
@@ -87,7 +97,8 @@ Window& Engine::get_window() {
 bool Engine::initialize(
     const std::string& base_name,
     const WindowOptions& window_options,
-    const size_t max_entities
+    const size_t max_entities,
+    const size_t thread_count
 ) {
     log_debug("Initializing engine...");
 
@@ -99,6 +110,15 @@ bool Engine::initialize(
 
     const RenderApi render_api = RenderApi::Vulkan;
 
+    //  Shared worker threads for systems, rendering and asset loading. The
+    //  main thread also processes work while waiting, so leave a core for it.
+    if (thread_count > 0) {
+        m_thread_pool->start(thread_count);
+    } else {
+        const unsigned int core_count = std::thread::hardware_concurrency();
+        m_thread_pool->start(std::max(core_count, 2u) - 1);
+    }
+
     //  Initialize GLFW
     if (!glfw_init()) {
         return false;
@@ -144,7 +164,10 @@ bool Engine::initialize(
         throw std::runtime_error("Not implemented.");
         // m_render_sys = std::make_unique<GlRenderer>();
     } else if (render_api == RenderApi::Vulkan) {
-        m_render_sys = std::make_unique<VulkanRenderSystem>(max_entities);
+        m_render_sys = std::make_unique<VulkanRenderSystem>(
+            max_entities,
+            *m_thread_pool
+        );
     } else {
         throw std::runtime_error("Not implemented.");
     }
@@ -175,10 +198,13 @@ bool Engine::initialize(
 
 //  ----------------------------------------------------------------------------
 void Engine::shutdown() {
+    //  Render system waits for its jobs on the thread pool
     if (m_render_sys != nullptr) {
         m_render_sys->shutdown();
     }
 
+    m_thread_pool->stop();
+
     //  Shutdown ImGui after renderer (GLFW)
     //  Render system will destroy ImGui rendering specifics
     imgui_shutdown();
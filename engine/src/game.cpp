@@ -166,6 +166,9 @@ void Game::update() {
     ScreenManager& screen_mgr = m_engine->get_screen_manager();
     screen_mgr.update(*this);
 
+    //  Apply deferred entity changes
+    m_ecs_root->update();
+
     //  Start a new ImGui frame. This shoud be called as early as possible,
     //  but ImGui GUI calls should be restricted to DebugGuiSystem.
     const RenderApi render_api = m_engine->get_render_system().get_render_api();
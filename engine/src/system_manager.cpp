@@ -19,20 +19,14 @@ void SystemManager::add_system(std::unique_ptr<System> system) {
         throw std::runtime_error("Cannot add null system to system manager.");
     }
 
-    const auto& find = std::find_if(
-        m_systems.begin(),
-        m_systems.end(),
-        [&system](const auto& sys) {
-            return sys->get_id() == system->get_id();
-        }
-    );
-
-    if (find != m_systems.end()) {
+    const SystemId id = system->get_id();
+    if (id < m_system_table.size() && m_system_table[id] != nullptr) {
         throw std::runtime_error("A system with the same ID was already added.");
     }
 
     System* sys = system.get();
 
+    index_system(sys);
     m_systems.push_back(std::move(system));
 
     EntitySystemBase* ecs_sys = dynamic_cast<EntitySystemBase*>(sys);
@@ -43,4 +37,14 @@ void SystemManager::add_system(std::unique_ptr<System> system) {
         log_debug("Added system '%s'.", sys->get_system_name().c_str());
     }
 }
+
+//  ----------------------------------------------------------------------------
+void SystemManager::index_system(System* system) {
+    const SystemId id = system->get_id();
+    if (id >= m_system_table.size()) {
+        m_system_table.resize(id + 1, nullptr);
+    }
+
+    m_system_table[id] = system;
+}
 }
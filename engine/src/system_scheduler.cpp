@@ -0,0 +1,247 @@
+#include "common/log.hpp"
+#include "common/thread_pool.hpp"
+#include "engine/engine.hpp"
+#include "engine/game.hpp"
+#include "engine/system_scheduler.hpp"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+using namespace common;
+
+namespace engine
+{
+//  ----------------------------------------------------------------------------
+static bool intersects(
+    const std::vector<SystemId>& a,
+    const std::vector<SystemId>& b
+) {
+    for (const SystemId id : a) {
+        if (std::find(b.begin(), b.end(), id) != b.end()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//  ----------------------------------------------------------------------------
+bool SystemAccess::conflicts(const SystemAccess& other) const {
+    return
+        intersects(writes, other.writes) ||
+        intersects(writes, other.reads) ||
+        intersects(reads, other.writes);
+}
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::add_task(
+    const std::string& name,
+    const SystemAccess& access,
+    UpdateFunc update
+) {
+    if (!update) {
+        throw std::runtime_error("Cannot add task without update function.");
+    }
+
+    Task task{};
+    task.name = name;
+    task.access = access;
+    task.update = std::move(update);
+
+    m_tasks.push_back(std::move(task));
+    m_dirty = true;
+}
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::build_graph() {
+    for (Task& task : m_tasks) {
+        task.dependents.clear();
+        task.dependency_count = 0;
+    }
+
+    //  Edges only point from earlier to later tasks, so the order tasks were
+    //  added in is always a valid topological order.
+    for (size_t n = 0; n < m_tasks.size(); ++n) {
+        for (size_t m = n + 1; m < m_tasks.size(); ++m) {
+            if (m_tasks[n].access.conflicts(m_tasks[m].access)) {
+                m_tasks[n].dependents.push_back(m);
+                ++m_tasks[m].dependency_count;
+            }
+        }
+    }
+
+    for (const Task& task : m_tasks) {
+        log_debug(
+            "Scheduled task '%s' (%zu dependencies, %zu dependents).",
+            task.name.c_str(),
+            task.dependency_count,
+            task.dependents.size()
+        );
+    }
+
+    m_dirty = false;
+}
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::clear() {
+    m_tasks.clear();
+    m_dirty = false;
+}
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::update(Game& game) {
+    if (m_tasks.empty()) {
+        return;
+    }
+
+    ThreadPool& thread_pool = game.get_engine().get_thread_pool();
+
+    if (m_serial || m_tasks.size() == 1 || thread_pool.get_thread_count() == 0) {
+        update_serial(game);
+    } else {
+        update_parallel(game, thread_pool);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+//  Shared with the worker tasks, which may start after update_parallel has
+//  returned if the caller and other workers ran every task.
+struct SystemScheduler::UpdateState
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    //  Tasks whose dependencies have all completed
+    std::vector<size_t> ready;
+    //  Remaining dependencies per task for this update
+    std::vector<size_t> pending;
+    size_t complete {0};
+    std::exception_ptr exception;
+};
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::run_ready_tasks(
+    const std::shared_ptr<UpdateState>& state,
+    Game& game,
+    ThreadPool& thread_pool
+) {
+    const size_t task_count = state->pending.size();
+
+    while (true) {
+        size_t index = 0;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->ready.empty()) {
+                return;
+            }
+
+            index = state->ready.back();
+            state->ready.pop_back();
+        }
+
+        Task& task = m_tasks[index];
+
+        std::exception_ptr task_exception;
+        try {
+            task.update(game);
+        } catch (...) {
+            task_exception = std::current_exception();
+        }
+
+        //  Dependents are still released if the task throws so the update
+        //  completes and the exception can be rethrown on the calling thread.
+        size_t released = 0;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+
+            if (task_exception && !state->exception) {
+                state->exception = task_exception;
+            }
+
+            for (const size_t dependent : task.dependents) {
+                if (--state->pending[dependent] == 0) {
+                    state->ready.push_back(dependent);
+                    ++released;
+                }
+            }
+
+            //  Wakes the caller to run released tasks or return
+            if (++state->complete == task_count || released > 0) {
+                state->condition.notify_one();
+            }
+        }
+
+        //  This thread runs one of the released tasks itself
+        for (size_t n = 1; n < released; ++n) {
+            thread_pool.push(
+                [this, state, &game, &thread_pool]() {
+                    run_ready_tasks(state, game, thread_pool);
+                }
+            );
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::update_parallel(Game& game, ThreadPool& thread_pool) {
+    if (m_dirty) {
+        build_graph();
+    }
+
+    const size_t task_count = m_tasks.size();
+
+    auto state = std::make_shared<UpdateState>();
+    state->pending.resize(task_count);
+    for (size_t n = 0; n < task_count; ++n) {
+        state->pending[n] = m_tasks[n].dependency_count;
+        if (state->pending[n] == 0) {
+            state->ready.push_back(n);
+        }
+    }
+
+    //  The calling thread runs tasks too, so one less worker task is needed.
+    //  Workers pop from ready as soon as they are pushed, so count it first.
+    const size_t root_count = state->ready.size();
+    for (size_t n = 1; n < root_count; ++n) {
+        thread_pool.push(
+            [this, state, &game, &thread_pool]() {
+                run_ready_tasks(state, game, thread_pool);
+            }
+        );
+    }
+
+    //  Run ready tasks on this thread and only sleep while every ready task
+    //  is already running elsewhere. Tasks reference this scheduler and game
+    //  so wait for all of them.
+    while (true) {
+        run_ready_tasks(state, game, thread_pool);
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(
+            lock,
+            [&state, task_count]() {
+                return
+                    !state->ready.empty() ||
+                    state->complete == task_count;
+            }
+        );
+
+        if (state->complete == task_count) {
+            break;
+        }
+    }
+
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void SystemScheduler::update_serial(Game& game) {
+    for (Task& task : m_tasks) {
+        task.update(game);
+    }
+}
+}
@@ -20,6 +20,8 @@ public:
         glm::vec3 position;
         glm::vec4 bg_color;
         glm::vec4 fg_color;
+        //  Texture coordinate offset in xy and size in zw
+        glm::vec4 uv_rect {0.0f, 0.0f, 1.0f, 1.0f};
     };
 
     struct Batch
@@ -34,8 +36,13 @@ private:
     std::vector<Batch> m_batches;
 
 public:
+    //  Takes the glyphs, replacing any already added. glyphs is left holding
+    //  the previous storage of the batch, cleared, so its capacity can be
+    //  reused.
     void add_move(std::vector<Glyph>& glyphs) {
-        m_glyphs = std::move(glyphs);
+        m_glyphs.swap(glyphs);
+        glyphs.clear();
+        m_batches.clear();
 
         if (m_glyphs.empty()) {
             return;
@@ -67,6 +74,12 @@ public:
         }
     }
 
+    //  Removes the glyphs, keeping the capacity of the vectors
+    void clear() {
+        m_glyphs.clear();
+        m_batches.clear();
+    }
+
     inline size_t empty() const {
         return m_glyphs.empty() || m_batches.empty();
     }
@@ -11,5 +11,14 @@ struct ModelBatch
     uint32_t texture_id;
     uint32_t model_id;
     std::vector<glm::vec3> positions;
+    //  Largest size in pixels of the whole texture on screen, used to pick
+    //  the mip levels to stream. Zero requests the full resolution.
+    float screen_size {0.0f};
+
+    //  Removes the objects, keeping the capacity of the vectors
+    void clear() {
+        positions.clear();
+        screen_size = 0.0f;
+    }
 };
 }
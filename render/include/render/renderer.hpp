@@ -29,6 +29,9 @@ public:
     Renderer(const Renderer&) = delete;
     Renderer& operator=(const Renderer&) = delete;
     virtual void begin_frame() = 0;
+    //  Draw calls may take ownership of the batch data until the end of the
+    //  frame. The passed batches are then replaced with cleared batches from
+    //  an earlier frame, which callers can refill to reuse their capacity.
     virtual void draw_billboards(
         std::vector<SpriteBatch>& batches
     ) = 0;
@@ -53,6 +56,9 @@ public:
     virtual glm::vec2 get_size() const = 0;
     virtual bool initialize(GLFWwindow* glfw_window) = 0;
     virtual void resize() = 0;
+    //  Sets the device memory in bytes that streamed textures try to stay
+    //  under
+    virtual void set_texture_budget(const size_t bytes) = 0;
     virtual void shutdown() = 0;
     virtual void update_frame_uniforms(
         const glm::mat4& view,
@@ -17,5 +17,11 @@ struct SpineSpriteBatch
     std::vector<glm::vec3> positions;
     //  Size of each object
     std::vector<glm::vec3> sizes;
+
+    //  Removes the objects, keeping the capacity of the vectors
+    void clear() {
+        positions.clear();
+        sizes.clear();
+    }
 };
 }
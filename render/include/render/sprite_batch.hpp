@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <cstdint>
 #include <vector>
 
@@ -11,5 +12,19 @@ struct SpriteBatch
     uint32_t texture_id;
     std::vector<glm::vec3> positions;
     std::vector<glm::vec3> sizes;
+    //  Optional texture coordinates per sprite, offset in xy and size in zw.
+    //  The whole texture is used if empty.
+    std::vector<glm::vec4> uv_rects;
+    //  Largest size in pixels of the whole texture on screen, used to pick
+    //  the mip levels to stream. Zero requests the full resolution.
+    float screen_size {0.0f};
+
+    //  Removes the sprites, keeping the capacity of the vectors
+    void clear() {
+        positions.clear();
+        sizes.clear();
+        uv_rects.clear();
+        screen_size = 0.0f;
+    }
 };
 }
@@ -1,23 +1,27 @@
 #pragma once
 
+#include "render_vk/memory_allocator.hpp"
 #include "render_vk/vulkan.hpp"
 #include <cstdint>
 
 namespace render_vk
 {
+//  Host visible memory is mapped to allocation.mapped
 void create_buffer(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VkDeviceSize size,
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer& buffer,
-    VkDeviceMemory& buffer_memory
+    MemoryAllocation& allocation,
+    AllocationStrategy strategy = AllocationStrategy::FreeList
 );
 
-uint32_t find_memory_type(
-    VkPhysicalDevice physical_device,
-    uint32_t type_filter,
-    VkMemoryPropertyFlags properties
+void destroy_buffer(
+    MemoryAllocator& allocator,
+    VkDevice device,
+    VkBuffer& buffer,
+    MemoryAllocation& allocation
 );
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "render_vk/memory_allocator.hpp"
 #include "render_vk/vulkan.hpp"
 
 namespace render_vk
@@ -9,13 +10,13 @@ struct VulkanSwapchain;
 //  Multisampled color buffer for MSAA
 struct ColorImage
 {
-    VkImage image         {VK_NULL_HANDLE};
-    VkDeviceMemory memory {VK_NULL_HANDLE};
-    VkImageView view      {VK_NULL_HANDLE};
+    VkImage image {VK_NULL_HANDLE};
+    MemoryAllocation allocation;
+    VkImageView view {VK_NULL_HANDLE};
 };
 
 void create_color_resources(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     const VulkanSwapchain& swapchain,
     VkSampleCountFlagBits msaa_sample_count,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "render_vk/memory_allocator.hpp"
 #include "render_vk/vulkan.hpp"
 
 namespace render_vk
@@ -10,7 +11,7 @@ struct VulkanSwapchain;
 struct DepthImage
 {
     VkImage image = VK_NULL_HANDLE;
-    VkDeviceMemory memory = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
     VkImageView view = VK_NULL_HANDLE;
 };
 
@@ -19,6 +20,7 @@ bool has_stencil_component(VkFormat format);
 
 void create_depth_resources(
     VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VulkanQueue& transfer_queue,
     VkCommandPool command_pool,
@@ -26,11 +28,12 @@ void create_depth_resources(
     VkSampleCountFlagBits msaa_sample_count,
     VkImage& depth_image,
     VkImageView& depth_image_view,
-    VkDeviceMemory& depth_image_memory
+    MemoryAllocation& depth_image_allocation
 );
 
 void create_depth_resources(
     VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VulkanQueue& transfer_queue,
     VkCommandPool command_pool,
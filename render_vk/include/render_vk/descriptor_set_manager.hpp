@@ -17,11 +17,16 @@ class DescriptorSetManager
     mutable std::mutex m_mutex;
     VkDevice m_device {VK_NULL_HANDLE};
     std::vector<Texture> m_textures;
+    //  Texture timestamp when each slot of m_textures last changed
+    std::vector<uint32_t> m_slot_timestamps;
     TextureManager& m_texture_mgr;
 
 public:
     DescriptorSetManager(VkDevice device, TextureManager& texture_mgr);
-    void copy_texture_descriptor_set(VkDescriptorSet dst);
+    //  Writes texture slots that changed after timestamp to a descriptor set
+    //  and sets timestamp to the current texture timestamp
+    void copy_texture_descriptor_set(VkDescriptorSet dst, uint32_t& timestamp);
+    uint32_t get_texture_timestamp() const;
     bool is_ready() const;
     void update_descriptor_sets(TextureManager& texture_mgr);
 };
@@ -5,6 +5,17 @@
 
 namespace render_vk
 {
+//  Optional features enabled on the logical device
+struct DeviceFeatures
+{
+    //  Indirect draws with a draw count greater than one
+    bool multi_draw_indirect {false};
+    //  Indirect draws with a non-zero first instance
+    bool draw_indirect_first_instance {false};
+    //  Sampling BC1-BC7 block compressed images
+    bool texture_compression_bc {false};
+};
+
 bool init_device(
     VkInstance instance,
     VkSurfaceKHR surface,
@@ -20,6 +31,7 @@ bool create_logical_device(
     const std::vector<const char*>& device_extensions,
     VkDevice& device,
     VkQueue& graphics_queue,
-    VkQueue& present_queue
+    VkQueue& present_queue,
+    DeviceFeatures& enabled_features
 );
 }
@@ -1,12 +1,11 @@
 #pragma once
 
-#include "common/alloc.hpp"
-#include "common/math.hpp"
 #include "render_vk/buffer.hpp"
 #include "render_vk/vulkan.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <string.h>
-#include <vector>
+#include <cstdint>
 
 namespace render_vk
 {
@@ -19,137 +18,141 @@ void get_dynamic_buffer_align_and_size(
 );
 
 //  Dynamic uniform buffer.
-//  Stores UBO's (of type T).
+//  Stores UBO's (of type T) in persistently mapped memory. Each frame in
+//  flight has its own buffer, which is used as a linear allocator: ranges are
+//  claimed with an atomic offset so worker threads can write UBO's straight
+//  into mapped memory, then bound with the returned dynamic offset. Only the
+//  allocated ranges are written each frame.
 template <typename T>
 class DynamicUniformBuffer
 {
-    //  Maximum number of object instances this buffer will support
-    uint32_t m_object_count {0};
-
-    //  Dynamic buffer alignment (bytes)
+    //  Dynamic buffer alignment (bytes). Stride of UBO's that are bound
+    //  individually.
     size_t m_align {0};
 
+    //  Minimum dynamic offset alignment (bytes)
+    size_t m_offset_align {0};
+
     //  Dynamic buffer size (bytes)
     size_t m_buffer_size {0};
 
+    //  Size of the range bound by the descriptor (bytes)
+    size_t m_range {0};
+
+    //  Bytes allocated this frame
+    std::atomic<size_t> m_used {0};
+
+    MemoryAllocator* m_allocator {nullptr};
+
     VkDevice m_device {VK_NULL_HANDLE};
 
     //  Dynamic uniform buffer
     VkBuffer m_buffer {VK_NULL_HANDLE};
 
     //  Dynamic uniform buffer memory
-    VkDeviceMemory m_memory {VK_NULL_HANDLE};
+    MemoryAllocation m_allocation;
 
     //  Mapped memory for UBO data (CPU -> GPU)
-    void* m_mapped {nullptr};
+    char* m_mapped {nullptr};
+
+    //  Allocates size bytes. The descriptor range must fit after the dynamic
+    //  offset, so at least m_range bytes are claimed.
+    char* allocate_bytes(const size_t size, uint32_t& offset) {
+        const size_t claim_size = std::max(size, m_range);
+        const size_t aligned_size =
+            (claim_size + m_offset_align - 1) / m_offset_align * m_offset_align;
+
+        const size_t first = m_used.fetch_add(aligned_size);
+        if (first + claim_size > m_buffer_size) {
+            return nullptr;
+        }
 
-    //  Storage for UBO structs
-    T* m_ubo_data {nullptr};
+        offset = static_cast<uint32_t>(first);
+        return m_mapped + first;
+    }
 
 public:
     DynamicUniformBuffer() = default;
     DynamicUniformBuffer(const DynamicUniformBuffer&) = delete;
     DynamicUniformBuffer& operator=(const DynamicUniformBuffer&) = delete;
 
-    //  Copies UBO structs to mapped memory
-    void copy(const std::vector<T>& ubos) {
-        assert(ubos.size() <= m_object_count);
-
-        //  Copy structs to aligned memory
-        char* ubo_char = (char*)m_ubo_data;
-        for (size_t n = 0; n < ubos.size(); ++n) {
-            const T& ubo = ubos[n];
+    //  Allocates count UBO's that are each bound with their own dynamic
+    //  offset. UBO n is at offset + n * get_align(). Returns false if the
+    //  buffer is full.
+    bool allocate(const uint32_t count, uint32_t& offset) {
+        assert(count > 0);
+        return allocate_bytes(count * m_align, offset) != nullptr;
+    }
 
-            memcpy(
-                &ubo_char[n * m_align],
-                &ubo,
-                sizeof(T)
-            );
-        }
+    //  Allocates count tightly packed UBO's that are bound as one array with a
+    //  single dynamic offset. Returns nullptr if the buffer is full.
+    T* allocate_array(const uint32_t count, uint32_t& offset) {
+        assert(count > 0);
+        return reinterpret_cast<T*>(allocate_bytes(count * sizeof(T), offset));
+    }
 
-        //  Copy aligned UBO data to uniform buffer mapped memory
-        memcpy(
-            m_mapped,
-            m_ubo_data,
-            m_buffer_size
-        );
+    //  Gets the mapped UBO at an allocated dynamic offset
+    T& at(const uint32_t offset) {
+        assert(offset + sizeof(T) <= m_buffer_size);
+        return *reinterpret_cast<T*>(m_mapped + offset);
     }
 
+    //  range is the size of the range bound by the descriptor, in bytes. If 0,
+    //  one UBO is bound.
     void create(
         VkPhysicalDevice physical_device,
+        MemoryAllocator& allocator,
         VkDevice device,
-        uint32_t object_count
+        uint32_t object_count,
+        size_t range = 0
     ) {
-        m_object_count = object_count;
-        assert(m_object_count > 0);
+        assert(object_count > 0);
 
+        m_allocator = &allocator;
         m_device = device;
 
         //  Determine alignment and calculate buffer size
         get_dynamic_buffer_align_and_size(
             physical_device,
-            m_object_count,
+            object_count,
             sizeof(T),
             m_align,
             m_buffer_size
         );
 
-        //  Allocate data buffer (where UBO data will be stored in RAM)
-        //  Size must be a power of two
-        assert(m_ubo_data == nullptr);
-        m_ubo_data = (T*)common::aligned_alloc(
-            m_buffer_size,
-            common::next_power_of_two(m_align)
-        );
-        assert(m_ubo_data != nullptr);
+        VkPhysicalDeviceProperties device_props;
+        vkGetPhysicalDeviceProperties(physical_device, &device_props);
+        m_offset_align = device_props.limits.minUniformBufferOffsetAlignment;
+
+        m_range = range > 0 ? range : sizeof(T);
+        m_buffer_size = std::max(m_buffer_size, m_range);
 
-        //  Create UBO dynamic uniform buffer (GPU)
+        //  Create UBO dynamic uniform buffer (GPU). Host visible memory stays
+        //  mapped until destroyed.
         create_buffer(
-            physical_device,
+            allocator,
             device,
             m_buffer_size,
             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
             m_buffer,
-            m_memory
+            m_allocation
         );
 
-        //  Map UBO data
-        assert(m_memory != VK_NULL_HANDLE);
-        assert(m_mapped == nullptr);
-        vkMapMemory(
-            device,
-            m_memory,
-            0,
-            m_buffer_size,
-            0,
-            &m_mapped
-        );
+        m_mapped = static_cast<char*>(m_allocation.mapped);
         assert(m_mapped != nullptr);
     }
 
     void destroy() {
-        //  Unmap UBO data
-        if (m_mapped != VK_NULL_HANDLE) {
-            vkUnmapMemory(m_device, m_memory);
-            m_mapped = VK_NULL_HANDLE;
-        }
+        m_mapped = nullptr;
 
-        //  Free UBO data
-        if (m_ubo_data != nullptr) {
-            free(m_ubo_data);
-            m_ubo_data = nullptr;
+        //  Destroy dynamic uniform buffer and free its memory
+        if (m_allocator != nullptr) {
+            destroy_buffer(*m_allocator, m_device, m_buffer, m_allocation);
         }
 
-        //  Destroy dynamic uniform buffer
-        vkDestroyBuffer(m_device, m_buffer, nullptr);
-        m_buffer = VK_NULL_HANDLE;
-
-        //  Free dynamic uniform buffer memory
-        vkFreeMemory(m_device, m_memory, nullptr);
-        m_memory = VK_NULL_HANDLE;
-
         //  Clear device
+        m_allocator = nullptr;
         m_device = VK_NULL_HANDLE;
     }
 
@@ -160,6 +163,16 @@ public:
     VkBuffer get_buffer() const {
         return m_buffer;
     }
+
+    size_t get_range() const {
+        return m_range;
+    }
+
+    //  Releases all UBO's. Only call once the GPU has finished with this
+    //  frame.
+    void reset() {
+        m_used = 0;
+    }
 };
 
 //  ----------------------------------------------------------------------------
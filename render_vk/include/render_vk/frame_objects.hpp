@@ -1,6 +1,9 @@
 #pragma once
 
 #include "render_vk/dynamic_uniform_buffer.hpp"
+#include "render_vk/instance_buffer.hpp"
+#include "render_vk/model_instance.hpp"
+#include "render_vk/sprite_instance.hpp"
 #include "render_vk/ubo.hpp"
 #include "render_vk/uniform_buffer.hpp"
 #include "render_vk/vulkan.hpp"
@@ -46,5 +49,11 @@ struct FrameUniformObjects
     DynamicUniformBuffer<GlyphUbo> glyph;
     DynamicUniformBuffer<ObjectUbo> object;
     DynamicUniformBuffer<SpineUbo> spine;
+    //  Per-instance vertex data
+    InstanceBuffer<SpriteInstance> billboard_instances;
+    InstanceBuffer<ModelInstance> model_instances;
+    InstanceBuffer<SpriteInstance> sprite_instances;
+    //  Indirect draw commands for models
+    InstanceBuffer<VkDrawIndexedIndirectCommand> model_commands;
 };
 }
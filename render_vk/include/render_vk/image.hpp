@@ -1,5 +1,6 @@
 #pragma once
 
+#include "render_vk/memory_allocator.hpp"
 #include "render_vk/vulkan.hpp"
 
 namespace render_vk
@@ -7,7 +8,7 @@ namespace render_vk
 class VulkanQueue;
 
 void create_image(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     uint32_t width,
     uint32_t height,
@@ -18,7 +19,33 @@ void create_image(
     VkImageUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkImage& image,
-    VkDeviceMemory& image_memory
+    MemoryAllocation& allocation
+);
+
+//  Bytes in one mip level of an image. Supports the formats textures are
+//  created with.
+VkDeviceSize get_image_level_size(
+    VkFormat format,
+    uint32_t width,
+    uint32_t height
+);
+
+void destroy_image(
+    MemoryAllocator& allocator,
+    VkDevice device,
+    VkImage& image,
+    MemoryAllocation& allocation
+);
+
+//  Records commands that blit each mip level from the previous one. Expects
+//  all levels in TRANSFER_DST_OPTIMAL and leaves them in
+//  SHADER_READ_ONLY_OPTIMAL.
+void record_generate_mipmaps_commands(
+    VkCommandBuffer command_buffer,
+    VkImage image,
+    int32_t texture_width,
+    int32_t texture_height,
+    uint32_t mipmap_levels
 );
 
 //  Records transition image layout commands to a command buffer.
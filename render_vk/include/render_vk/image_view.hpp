@@ -9,6 +9,7 @@ VkImageView create_image_view(
     VkImage image,
     VkFormat format,
     uint32_t mip_levels,
-    VkImageAspectFlags aspect_flags
+    VkImageAspectFlags aspect_flags,
+    const VkComponentMapping& components = {}
 );
 }
@@ -1,20 +1,21 @@
 #pragma once
 
+#include "render_vk/memory_allocator.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan.hpp"
 #include <cstdint>
 #include <vector>
 
 namespace render_vk
 {
-class VulkanQueue;
-
-void create_index_buffer(
-    VkPhysicalDevice physical_device,
+//  Creates a device local index buffer and queues the index data upload.
+//  Returns the upload ticket.
+UploadTicket create_index_buffer(
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
     VkDevice device,
-    VulkanQueue& transfer_queue,
-    VkCommandPool command_pool,
     const std::vector<uint32_t>& indices,
     VkBuffer& index_buffer,
-    VkDeviceMemory& index_buffer_memory
+    MemoryAllocation& index_buffer_allocation
 );
 }
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "render_vk/buffer.hpp"
+#include "render_vk/vulkan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+namespace render_vk
+{
+//  Per-instance vertex buffer.
+//  Stores up to a fixed number of instances (of type T) in persistently
+//  mapped memory. Ranges are allocated with an atomic offset so several
+//  worker threads can fill the same buffer during a frame. Also used for
+//  indirect draw commands by passing a different usage to create().
+template <typename T>
+class InstanceBuffer
+{
+    //  Maximum number of instances this buffer will support
+    uint32_t m_capacity {0};
+
+    //  Instances allocated this frame
+    std::atomic<uint32_t> m_used {0};
+
+    MemoryAllocator* m_allocator {nullptr};
+
+    VkDevice m_device {VK_NULL_HANDLE};
+
+    //  Instance vertex buffer
+    VkBuffer m_buffer {VK_NULL_HANDLE};
+
+    //  Instance vertex buffer memory
+    MemoryAllocation m_allocation;
+
+    //  Mapped memory for instance data (CPU -> GPU)
+    T* m_mapped {nullptr};
+
+public:
+    InstanceBuffer() = default;
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    //  Allocates up to count instances. Returns a pointer to the mapped
+    //  instances and sets first to the index of the first instance, which is
+    //  used as the first instance of draw calls. count is reduced if the
+    //  buffer is full.
+    T* allocate(uint32_t& count, uint32_t& first) {
+        first = m_used.fetch_add(count);
+        if (first >= m_capacity) {
+            count = 0;
+            return nullptr;
+        }
+
+        count = std::min(count, m_capacity - first);
+        return m_mapped + first;
+    }
+
+    void create(
+        MemoryAllocator& allocator,
+        VkDevice device,
+        uint32_t capacity,
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+    ) {
+        m_capacity = capacity;
+        assert(m_capacity > 0);
+
+        m_allocator = &allocator;
+        m_device = device;
+
+        //  Create instance vertex buffer (GPU). Host visible memory stays
+        //  mapped until destroyed.
+        create_buffer(
+            allocator,
+            device,
+            sizeof(T) * m_capacity,
+            usage,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            m_buffer,
+            m_allocation
+        );
+
+        m_mapped = static_cast<T*>(m_allocation.mapped);
+        assert(m_mapped != nullptr);
+    }
+
+    void destroy() {
+        m_mapped = nullptr;
+
+        //  Destroy instance buffer and free its memory
+        if (m_allocator != nullptr) {
+            destroy_buffer(*m_allocator, m_device, m_buffer, m_allocation);
+        }
+
+        //  Clear device
+        m_allocator = nullptr;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    VkBuffer get_buffer() const {
+        return m_buffer;
+    }
+
+    uint32_t get_capacity() const {
+        return m_capacity;
+    }
+
+    //  Releases all instances. Only call once the GPU has finished with
+    //  this frame.
+    void reset() {
+        m_used = 0;
+    }
+};
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "render_vk/vulkan.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace render_vk
+{
+//  How a block hands out ranges
+enum class AllocationStrategy
+{
+    //  First fit from a list of free ranges. For long-lived resources.
+    FreeList,
+    //  Offset bump. Freed ranges are only reused once every range in the
+    //  block has been freed. For short-lived resources such as staging
+    //  buffers.
+    Linear,
+};
+
+//  Device memory allocation that ranges are sub-allocated from
+struct MemoryBlock
+{
+    struct Range
+    {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    VkDeviceMemory memory {VK_NULL_HANDLE};
+    VkDeviceSize size {0};
+    //  Persistently mapped memory if the memory type is host visible
+    char* mapped {nullptr};
+    uint32_t memory_type {0};
+    AllocationStrategy strategy {AllocationStrategy::FreeList};
+    //  Blocks hold either buffers or optimal tiling images so the two never
+    //  share a bufferImageGranularity page.
+    bool images {false};
+    uint32_t allocation_count {0};
+    //  Bytes in allocated ranges
+    VkDeviceSize used {0};
+    //  Free ranges sorted by offset (free list strategy)
+    std::vector<Range> free_ranges;
+    //  Next free offset (linear strategy)
+    VkDeviceSize head {0};
+};
+
+//  Range of device memory bound to a buffer or image
+struct MemoryAllocation
+{
+    VkDeviceMemory memory {VK_NULL_HANDLE};
+    VkDeviceSize offset {0};
+    VkDeviceSize size {0};
+    //  Mapped pointer to the range if the memory is host visible
+    void* mapped {nullptr};
+    //  Owning block, or nullptr for a dedicated allocation
+    MemoryBlock* block {nullptr};
+};
+
+struct MemoryStats
+{
+    uint32_t block_count {0};
+    uint32_t dedicated_count {0};
+    uint32_t allocation_count {0};
+    //  Bytes allocated from the device for blocks
+    VkDeviceSize block_bytes {0};
+    //  Bytes allocated from the device for dedicated allocations
+    VkDeviceSize dedicated_bytes {0};
+    //  Bytes in ranges allocated from blocks
+    VkDeviceSize used_bytes {0};
+    //  Fragmentation of free list blocks
+    uint32_t free_range_count {0};
+    VkDeviceSize largest_free_range {0};
+};
+
+//  Sub-allocates buffers and images from large device memory blocks so only
+//  a handful of vkAllocateMemory calls are made. Blocks are pooled by memory
+//  type, strategy and resource kind. Allocations larger than half a block
+//  get dedicated device memory. Thread safe.
+class MemoryAllocator
+{
+    static const VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    VkPhysicalDevice m_physical_device {VK_NULL_HANDLE};
+    VkDevice m_device {VK_NULL_HANDLE};
+    VkPhysicalDeviceMemoryProperties m_memory_properties;
+    VkDeviceSize m_block_size {0};
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<MemoryBlock>> m_blocks;
+
+    uint32_t m_dedicated_count {0};
+    VkDeviceSize m_dedicated_bytes {0};
+
+    void allocate_dedicated(
+        const VkMemoryRequirements& requirements,
+        const uint32_t memory_type,
+        MemoryAllocation& allocation
+    );
+    MemoryBlock* create_block(
+        const uint32_t memory_type,
+        const AllocationStrategy strategy,
+        const bool images,
+        const VkDeviceSize size
+    );
+    void destroy_block(MemoryBlock& block);
+    uint32_t find_memory_type(
+        const uint32_t type_bits,
+        const VkMemoryPropertyFlags properties
+    ) const;
+    VkDeviceSize get_block_size(const uint32_t memory_type) const;
+
+public:
+    MemoryAllocator(
+        VkPhysicalDevice physical_device,
+        VkDevice device,
+        const VkDeviceSize block_size = DEFAULT_BLOCK_SIZE
+    );
+    ~MemoryAllocator();
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+    //  Allocates memory for a resource. Throws if device memory is exhausted.
+    //  images is true for optimal tiling images.
+    void allocate(
+        const VkMemoryRequirements& requirements,
+        const VkMemoryPropertyFlags properties,
+        const bool images,
+        const AllocationStrategy strategy,
+        MemoryAllocation& allocation
+    );
+    //  Frees an allocation. One empty block is kept for each pool so
+    //  streaming does not repeatedly allocate device memory.
+    void free(const MemoryAllocation& allocation);
+    VkDevice get_device() const {
+        return m_device;
+    }
+    MemoryStats get_stats() const;
+    void log_stats() const;
+    //  Releases all empty blocks, e.g. after unloading assets
+    void trim();
+};
+}
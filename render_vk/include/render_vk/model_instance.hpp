@@ -0,0 +1,44 @@
+#pragma once
+
+#include "render_vk/vulkan.hpp"
+#include <glm/mat4x4.hpp>
+#include <array>
+#include <cstdint>
+
+namespace render_vk
+{
+//  Per-instance model data.
+//  Bound to vertex binding 1 after the model vertices.
+struct ModelInstance
+{
+    glm::mat4 model;
+    uint32_t texture_index;
+
+    static std::array<VkVertexInputAttributeDescription, 5> get_attribute_descriptions() {
+        std::array<VkVertexInputAttributeDescription, 5> attrib_descs{};
+
+        //  A mat4 attribute uses one location per column
+        for (uint32_t n = 0; n < 4; ++n) {
+            attrib_descs[n].binding = 1;
+            attrib_descs[n].location = 3 + n;
+            attrib_descs[n].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attrib_descs[n].offset = offsetof(ModelInstance, model) + sizeof(glm::vec4) * n;
+        }
+
+        attrib_descs[4].binding = 1;
+        attrib_descs[4].location = 7;
+        attrib_descs[4].format = VK_FORMAT_R32_UINT;
+        attrib_descs[4].offset = offsetof(ModelInstance, texture_index);
+
+        return attrib_descs;
+    }
+
+    static VkVertexInputBindingDescription get_binding_description() {
+        VkVertexInputBindingDescription binding_desc{};
+        binding_desc.binding = 1;
+        binding_desc.stride = sizeof(ModelInstance);
+        binding_desc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return binding_desc;
+    }
+};
+}
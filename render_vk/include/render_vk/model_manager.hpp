@@ -9,8 +9,9 @@
 
 namespace render_vk
 {
+class MemoryAllocator;
+class UploadManager;
 class VulkanModel;
-class VulkanQueue;
 
 class ModelManager
 {
@@ -34,21 +35,19 @@ public:
     VulkanModel* get_model(const AssetId id) const;
     const VulkanModel& get_sprite_quad() const;
     void initialize(
-        VkPhysicalDevice physical_device,
-        VkDevice device,
-        VulkanQueue& graphics_queue,
-        VkCommandPool command_pool
+        MemoryAllocator& allocator,
+        UploadManager& upload_mgr,
+        VkDevice device
     );
     void load_model(
         const AssetId id,
         const std::string& path,
-        VkPhysicalDevice physical_device,
-        VkDevice device,
-        VulkanQueue& graphics_queue,
-        VkCommandPool command_pool
+        MemoryAllocator& allocator,
+        UploadManager& upload_mgr,
+        VkDevice device
     );
     bool model_exists(const AssetId id) const;
     void unload(VkDevice device);
-    void update_models();
+    void update_models(const UploadManager& upload_mgr);
 };
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "common/log.hpp"
-#include "common/job_queue.hpp"
+#include "common/mpmc_queue.hpp"
+#include "common/stopwatch.hpp"
+#include "common/thread_pool.hpp"
 #include "render/glyph_batch.hpp"
 #include "render/model_batch.hpp"
 #include "render/sprite_batch.hpp"
@@ -11,11 +13,14 @@
 #include "render_vk/vulkan.hpp"
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <map>
 #include <mutex>
-#include <queue>
 #include <stdexcept>
-#include <thread>
+#include <string>
 #include <vector>
 
 namespace render_vk
@@ -23,6 +28,7 @@ namespace render_vk
 class DescriptorSetManager;
 class BillboardRenderer;
 class GlyphRenderer;
+class MemoryAllocator;
 class ModelManager;
 class ModelRenderer;
 class SpineSpriteRenderer;
@@ -39,6 +45,9 @@ struct ThreadFrameCommandObjects
 
 class RenderTaskManager
 {
+    //  Jobs beyond this are not queued for the main thread to help with
+    static const size_t MAX_QUEUED_JOBS = 256;
+
     enum class TaskId
     {
         None,
@@ -56,6 +65,7 @@ class RenderTaskManager
     static bool task_requires_textures(TaskId task_id);
     static const char* task_id_to_string(TaskId task_id);
 
+    //  Jobs are move-only and reference batch data held in FrameData
     struct Job
     {
         TaskId task_id {TaskId::None};
@@ -65,14 +75,67 @@ class RenderTaskManager
         void* renderer {nullptr};
 
         FrameUbo frame_ubo;
-        std::vector<render::GlyphBatch> glyph_batches;
-        std::vector<render::ModelBatch> batches;
-        std::vector<render::SpriteBatch> sprite_batches;
-        std::vector<render::SpineSpriteBatch> spine_batches;
+        const std::vector<render::ModelBatch>* batches {nullptr};
+        const std::vector<render::SpriteBatch>* sprite_batches {nullptr};
+        const std::vector<render::SpineSpriteBatch>* spine_batches {nullptr};
 
         uint32_t instance_count {0};
+        //  Dynamic offset of the job's uniform buffer allocation
+        uint32_t uniform_offset {0};
+
+        const render::GlyphBatch* glyph_batch {nullptr};
+
+        Job() = default;
+        Job(Job&&) = default;
+        Job& operator=(Job&&) = default;
+        Job(const Job&) = delete;
+        Job& operator=(const Job&) = delete;
+    };
+
+    //  Jobs and batch data submitted during the current frame. Released in
+    //  end_frame() once workers have finished with them. Deques are used so
+    //  queued jobs keep valid references while more are added.
+    struct FrameData
+    {
+        std::deque<Job> jobs;
+        std::deque<std::vector<render::ModelBatch>> model_batches;
+        std::deque<std::vector<render::SpriteBatch>> sprite_batches;
+        std::deque<std::vector<render::SpineSpriteBatch>> spine_batches;
+        std::deque<render::GlyphBatch> glyph_batches;
+
+        //  Cleared batches from earlier frames, handed back to the callers of
+        //  the draw functions so the capacity of their vectors is reused
+        std::vector<std::vector<render::ModelBatch>> free_model_batches;
+        std::vector<std::vector<render::SpriteBatch>> free_sprite_batches;
+        std::vector<std::vector<render::SpineSpriteBatch>> free_spine_batches;
+        std::vector<render::GlyphBatch> free_glyph_batches;
+
+        template <typename Batch>
+        static void recycle(
+            std::deque<std::vector<Batch>>& batches,
+            std::vector<std::vector<Batch>>& free_batches
+        ) {
+            for (std::vector<Batch>& frame_batches : batches) {
+                for (Batch& batch : frame_batches) {
+                    batch.clear();
+                }
+                free_batches.push_back(std::move(frame_batches));
+            }
+            batches.clear();
+        }
 
-        render::GlyphBatch glyph_batch;
+        void clear() {
+            jobs.clear();
+            recycle(model_batches, free_model_batches);
+            recycle(sprite_batches, free_sprite_batches);
+            recycle(spine_batches, free_spine_batches);
+
+            for (render::GlyphBatch& glyph_batch : glyph_batches) {
+                glyph_batch.clear();
+                free_glyph_batches.push_back(std::move(glyph_batch));
+            }
+            glyph_batches.clear();
+        }
     };
 
     //  Frame objects for worker threads
@@ -85,6 +148,16 @@ class RenderTaskManager
         FrameDescriptorObjects descriptor;
     };
 
+    //  Objects for each worker thread of the thread pool
+    struct WorkerState
+    {
+        //  Cumulative frame of the last job this worker processed
+        uint32_t last_frame {UINT32_MAX};
+        std::string name;
+        std::vector<ThreadFrame> frames;
+        common::Stopwatch stopwatch;
+    };
+
     class RenderTasks
     {
         struct TaskResults
@@ -94,7 +167,10 @@ class RenderTaskManager
         };
 
         uint32_t m_order {0};
+        //  Calls without results
+        uint32_t m_outstanding {0};
         mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
         std::map<TaskId, TaskResults> m_results;
 
         //  Secondary command buffers generated by worker threads
@@ -108,6 +184,7 @@ class RenderTaskManager
 
             TaskResults& results = m_results[task_id];
             ++results.called;
+            ++m_outstanding;
 
             return m_order++;
         }
@@ -139,17 +216,25 @@ class RenderTaskManager
                 case TaskId::DrawModels:
                 case TaskId::DrawSpines:
                 case TaskId::DrawSprites:
-                    m_command_buffers[order] = command_buffer;
+                    //  Failed jobs post no command buffer
+                    if (command_buffer != VK_NULL_HANDLE) {
+                        m_command_buffers[order] = command_buffer;
+                    }
                     break;
             }
 
             ++results.complete;
+
+            if (--m_outstanding == 0) {
+                m_condition.notify_all();
+            }
         }
 
         void clear() {
             std::lock_guard<std::mutex> lock(m_mutex);
 
             m_order = 0;
+            m_outstanding = 0;
             m_results.clear();
             m_command_buffers.clear();
         }
@@ -166,25 +251,30 @@ class RenderTaskManager
 
         bool is_complete() const {
             std::lock_guard<std::mutex> lock(m_mutex);
+            return m_outstanding == 0;
+        }
 
-            for (const auto& pair : m_results) {
-                if (pair.second.called != pair.second.complete) {
-                    return false;
+        //  Blocks until every call has posted results
+        void wait_complete() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(
+                lock,
+                [this]() {
+                    return m_outstanding == 0;
                 }
-            }
-
-            return true;
+            );
         }
     };
 
+    //  First error thrown by a job this frame
+    std::exception_ptr m_exception;
+    std::mutex m_exception_mutex;
+
     //  True when frame was discarded and draw requests should be ignored.
     bool m_discard_frame  {false};
 
     //  The total number of frames (resources).
     uint8_t m_frame_count  {0};
-    //  Number of worker threads.
-    uint8_t m_thread_count {4};
-
     //  The current frame number (0...frame count).
     uint8_t m_current_frame {0};
 
@@ -196,15 +286,27 @@ class RenderTaskManager
     VkPhysicalDevice m_physical_device {VK_NULL_HANDLE};
     VkDevice m_device                  {VK_NULL_HANDLE};
 
-    //  Worker threads
-    std::vector<std::thread> m_threads;
+    //  Set while workers are stopping so queued jobs are skipped
+    std::atomic<bool> m_canceled {false};
+
+    common::ThreadPool& m_thread_pool;
+    //  Jobs queued on the thread pool
+    common::TaskGroup m_jobs;
 
-    //  Job queue
-    common::JobQueue<Job> m_jobs;
+    //  Indexed by thread pool worker index. The last entry is used by the
+    //  main thread when it helps in wait_for_tasks().
+    std::vector<WorkerState> m_workers;
+
+    //  Jobs not yet claimed by a worker or the main thread
+    common::MpmcQueue<const Job*> m_job_queue;
 
     //  Worker thread task results
     RenderTasks m_tasks;
 
+    //  Data referenced by this frame's jobs
+    FrameData m_frame_data;
+
+    MemoryAllocator& m_allocator;
     DescriptorSetLayouts& m_descriptor_set_layouts;
     DescriptorSetManager& m_descriptor_set_mgr;
     ModelManager& m_model_mgr;
@@ -212,25 +314,37 @@ class RenderTaskManager
 
     std::vector<FrameUniformObjects> m_uniform_buffers;
 
-    //  Adds a new job for a worker thread to process.
-    void add_job(Job& job);
+    //  Takes ownership of a job and queues it for a worker thread to process.
+    void add_job(Job&& job);
     //  Called by worker threads when work is completed.
     void post_results(
         TaskId task_id,
         uint32_t order,
         VkCommandBuffer comand_buffer
     );
-    void thread_main(uint8_t thread_id);
-    void update_glyph_uniforms(render::GlyphBatch&& glyph_batch);
+    //  Records a job and posts its results
+    void record_job(const Job& job);
+    //  Called by worker threads to process a job. Failed jobs post empty
+    //  results and keep the error for wait_for_tasks.
+    void run_job(const Job& job);
+    //  Claims and processes the next queued job, if any
+    bool run_next_job();
+    void update_glyph_uniforms(
+        render::GlyphBatch&& glyph_batch,
+        const uint32_t uniform_offset,
+        const uint32_t instance_count
+    );
 
 public:
     RenderTaskManager(
         VkPhysicalDevice physical_device,
         VkDevice device,
+        MemoryAllocator& allocator,
         DescriptorSetLayouts& descriptor_set_layouts,
         DescriptorSetManager& descriptor_set_mgr,
         ModelManager& model_mgr,
         TextureManager& texture_mgr,
+        common::ThreadPool& thread_pool,
         uint8_t frame_count,
         uint32_t max_objects
     );
@@ -242,11 +356,14 @@ public:
         uint8_t current_frame,
         bool discard_frame
     );
+    //  Waits for queued jobs, skipping any that haven't started, then
+    //  releases the worker objects.
     void cancel_threads();
-    bool check_tasks_complete();
+    //  Draw calls take ownership of the batches and replace them with cleared
+    //  batches from an earlier frame
     void draw_billboards(
         BillboardRenderer& renderer,
-        const std::vector<render::SpriteBatch>& batches
+        std::vector<render::SpriteBatch>& batches
     );
     void draw_glyph_mesh(
         GlyphRenderer& renderer,
@@ -258,19 +375,20 @@ public:
     );
     void draw_models(
         ModelRenderer& renderer,
-        const std::vector<render::ModelBatch>& batches
+        std::vector<render::ModelBatch>& batches
     );
     void draw_spines(
         SpineSpriteRenderer& renderer,
-        const std::vector<render::SpineSpriteBatch>& batches
+        std::vector<render::SpineSpriteBatch>& batches
     );
     void draw_sprites(
         SpriteRenderer& renderer,
-        const std::vector<render::SpriteBatch>& batches
+        std::vector<render::SpriteBatch>& batches
     );
     void end_frame();
     void get_command_buffers(std::vector<VkCommandBuffer>& command_buffers);
     void shutdown();
+    //  Creates objects for each worker thread of the thread pool
     void start_threads();
     void update_frame_uniforms(
         const glm::mat4& view,
@@ -278,5 +396,9 @@ public:
         const glm::mat4& ortho_view,
         const glm::mat4& ortho_proj
     );
+    //  Waits for the frame's jobs to complete. The calling thread processes
+    //  queued jobs instead of sleeping. Rethrows the first error thrown by a
+    //  job.
+    void wait_for_tasks();
 };
 }
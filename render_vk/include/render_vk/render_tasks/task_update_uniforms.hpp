@@ -14,9 +14,12 @@ void task_update_frame_uniforms(
     UniformBuffer<FrameUbo>& frame_uniform
 );
 
+//  Writes up to instance_count glyph UBO's to the array allocated at offset
 void task_update_glyph_uniforms(
     const render::GlyphBatch& glyph_batch,
-    DynamicUniformBuffer<GlyphUbo>& object_uniform
+    DynamicUniformBuffer<GlyphUbo>& glyph_uniform,
+    const uint32_t offset,
+    const uint32_t instance_count
 );
 
 void task_update_object_uniforms(
@@ -2,6 +2,8 @@
 
 #include "render/sprite_batch.hpp"
 #include "render_vk/frame_objects.hpp"
+#include "render_vk/instance_buffer.hpp"
+#include "render_vk/sprite_instance.hpp"
 #include "render_vk/vulkan.hpp"
 #include <functional>
 
@@ -40,6 +42,7 @@ public:
     void draw_billboards(
         const std::vector<render::SpriteBatch>& batches,
         const FrameDescriptorObjects& descriptors,
+        InstanceBuffer<SpriteInstance>& instances,
         VkCommandBuffer command_buffer
     );
 };
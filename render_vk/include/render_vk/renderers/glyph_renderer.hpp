@@ -46,8 +46,10 @@ public:
         VkCommandBuffer command_buffer
     );
     //  Draws 2D glyphs
+    //  uniform_offset is the dynamic offset of the glyph UBO array
     void draw_glyphs(
         const uint32_t instance_count,
+        const uint32_t uniform_offset,
         const FrameDescriptorObjects& descriptors,
         const FrameUniformObjects& uniform_buffers,
         VkCommandBuffer command_buffer
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "render/model_batch.hpp"
+#include "render_vk/devices.hpp"
 #include "render_vk/frame_objects.hpp"
+#include "render_vk/instance_buffer.hpp"
+#include "render_vk/model_instance.hpp"
 #include "render_vk/vulkan.hpp"
 #include <functional>
 
@@ -20,8 +23,19 @@ class ModelRenderer
     VkPipelineLayout m_pipeline_layout  {VK_NULL_HANDLE};
     VkPipeline m_pipeline               {VK_NULL_HANDLE};
 
+    DeviceFeatures m_device_features;
+
     ModelManager& m_model_mgr;
 
+    //  Draws a range of indirect commands that use the same model
+    void draw_indirect(
+        const InstanceBuffer<VkDrawIndexedIndirectCommand>& commands,
+        const VkDrawIndexedIndirectCommand* first_command,
+        uint32_t first_command_index,
+        uint32_t command_count,
+        VkCommandBuffer command_buffer
+    );
+
 public:
     ModelRenderer(ModelManager& model_mgr);
     ModelRenderer(const ModelRenderer&) = delete;
@@ -32,14 +46,18 @@ public:
         const VulkanSwapchain& swapchain,
         VkRenderPass render_pass,
         const VkSampleCountFlagBits msaa_sample_count,
-        const DescriptorSetLayouts& descriptor_set_layouts
+        const DescriptorSetLayouts& descriptor_set_layouts,
+        const DeviceFeatures& device_features
     );
     //  Destroys resources
     void destroy_objects();
-    //  Draws 3D models
+    //  Draws 3D models with indirect draws. Consecutive batches that use
+    //  the same model are submitted with a single multi-draw.
     void draw_models(
         const std::vector<render::ModelBatch>& batches,
         const FrameDescriptorObjects& descriptors,
+        InstanceBuffer<ModelInstance>& instances,
+        InstanceBuffer<VkDrawIndexedIndirectCommand>& commands,
         VkCommandBuffer command_buffer
     );
 };
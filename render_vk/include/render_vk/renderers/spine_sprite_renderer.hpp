@@ -38,16 +38,21 @@ public:
     );
     //  Destroys resources
     void destroy_objects();
-    //  Draws 2D Spine sprites
+    //  Draws 2D Spine sprites. uniform_offset is the dynamic offset set by
+    //  update_object_uniforms().
     void draw_sprites(
         const std::vector<render::SpineSpriteBatch>& batches,
         const FrameDescriptorObjects& descriptors,
         const DynamicUniformBuffer<SpineUbo>& uniform_buffer,
+        const uint32_t uniform_offset,
         VkCommandBuffer command_buffer
     );
-    void update_object_uniforms(
+    //  Writes attachment transforms to the uniform buffer. Returns false if
+    //  no spine model is loaded yet or the uniform buffer is full.
+    bool update_object_uniforms(
         const std::vector<render::SpineSpriteBatch>& batches,
-        DynamicUniformBuffer<SpineUbo>& spine_uniform
+        DynamicUniformBuffer<SpineUbo>& spine_uniform,
+        uint32_t& uniform_offset
     );
 };
 }
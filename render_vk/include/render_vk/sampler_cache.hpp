@@ -0,0 +1,41 @@
+#pragma once
+
+#include "assets/texture_address_mode.hpp"
+#include "assets/texture_filter.hpp"
+#include "render_vk/vulkan.hpp"
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace assets
+{
+struct TextureCreateArgs;
+}
+
+namespace render_vk
+{
+//  Shares one sampler between all textures created with the same sampler
+//  settings. Thread safe.
+class SamplerCache
+{
+    using Key = std::tuple<
+        assets::TextureAddressMode,
+        assets::TextureFilter,
+        assets::TextureFilter
+    >;
+
+    VkDevice m_device {VK_NULL_HANDLE};
+    std::mutex m_mutex;
+    std::map<Key, VkSampler> m_samplers;
+
+public:
+    SamplerCache(VkDevice device);
+    ~SamplerCache();
+    SamplerCache(const SamplerCache&) = delete;
+    SamplerCache& operator=(const SamplerCache&) = delete;
+    //  Destroys all samplers. Textures using them must be destroyed first.
+    void destroy_samplers();
+    //  Returns the sampler for the arguments, creating it on first use
+    VkSampler get_sampler(const assets::TextureCreateArgs& args);
+};
+}
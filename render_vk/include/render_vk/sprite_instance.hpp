@@ -0,0 +1,55 @@
+#pragma once
+
+#include "render_vk/vulkan.hpp"
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <array>
+#include <cstdint>
+
+namespace render_vk
+{
+//  Per-instance sprite and billboard data.
+//  Bound to vertex binding 1 after the quad vertices.
+struct SpriteInstance
+{
+    glm::vec3 position;
+    glm::vec3 size;
+    uint32_t texture_index;
+    //  Texture coordinate offset in xy and size in zw
+    glm::vec4 uv_rect;
+
+    static std::array<VkVertexInputAttributeDescription, 4> get_attribute_descriptions() {
+        std::array<VkVertexInputAttributeDescription, 4> attrib_descs{};
+
+        attrib_descs[0].binding = 1;
+        attrib_descs[0].location = 3;
+        attrib_descs[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attrib_descs[0].offset = offsetof(SpriteInstance, position);
+
+        attrib_descs[1].binding = 1;
+        attrib_descs[1].location = 4;
+        attrib_descs[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attrib_descs[1].offset = offsetof(SpriteInstance, size);
+
+        attrib_descs[2].binding = 1;
+        attrib_descs[2].location = 5;
+        attrib_descs[2].format = VK_FORMAT_R32_UINT;
+        attrib_descs[2].offset = offsetof(SpriteInstance, texture_index);
+
+        attrib_descs[3].binding = 1;
+        attrib_descs[3].location = 6;
+        attrib_descs[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attrib_descs[3].offset = offsetof(SpriteInstance, uv_rect);
+
+        return attrib_descs;
+    }
+
+    static VkVertexInputBindingDescription get_binding_description() {
+        VkVertexInputBindingDescription binding_desc{};
+        binding_desc.binding = 1;
+        binding_desc.stride = sizeof(SpriteInstance);
+        binding_desc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return binding_desc;
+    }
+};
+}
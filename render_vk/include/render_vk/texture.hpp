@@ -1,8 +1,11 @@
 #pragma once
 
+#include "render_vk/memory_allocator.hpp"
 #include "render_vk/texture_id.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan.hpp"
 #include <string>
+#include <vector>
 
 namespace assets
 {
@@ -11,7 +14,7 @@ struct TextureCreateArgs;
 
 namespace render_vk
 {
-class VulkanQueue;
+class SamplerCache;
 
 static const uint32_t MAX_TEXTURES = 4096;
 
@@ -22,22 +25,72 @@ public:
     uint32_t width {0};
     uint32_t height {0};
     uint32_t mip_levels {0};
+    VkFormat format {VK_FORMAT_UNDEFINED};
     VkImage image {VK_NULL_HANDLE};
-    VkDeviceMemory image_memory {VK_NULL_HANDLE};
+    MemoryAllocation image_allocation;
+    //  Must complete before the texture is sampled
+    UploadTicket upload {0};
     VkImageLayout layout {VK_IMAGE_LAYOUT_UNDEFINED};
     VkImageView view {VK_NULL_HANDLE};
+    //  Shared with other textures and owned by SamplerCache
     VkSampler sampler {VK_NULL_HANDLE};
 };
 
 void create_texture(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
+    SamplerCache& sampler_cache,
     VkDevice device,
-    VulkanQueue& transfer_queue,
-    VkCommandPool command_pool,
     const std::string& filename,
     const assets::TextureCreateArgs& args,
     Texture& texture
 );
 
-void destroy_texture(VkDevice device, const Texture& texture);
+//  Creates a texture from 8-bit RGBA pixels
+void create_texture(
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
+    SamplerCache& sampler_cache,
+    VkDevice device,
+    const std::string& name,
+    const uint32_t width,
+    const uint32_t height,
+    const std::vector<unsigned char>& image,
+    const assets::TextureCreateArgs& args,
+    Texture& texture
+);
+
+//  Creates a texture from mip levels already encoded in the texture format,
+//  packed one after the other starting with the largest
+void create_texture_from_levels(
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
+    SamplerCache& sampler_cache,
+    VkDevice device,
+    const std::string& name,
+    const uint32_t width,
+    const uint32_t height,
+    const uint32_t mip_levels,
+    const unsigned char* data,
+    const size_t size,
+    const assets::TextureCreateArgs& args,
+    Texture& texture
+);
+
+void destroy_texture(
+    MemoryAllocator& allocator,
+    VkDevice device,
+    const Texture& texture
+);
+
+//  Number of mip levels down to 1x1
+uint32_t get_texture_mip_levels(const uint32_t width, const uint32_t height);
+
+//  Decodes a PNG file to 8-bit RGBA pixels. Throws if the file can't be read.
+void load_png(
+    const std::string& filename,
+    std::vector<unsigned char>& image,
+    uint32_t& width,
+    uint32_t& height
+);
 }
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/vec4.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace render_vk
+{
+//  Images packed into a single page of 8-bit RGBA pixels
+struct TextureAtlas
+{
+    uint32_t width  {0};
+    uint32_t height {0};
+    std::vector<unsigned char> pixels;
+    //  Texture coordinates of each image in the order they were given.
+    //  Offset is xy and size is zw.
+    std::vector<glm::vec4> uv_rects;
+};
+
+//  Decodes PNG files and packs them into a page of the given size. Throws if
+//  the images don't fit.
+void build_texture_atlas(
+    const std::vector<std::string>& paths,
+    const uint32_t width,
+    const uint32_t height,
+    TextureAtlas& atlas
+);
+}
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "render_vk/devices.hpp"
+#include "render_vk/sampler_cache.hpp"
 #include "render_vk/texture.hpp"
 #include "render_vk/vulkan.hpp"
+#include <array>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -13,33 +17,79 @@ struct TextureCreateArgs;
 
 namespace render_vk
 {
-class VulkanQueue;
-
 class TextureManager
 {
+    //  Texture replaced in its slot, destroyed once frames using it complete
+    struct RetiredTexture
+    {
+        Texture texture;
+        //  Frame number when the texture was replaced
+        uint32_t frame {0};
+    };
+
     //  Changes when textures are added or removed.
     uint32_t m_timestamp {1};
 
     mutable std::mutex m_mutex;
 
-    VkDevice m_device                  {VK_NULL_HANDLE};
-    VkPhysicalDevice m_physical_device {VK_NULL_HANDLE};
+    MemoryAllocator& m_allocator;
+    UploadManager& m_upload_mgr;
+    VkDevice m_device {VK_NULL_HANDLE};
+    DeviceFeatures m_device_features;
+
+    SamplerCache m_sampler_cache;
 
     std::vector<Texture> m_textures;
+    //  Timestamp when each slot of m_textures last changed
+    std::vector<uint32_t> m_slot_timestamps;
+    //  Loaded textures, added to m_textures once their upload completes
     std::vector<Texture> m_added;
+    std::vector<RetiredTexture> m_retired;
 
     Texture m_empty_texture;
 
+    //  One bit per texture ID, set when the texture is added to m_textures.
+    //  Read without locking the mutex.
+    std::array<std::atomic<uint64_t>, MAX_TEXTURES / 64> m_resident {};
+
 public:
     TextureManager(
-        VkPhysicalDevice physical_device,
-        VkDevice device
+        MemoryAllocator& allocator,
+        UploadManager& upload_mgr,
+        VkDevice device,
+        const DeviceFeatures& device_features
     );
     TextureManager(const TextureManager&) = delete;
     TextureManager& operator=(const TextureManager&) = delete;
     void add_texture(const Texture& texture);
+    //  Creates a texture from 8-bit RGBA pixels
+    Texture create_texture(
+        const TextureId texture_id,
+        const std::string& name,
+        const uint32_t width,
+        const uint32_t height,
+        const std::vector<unsigned char>& image,
+        const assets::TextureCreateArgs& args
+    );
+    //  Creates a texture from encoded mip levels. The format in args must be
+    //  one returned by get_supported_args.
+    Texture create_texture_from_levels(
+        const TextureId texture_id,
+        const std::string& name,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t mip_levels,
+        const unsigned char* data,
+        const size_t size,
+        const assets::TextureCreateArgs& args
+    );
     void destroy_textures();
-    void get_textures(std::vector<Texture>& textures) const;
+    //  Gets textures in slots that changed after a timestamp and returns the
+    //  current timestamp. A timestamp of zero gets every slot.
+    uint32_t get_changed_textures(
+        const uint32_t timestamp,
+        std::vector<Texture>& textures
+    ) const;
 
     //  Returns timestamp used to determine if textures were added or removed
     inline uint32_t get_timestamp() const {
@@ -48,15 +98,33 @@ public:
         return m_timestamp;
     }
 
-    void initialize(VulkanQueue& queue, VkCommandPool command_pool);
+    //  Replaces formats the device can't sample
+    assets::TextureCreateArgs get_supported_args(
+        const assets::TextureCreateArgs& args
+    ) const;
+    void initialize();
     Texture load_texture(
         const TextureId texture_id,
         const std::string& path,
-        VulkanQueue& queue,
-        VkCommandPool command_pool,
         const assets::TextureCreateArgs& args
     );
-    bool texture_exists(const TextureId texture_id) const;
-    void update_textures();
+
+    //  Returns true once a loaded texture has replaced the placeholder in
+    //  its slot. Lock free so render threads can call it for every batch.
+    inline bool texture_exists(const TextureId texture_id) const {
+        if (texture_id >= MAX_TEXTURES) {
+            return false;
+        }
+
+        const uint64_t bits =
+            m_resident[texture_id / 64].load(std::memory_order_acquire);
+
+        return (bits >> (texture_id % 64)) & 1;
+    }
+
+    //  Publishes textures whose upload completed, replacing any texture in
+    //  the same slot. Replaced textures are destroyed once frames_in_flight
+    //  frames have been submitted after frame.
+    void update_textures(const uint32_t frame, const uint32_t frames_in_flight);
 };
 }
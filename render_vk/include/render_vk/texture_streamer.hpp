@@ -0,0 +1,100 @@
+#pragma once
+
+#include "assets/texture_create_args.hpp"
+#include "render_vk/texture.hpp"
+#include "render_vk/upload_manager.hpp"
+#include "render_vk/vulkan.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace render_vk
+{
+class TextureManager;
+
+//  Keeps the encoded mip chain of mipmapped textures in system memory and
+//  only uploads the levels needed on screen. Textures start at a coarse
+//  level and are replaced by larger images as the batchers report their
+//  screen size. When the resident size exceeds the budget, the least recently
+//  used textures are dropped back to the coarse level. Thread safe.
+class TextureStreamer
+{
+    static const VkDeviceSize DEFAULT_BUDGET = 256 * 1024 * 1024;
+    //  Largest dimension of the coarse level uploaded when a texture loads
+    static const uint32_t COARSE_SIZE = 64;
+    //  Limits upload bytes queued per frame to keep frame times stable
+    static const VkDeviceSize MAX_FRAME_UPLOAD = 16 * 1024 * 1024;
+
+    struct Entry
+    {
+        TextureId id {0};
+        std::string name;
+        //  Format is supported by the device
+        assets::TextureCreateArgs args {};
+        uint32_t width {0};
+        uint32_t height {0};
+        uint32_t mip_levels {0};
+        //  Every mip level encoded in the texture format
+        std::vector<unsigned char> data;
+        //  Offset of each level in data, followed by the data size
+        std::vector<size_t> level_offsets;
+        //  Smallest level streamed out to when evicting
+        uint32_t coarse_level {0};
+        //  Largest level on the GPU
+        uint32_t resident_level {0};
+        //  Largest level of the upload in flight, equal to resident_level
+        //  when there is none
+        uint32_t pending_level {0};
+        UploadTicket pending_upload {0};
+        //  Largest level needed by the frame it was last used in
+        uint32_t wanted_level {0};
+        uint32_t last_used_frame {0};
+    };
+
+    TextureManager& m_texture_mgr;
+    UploadManager& m_upload_mgr;
+
+    std::mutex m_mutex;
+    std::map<TextureId, Entry> m_entries;
+    VkDeviceSize m_budget {DEFAULT_BUDGET};
+    //  Size of the levels each texture is streaming to. Evicted levels stop
+    //  counting as soon as the smaller image is queued.
+    VkDeviceSize m_resident_size {0};
+    //  Frame that usage is being reported for
+    uint32_t m_frame {1};
+
+    //  Shrinks textures, least recently used first, until needed bytes fit
+    //  in the budget
+    void evict(const VkDeviceSize needed);
+    inline VkDeviceSize get_size(const Entry& entry, const uint32_t level) const {
+        return entry.level_offsets.back() - entry.level_offsets.at(level);
+    }
+    //  Queues an image holding the levels from level down to 1x1
+    void stream(Entry& entry, const uint32_t level);
+
+public:
+    TextureStreamer(TextureManager& texture_mgr, UploadManager& upload_mgr);
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+    void clear();
+    inline VkDeviceSize get_budget() const {
+        return m_budget;
+    }
+    //  Loads a texture, streaming it if it has mipmaps. Called by asset
+    //  worker threads. The returned size is the full size of the texture.
+    Texture load_texture(
+        const TextureId texture_id,
+        const std::string& path,
+        const assets::TextureCreateArgs& args
+    );
+    //  Reports the largest size in pixels a texture covers on screen this
+    //  frame. Zero requests the full resolution.
+    void request_texture(const TextureId texture_id, const float screen_size);
+    //  Sets the size in bytes that streamed textures try to stay under
+    void set_budget(const VkDeviceSize budget);
+    //  Queues uploads and evictions based on the usage reported for the
+    //  previous frame. Called by the main thread once per frame.
+    void update();
+};
+}
@@ -15,12 +15,17 @@ struct FrameUbo
     glm::mat4 ortho_proj;
 };
 
+//  Maximum glyphs per draw. Must match MAX_GLYPHS in glyph_ubo.glsl.
+const uint32_t MAX_GLYPHS = 200;
+
 //  Per-instance UBO data (updated every frame)
 struct alignas(16) GlyphUbo
 {
     alignas(16) glm::mat4 model;
     alignas(16) glm::vec4 bg_color;
     alignas(16) glm::vec4 fg_color;
+    //  Texture coordinate offset in xy and size in zw
+    alignas(16) glm::vec4 uv_rect;
     alignas(4) uint32_t texture_index;
 };
 
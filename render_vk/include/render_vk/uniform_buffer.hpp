@@ -14,13 +14,15 @@ namespace render_vk
 template <typename T>
 class UniformBuffer
 {
+    MemoryAllocator* m_allocator {nullptr};
+
     VkDevice m_device {VK_NULL_HANDLE};
 
     //  Uniform buffer
     VkBuffer m_buffer {VK_NULL_HANDLE};
 
     //  Uniform buffer memory
-    VkDeviceMemory m_memory {VK_NULL_HANDLE};
+    MemoryAllocation m_allocation;
 
     //  Mapped memory for UBO data (CPU -> GPU)
     void* m_mapped {nullptr};
@@ -35,50 +37,36 @@ public:
         memcpy(m_mapped, &ubo, sizeof(T));
     }
 
-    void create(VkPhysicalDevice physical_device, VkDevice device) {
+    void create(MemoryAllocator& allocator, VkDevice device) {
+        m_allocator = &allocator;
         m_device = device;
 
-        //  Create UBO uniform buffer (GPU)
+        //  Create UBO uniform buffer (GPU). Host visible memory is mapped by
+        //  the allocator.
         create_buffer(
-            physical_device,
+            allocator,
             device,
             sizeof(T),
             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
             m_buffer,
-            m_memory
+            m_allocation
         );
 
-        //  Map UBO data
-        assert(m_memory != VK_NULL_HANDLE);
-        assert(m_mapped == nullptr);
-        vkMapMemory(
-            device,
-            m_memory,
-            0,
-            sizeof(T),
-            0,
-            &m_mapped
-        );
+        m_mapped = m_allocation.mapped;
         assert(m_mapped != nullptr);
     }
 
     void destroy() {
-        //  Unmap UBO data
-        if (m_mapped != VK_NULL_HANDLE) {
-            vkUnmapMemory(m_device, m_memory);
-            m_mapped = VK_NULL_HANDLE;
-        }
-
-        //  Destroy uniform buffer
-        vkDestroyBuffer(m_device, m_buffer, nullptr);
-        m_buffer = VK_NULL_HANDLE;
+        m_mapped = nullptr;
 
-        //  Free uniform buffer memory
-        vkFreeMemory(m_device, m_memory, nullptr);
-        m_memory = VK_NULL_HANDLE;
+        //  Destroy uniform buffer and free its memory
+        if (m_allocator != nullptr) {
+            destroy_buffer(*m_allocator, m_device, m_buffer, m_allocation);
+        }
 
         //  Clear device
+        m_allocator = nullptr;
         m_device = VK_NULL_HANDLE;
     }
 
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "render_vk/memory_allocator.hpp"
+#include "render_vk/vulkan.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace render_vk
+{
+class VulkanQueue;
+
+//  Identifies the batch an upload is submitted in. Zero is always complete.
+using UploadTicket = uint64_t;
+
+//  Copies buffer and image data to device local memory without blocking the
+//  caller. Data is written to a persistently mapped staging ring buffer and
+//  the copies are batched into a single submission, made by update() once
+//  per frame. Each batch signals a fence; callers poll is_complete() with
+//  the ticket returned when the upload was queued. Thread safe.
+class UploadManager
+{
+    static const VkDeviceSize DEFAULT_RING_SIZE = 32 * 1024 * 1024;
+
+    struct BufferCopy
+    {
+        VkBuffer src;
+        VkDeviceSize src_offset;
+        VkBuffer dst;
+        VkDeviceSize size;
+    };
+
+    struct ImageCopy
+    {
+        VkBuffer src;
+        VkDeviceSize src_offset;
+        VkImage dst;
+        VkFormat format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mip_levels;
+        //  Levels in the staged data. The rest are generated.
+        uint32_t data_levels;
+    };
+
+    //  Staging buffer for data that does not fit in the ring
+    struct StagingBuffer
+    {
+        VkBuffer buffer {VK_NULL_HANDLE};
+        MemoryAllocation allocation;
+    };
+
+    //  Submitted copies
+    struct Batch
+    {
+        UploadTicket ticket {0};
+        VkCommandBuffer command_buffer {VK_NULL_HANDLE};
+        VkFence fence {VK_NULL_HANDLE};
+        //  Ring position released once the batch completes
+        uint64_t ring_end {0};
+        std::vector<StagingBuffer> staging_buffers;
+    };
+
+    MemoryAllocator& m_allocator;
+    VkDevice m_device {VK_NULL_HANDLE};
+    VulkanQueue& m_queue;
+    VkCommandPool m_command_pool {VK_NULL_HANDLE};
+
+    mutable std::mutex m_mutex;
+
+    //  Staging ring buffer. Head and tail are positions that only increase;
+    //  the offset into the buffer is the position modulo the ring size.
+    VkBuffer m_ring_buffer {VK_NULL_HANDLE};
+    MemoryAllocation m_ring_allocation;
+    char* m_ring {nullptr};
+    VkDeviceSize m_ring_size {0};
+    VkDeviceSize m_ring_align {0};
+    uint64_t m_ring_head {0};
+    uint64_t m_ring_tail {0};
+
+    //  Copies waiting for the next submission
+    std::vector<BufferCopy> m_buffer_copies;
+    std::vector<ImageCopy> m_image_copies;
+    std::vector<StagingBuffer> m_staging_buffers;
+
+    //  Submitted batches, oldest first
+    std::deque<Batch> m_batches;
+    std::vector<VkCommandBuffer> m_free_command_buffers;
+    std::vector<VkFence> m_free_fences;
+
+    //  Ticket of the batch that pending copies will be submitted in
+    UploadTicket m_next_ticket {1};
+    std::atomic<UploadTicket> m_completed {0};
+
+    bool reserve_ring(const VkDeviceSize size, VkDeviceSize& offset);
+    void retire_batch();
+    void retire_completed();
+    void stage(
+        const void* data,
+        const VkDeviceSize size,
+        VkBuffer& buffer,
+        VkDeviceSize& offset
+    );
+    void submit_pending();
+
+public:
+    UploadManager(
+        VkPhysicalDevice physical_device,
+        MemoryAllocator& allocator,
+        VkDevice device,
+        VulkanQueue& queue,
+        const VkDeviceSize ring_size = DEFAULT_RING_SIZE
+    );
+    ~UploadManager();
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+    inline bool is_complete(const UploadTicket ticket) const {
+        return ticket <= m_completed.load(std::memory_order_acquire);
+    }
+    //  Releases completed batches and submits pending copies. Called by the
+    //  main thread once per frame.
+    void update();
+    //  Queues a copy to a vertex or index buffer
+    UploadTicket upload_buffer(
+        VkBuffer buffer,
+        const void* data,
+        const VkDeviceSize size
+    );
+    //  Queues a copy to the first data_levels mip levels of an image in
+    //  UNDEFINED layout. Levels are packed one after the other in data. The
+    //  remaining levels are generated and the image is left in
+    //  SHADER_READ_ONLY_OPTIMAL.
+    UploadTicket upload_image(
+        VkImage image,
+        const VkFormat format,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t mip_levels,
+        const uint32_t data_levels,
+        const void* data,
+        const VkDeviceSize size
+    );
+    //  Submits pending copies if needed and blocks until the ticket completes
+    void wait(const UploadTicket ticket);
+    //  Submits pending copies and blocks until every batch completes
+    void wait_idle();
+};
+}
@@ -1,67 +1,37 @@
 #pragma once
 
 #include "render_vk/buffer.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vertex.hpp"
 #include "render_vk/vulkan.hpp"
-#include "render_vk/vulkan_queue.hpp"
-#include <cstring>
-#include <stdexcept>
 #include <vector>
 
 namespace render_vk
 {
-class VulkanQueue;
-
+//  Creates a device local vertex buffer and queues the vertex data upload.
+//  Returns the upload ticket.
 template <typename T>
-void create_vertex_buffer(
-    VkPhysicalDevice physical_device,
+UploadTicket create_vertex_buffer(
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
     VkDevice device,
-    VulkanQueue& transfer_queue,
-    VkCommandPool command_pool,
     const std::vector<T>& vertices,
     VkBuffer& vertex_buffer,
-    VkDeviceMemory& vertex_buffer_memory
+    MemoryAllocation& vertex_buffer_allocation
 ) {
     //  Create vertex buffer
     VkDeviceSize buffer_size = sizeof(T) * vertices.size();
 
-    VkBuffer staging_buffer;
-    VkDeviceMemory staging_buffer_memory;
-
     create_buffer(
-        physical_device,
-        device,
-        buffer_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        staging_buffer,
-        staging_buffer_memory
-    );
-
-    void* data;
-    vkMapMemory(device, staging_buffer_memory, 0, buffer_size, 0, &data);
-    memcpy(data, vertices.data(), (size_t)buffer_size);
-    vkUnmapMemory(device, staging_buffer_memory);
-
-    create_buffer(
-        physical_device,
+        allocator,
         device,
         buffer_size,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         vertex_buffer,
-        vertex_buffer_memory
-    );
-
-    transfer_queue.copy_buffer(
-        command_pool,
-        staging_buffer,
-        vertex_buffer,
-        buffer_size
+        vertex_buffer_allocation
     );
 
-    //  Free staging buffer
-    vkDestroyBuffer(device, staging_buffer, nullptr);
-    vkFreeMemory(device, staging_buffer_memory, nullptr);
+    return upload_mgr.upload_buffer(vertex_buffer, vertices.data(), buffer_size);
 }
 }
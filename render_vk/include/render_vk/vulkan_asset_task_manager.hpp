@@ -2,15 +2,16 @@
 
 #include "assets/asset_task_manager.hpp"
 #include "assets/texture_create_args.hpp"
-#include "common/job_queue.hpp"
+#include "common/stopwatch.hpp"
+#include "common/thread_pool.hpp"
 #include "render_vk/texture.hpp"
 #include "render_vk/vulkan.hpp"
+#include <atomic>
+#include <exception>
 #include <future>
 #include <memory>
-#include <mutex>
 #include <optional>
-#include <queue>
-#include <thread>
+#include <string>
 #include <vector>
 
 namespace render_vk
@@ -19,7 +20,8 @@ struct Mesh;
 class ModelManager;
 class Texture;
 class TextureManager;
-class VulkanQueue;
+class TextureStreamer;
+class UploadManager;
 class VulkanSpineManager;
 
 class VulkanAssetTaskManager : public assets::AssetTaskManager
@@ -36,58 +38,72 @@ private:
         LoadModel,
         LoadSpine,
         LoadTexture,
+        LoadTextureAtlas,
     };
 
+    //  Passes a failed job's error on to whatever waits for its promise
+    static void set_job_exception(Job* job, std::exception_ptr exception);
     static const char* task_id_to_string(TaskId task_id);
 
 
-    //  Objects for worker threads
+    //  Objects for each worker thread of the thread pool
     struct ThreadState
     {
-        VkCommandPool command_pool;
+        std::string name;
+        common::Stopwatch stopwatch;
     };
 
-    //  Number of worker threads.
-    uint8_t m_thread_count {4};
+    //  Set while workers are stopping so queued jobs are skipped
+    std::atomic<bool> m_canceled {false};
 
-    VkPhysicalDevice m_physical_device {VK_NULL_HANDLE};
-    VkDevice m_device                  {VK_NULL_HANDLE};
+    VkDevice m_device {VK_NULL_HANDLE};
 
-    //  Worker threads
-    std::vector<std::thread> m_threads;
+    common::ThreadPool& m_thread_pool;
+    //  Jobs queued on the thread pool
+    common::TaskGroup m_jobs;
 
-    //  Job queue
-    common::JobQueue<std::unique_ptr<Job>> m_jobs;
+    //  Indexed by thread pool worker index
+    std::vector<ThreadState> m_workers;
 
-    VulkanQueue& m_queue;
+    MemoryAllocator& m_allocator;
+    UploadManager& m_upload_mgr;
     ModelManager& m_model_mgr;
     VulkanSpineManager& m_spine_mgr;
     TextureManager& m_texture_mgr;
+    TextureStreamer& m_texture_streamer;
 
     //  Adds a new job for a worker thread to process.
     void add_job(std::unique_ptr<Job> job);
     void thread_create_glyph_mesh(ThreadState& state, Job* job);
     void thread_load_model(ThreadState& state, Job* job);
+    void thread_load_texture_atlas(ThreadState& state, Job* job);
     Texture thread_load_texture(
         const TextureId texture_id,
         const std::string& path,
         const assets::TextureCreateArgs& create_args,
         ThreadState& state
     );
-    void thread_main(uint8_t thread_id);
+    void process_job(ThreadState& state, Job* job);
+    //  Called by worker threads to process a job. Errors are logged and set
+    //  on the job's promise.
+    void run_job(Job* job);
 
 public:
     VulkanAssetTaskManager(
-        VkPhysicalDevice physical_device,
         VkDevice device,
-        VulkanQueue& queue,
+        MemoryAllocator& allocator,
+        UploadManager& upload_mgr,
         ModelManager& model_mgr,
         VulkanSpineManager& spine_mgr,
-        TextureManager& texture_mgr
+        TextureManager& texture_mgr,
+        TextureStreamer& texture_streamer,
+        common::ThreadPool& thread_pool
     );
     ~VulkanAssetTaskManager();
     VulkanAssetTaskManager(const VulkanAssetTaskManager&) = delete;
     VulkanAssetTaskManager& operator=(const VulkanAssetTaskManager&) = delete;
+    //  Waits for queued jobs, skipping any that haven't started, then
+    //  releases the worker objects.
     void cancel_threads();
     virtual void create_glyph_mesh(
         uint32_t id,
@@ -109,7 +125,15 @@ public:
         assets::TextureLoadArgs& load_args,
         const assets::TextureCreateArgs& create_args
     ) override;
+    //  Enqueues a job packing images into a single texture for worker
+    //  threads to complete
+    virtual void load_texture_atlas(
+        assets::AssetId id,
+        assets::TextureAtlasLoadArgs& load_args,
+        const assets::TextureCreateArgs& create_args
+    ) override;
     void shutdown();
+    //  Creates objects for each worker thread of the thread pool
     void start_threads();
 };
 }
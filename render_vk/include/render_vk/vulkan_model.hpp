@@ -5,12 +5,12 @@
 #include "render_vk/mesh.hpp"
 #include "render_vk/vertex_buffer.hpp"
 #include "render_vk/vulkan.hpp"
+#include <algorithm>
 #include <vector>
 
 namespace render_vk
 {
 struct GlyphMesh;
-class VulkanQueue;
 
 struct ModelMesh
 {
@@ -25,17 +25,22 @@ class VulkanModel
 
     AssetId m_id;
     uint32_t m_index_count;
+    MemoryAllocator* m_allocator;
     VkDevice m_device;
     VkBuffer m_vertex_buffer;
-    VkDeviceMemory m_vertex_buffer_memory;
+    MemoryAllocation m_vertex_buffer_allocation;
     VkBuffer m_index_buffer;
-    VkDeviceMemory m_index_buffer_memory;
+    MemoryAllocation m_index_buffer_allocation;
+    //  Must complete before the model is drawn
+    UploadTicket m_upload;
     std::vector<ModelMesh> m_meshes;
 
 public:
     VulkanModel(const assets::AssetId id = 0)
     : m_id(id),
-      m_device(nullptr) {
+      m_allocator(nullptr),
+      m_device(nullptr),
+      m_upload(0) {
     }
 
     virtual ~VulkanModel() {
@@ -58,48 +63,51 @@ public:
         return m_meshes;
     }
 
+    inline UploadTicket get_upload() const {
+        return m_upload;
+    }
+
     inline VkBuffer get_vertex_buffer() const {
         return m_vertex_buffer;
     }
 
     template <typename T>
     void load(
-        VkPhysicalDevice physical_device,
+        MemoryAllocator& allocator,
+        UploadManager& upload_mgr,
         VkDevice device,
-        VulkanQueue& graphics_queue,
-        VkCommandPool command_pool,
         MeshBase<T>& mesh
     ) {
+        m_allocator = &allocator;
         m_device = device;
 
         m_index_count = static_cast<uint32_t>(mesh.indices.size());
 
-        create_vertex_buffer(
-            physical_device,
+        const UploadTicket vertex_upload = create_vertex_buffer(
+            allocator,
+            upload_mgr,
             device,
-            graphics_queue,
-            command_pool,
             mesh.vertices,
             m_vertex_buffer,
-            m_vertex_buffer_memory
+            m_vertex_buffer_allocation
         );
 
-        create_index_buffer(
-            physical_device,
+        const UploadTicket index_upload = create_index_buffer(
+            allocator,
+            upload_mgr,
             device,
-            graphics_queue,
-            command_pool,
             mesh.indices,
             m_index_buffer,
-            m_index_buffer_memory
+            m_index_buffer_allocation
         );
+
+        m_upload = std::max(vertex_upload, index_upload);
     }
 
     void load(
-        VkPhysicalDevice physical_device,
+        MemoryAllocator& allocator,
+        UploadManager& upload_mgr,
         VkDevice device,
-        VulkanQueue& graphics_queue,
-        VkCommandPool command_pool,
         std::vector<Mesh>& meshes
     );
 
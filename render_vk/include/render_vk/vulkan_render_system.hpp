@@ -6,6 +6,7 @@
 #include "render_vk/color_image.hpp"
 #include "render_vk/descriptor_set_layout.hpp"
 #include "render_vk/depth.hpp"
+#include "render_vk/devices.hpp"
 #include "render_vk/frame_objects.hpp"
 #include "render_vk/vulkan.hpp"
 #include "render_vk/vulkan_asset_task_manager.hpp"
@@ -26,6 +27,8 @@ class RenderTaskManager;
 class SpriteRenderer;
 class SpineSpriteRenderer;
 class TextureManager;
+class TextureStreamer;
+class UploadManager;
 class VulkanSpineManager;
 
 class VulkanRenderSystem : public render::Renderer
@@ -61,13 +64,21 @@ private:
     uint8_t m_frame_count               = 3;
     //  The current frame number (0...frame count).
     uint8_t m_current_frame             = 0;
+    //  Number of frames submitted, used to delay destroying replaced textures
+    uint32_t m_submitted_frames         = 0;
     //  Swapchain image index
     uint32_t m_image_index              = 0;
 
     uint32_t m_max_objects {0};
 
+    //  Runs render and asset jobs
+    common::ThreadPool& m_thread_pool;
+
     VkSampleCountFlagBits m_msaa_samples {VK_SAMPLE_COUNT_1_BIT};
 
+    //  Optional features enabled on the device
+    DeviceFeatures m_device_features;
+
     VkInstance m_instance               = VK_NULL_HANDLE;
     VkPhysicalDevice m_physical_device  = VK_NULL_HANDLE;
     VkDevice m_device                   = VK_NULL_HANDLE;
@@ -75,6 +86,9 @@ private:
     //  Render pass
     VkRenderPass m_render_pass          = VK_NULL_HANDLE;
 
+    //  Sub-allocates device memory for buffers and images
+    std::unique_ptr<MemoryAllocator> m_memory_allocator;
+
     //  Command pool used to create main thread resources
     VkCommandPool m_resource_command_pool = VK_NULL_HANDLE;
 
@@ -89,6 +103,8 @@ private:
     std::shared_ptr<VulkanQueue> m_graphics_queue;
     //  Presentation queue (may be the same as graphics queue)
     std::shared_ptr<VulkanQueue> m_present_queue;
+    //  Batches staging copies to device local memory
+    std::unique_ptr<UploadManager> m_upload_mgr;
 
     //  Swapchain
     VulkanSwapchain m_swapchain;
@@ -103,6 +119,7 @@ private:
     std::unique_ptr<ModelManager> m_model_mgr;
     std::shared_ptr<VulkanSpineManager> m_spine_mgr;
     std::unique_ptr<TextureManager> m_texture_mgr;
+    std::unique_ptr<TextureStreamer> m_texture_streamer;
 
     std::shared_ptr<VulkanAssetTaskManager> m_asset_task_mgr;
     //  Manages rendering task worker threads
@@ -116,9 +133,6 @@ private:
     std::unique_ptr<SpineSpriteRenderer> m_spine_sprite_renderer;
     std::unique_ptr<SpriteRenderer> m_sprite_renderer;
 
-    //  Checks the status of the current frame's rendering tasks.
-    //  This function should only be called from end_frame.
-    bool check_render_tasks_complete();
     //  Creates frame objects.
     void create_frame_resources();
     //  Creates swapchain and render pass.
@@ -130,9 +144,15 @@ private:
     void recreate_swapchain();
     //  Releases objects.
     void shutdown();
+    //  Waits for the current frame's rendering tasks.
+    //  This function should only be called from end_frame.
+    void wait_for_render_tasks();
 
 public:
-    VulkanRenderSystem(const uint32_t max_objects);
+    VulkanRenderSystem(
+        const uint32_t max_objects,
+        common::ThreadPool& thread_pool
+    );
     ~VulkanRenderSystem();
     //  Starts a new frame.
     virtual void begin_frame() override;
@@ -165,6 +185,7 @@ public:
     virtual bool initialize(GLFWwindow* glfw_window) override;
     //  Framebuffer was resized
     virtual void resize() override;
+    virtual void set_texture_budget(const size_t bytes) override;
     virtual void update_frame_uniforms(
         const glm::mat4& view,
         const glm::mat4& proj,
@@ -12,7 +12,7 @@
 namespace render_vk
 {
 class SpineModel;
-class VulkanQueue;
+class UploadManager;
 
 class VulkanSpineManager : public assets::SpineManager
 {
@@ -36,6 +36,6 @@ public:
     SpineModel* get_spine_model(const AssetId id) const;
     bool spine_model_exists(const AssetId id) const;
     void unload();
-    void update_models();
+    void update_models(const UploadManager& upload_mgr);
 };
 }
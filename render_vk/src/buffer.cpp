@@ -1,66 +1,37 @@
+#include "render_vk/buffer.hpp"
 #include "render_vk/command_buffer.hpp"
 #include "render_vk/vulkan.hpp"
-#include <cstring>
 #include <stdexcept>
 
 namespace render_vk
 {
-//  ----------------------------------------------------------------------------
-uint32_t find_memory_type(
-    VkPhysicalDevice physical_device,
-    uint32_t type_filter,
-    VkMemoryPropertyFlags properties
-) {
-    VkPhysicalDeviceMemoryProperties mem_properties;
-    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
-
-    for (uint32_t n = 0; n < mem_properties.memoryTypeCount; ++n) {
-        if ((type_filter & (1 << n)) &&
-            (mem_properties.memoryTypes[n].propertyFlags & properties)
-        ) {
-            return n;
-        }
-    }
-
-    throw std::runtime_error("Failed to find suitable memory type.");
-}
-
 //  ----------------------------------------------------------------------------
 static void allocate_buffer(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VkBuffer buffer,
     VkMemoryPropertyFlags properties,
-    VkDeviceMemory& buffer_memory
+    AllocationStrategy strategy,
+    MemoryAllocation& allocation
 ) {
     VkMemoryRequirements mem_requirements;
     vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
 
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_requirements.size;
-    alloc_info.memoryTypeIndex = find_memory_type(
-        physical_device,
-        mem_requirements.memoryTypeBits,
-        properties
-    );
+    allocator.allocate(mem_requirements, properties, false, strategy, allocation);
 
-    if (vkAllocateMemory(device, &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate vertex buffer memory.");
-    }
-
-    vkBindBufferMemory(device, buffer, buffer_memory, 0);
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
 }
 
 //  ----------------------------------------------------------------------------
 void create_buffer(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VkDeviceSize size,
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer& buffer,
-    VkDeviceMemory& buffer_memory
+    MemoryAllocation& allocation,
+    AllocationStrategy strategy
 ) {
     VkBufferCreateInfo buffer_info{};
     buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -73,11 +44,26 @@ void create_buffer(
     }
 
     allocate_buffer(
-        physical_device,
+        allocator,
         device,
         buffer,
         properties,
-        buffer_memory
+        strategy,
+        allocation
     );
 }
+
+//  ----------------------------------------------------------------------------
+void destroy_buffer(
+    MemoryAllocator& allocator,
+    VkDevice device,
+    VkBuffer& buffer,
+    MemoryAllocation& allocation
+) {
+    vkDestroyBuffer(device, buffer, nullptr);
+    buffer = VK_NULL_HANDLE;
+
+    allocator.free(allocation);
+    allocation = {};
+}
 }
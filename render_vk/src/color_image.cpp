@@ -7,7 +7,7 @@ namespace render_vk
 {
 //  ----------------------------------------------------------------------------
 void create_color_resources(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     const VulkanSwapchain& swapchain,
     VkSampleCountFlagBits msaa_sample_count,
@@ -16,7 +16,7 @@ void create_color_resources(
     VkFormat color_format = swapchain.format;
 
     create_image(
-        physical_device,
+        allocator,
         device,
         swapchain.extent.width,
         swapchain.extent.height,
@@ -27,7 +27,7 @@ void create_color_resources(
         VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         color_image.image,
-        color_image.memory
+        color_image.allocation
     );
 
     color_image.view = create_image_view(
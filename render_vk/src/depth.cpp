@@ -61,6 +61,7 @@ VkFormat find_depth_format(VkPhysicalDevice physical_device) {
 //  ----------------------------------------------------------------------------
 void create_depth_resources(
     VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VulkanQueue& transfer_queue,
     VkCommandPool command_pool,
@@ -68,12 +69,12 @@ void create_depth_resources(
     VkSampleCountFlagBits msaa_sample_count,
     VkImage& depth_image,
     VkImageView& depth_image_view,
-    VkDeviceMemory& depth_image_memory
+    MemoryAllocation& depth_image_allocation
 ) {
     VkFormat depth_format = find_depth_format(physical_device);
 
     create_image(
-        physical_device,
+        allocator,
         device,
         swapchain.extent.width,
         swapchain.extent.height,
@@ -84,7 +85,7 @@ void create_depth_resources(
         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         depth_image,
-        depth_image_memory
+        depth_image_allocation
     );
 
     depth_image_view = create_image_view(
@@ -110,6 +111,7 @@ void create_depth_resources(
 //  ----------------------------------------------------------------------------
 void create_depth_resources(
     VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     VulkanQueue& transfer_queue,
     VkCommandPool command_pool,
@@ -119,6 +121,7 @@ void create_depth_resources(
 ) {
     create_depth_resources(
         physical_device,
+        allocator,
         device,
         transfer_queue,
         command_pool,
@@ -126,7 +129,7 @@ void create_depth_resources(
         msaa_sample_count,
         depth_image.image,
         depth_image.view,
-        depth_image.memory
+        depth_image.allocation
     );
 
     set_debug_name(
@@ -142,12 +145,5 @@ void create_depth_resources(
         depth_image.view,
         "depth_image_view"
     );
-
-    set_debug_name(
-        device,
-        VK_OBJECT_TYPE_DEVICE_MEMORY,
-        depth_image.memory,
-        "depth_image_memory"
-    );
 }
 }
@@ -9,32 +9,59 @@ using namespace common;
 namespace render_vk
 {
 //  ----------------------------------------------------------------------------
+//  Writes slots that changed after timestamp. Each run of consecutive changed
+//  slots is written with a single descriptor write.
 static void update_texture_descriptor_sets(
     VkDevice device,
     const std::vector<Texture>& textures,
+    const std::vector<uint32_t>& slot_timestamps,
+    const uint32_t timestamp,
     VkDescriptorSet& descriptor_set
 ) {
     assert(!textures.empty());
-
-    std::vector<VkDescriptorImageInfo> image_infos(textures.size());
-    for (size_t n = 0; n < image_infos.size(); ++n) {
-        image_infos[n].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        image_infos[n].imageView = textures[n].view;
-        image_infos[n].sampler = textures[n].sampler;
+    assert(textures.size() == slot_timestamps.size());
+
+    //  Writes point into image_infos so it must not reallocate
+    std::vector<VkDescriptorImageInfo> image_infos;
+    image_infos.reserve(textures.size());
+
+    std::vector<VkWriteDescriptorSet> descriptor_writes;
+
+    size_t n = 0;
+    while (n < textures.size()) {
+        if (slot_timestamps[n] <= timestamp) {
+            ++n;
+            continue;
+        }
+
+        const size_t first = n;
+        const size_t info_index = image_infos.size();
+
+        for (; n < textures.size() && slot_timestamps[n] > timestamp; ++n) {
+            VkDescriptorImageInfo image_info{};
+            image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            image_info.imageView = textures[n].view;
+            image_info.sampler = textures[n].sampler;
+            image_infos.push_back(image_info);
+        }
+
+        //  Combined texture sampler
+        VkWriteDescriptorSet descriptor_write{};
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstSet = descriptor_set;
+        descriptor_write.dstBinding = 0;
+        descriptor_write.dstArrayElement = static_cast<uint32_t>(first);
+        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_write.descriptorCount = static_cast<uint32_t>(n - first);
+        descriptor_write.pBufferInfo = nullptr;
+        descriptor_write.pImageInfo = &image_infos[info_index];
+        descriptor_write.pTexelBufferView = nullptr;
+        descriptor_writes.push_back(descriptor_write);
     }
 
-    std::array<VkWriteDescriptorSet, 1> descriptor_writes{};
-
-    //  Combined texture sampler
-    descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptor_writes[0].dstSet = descriptor_set;
-    descriptor_writes[0].dstBinding = 0;
-    descriptor_writes[0].dstArrayElement = 0;
-    descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptor_writes[0].descriptorCount = static_cast<uint32_t>(image_infos.size());
-    descriptor_writes[0].pBufferInfo = nullptr;
-    descriptor_writes[0].pImageInfo = image_infos.data();
-    descriptor_writes[0].pTexelBufferView = nullptr;
+    if (descriptor_writes.empty()) {
+        return;
+    }
 
     vkUpdateDescriptorSets(
         device,
@@ -54,12 +81,29 @@ DescriptorSetManager::DescriptorSetManager(
 }
 
 //  ----------------------------------------------------------------------------
-void DescriptorSetManager::copy_texture_descriptor_set(VkDescriptorSet dst) {
+void DescriptorSetManager::copy_texture_descriptor_set(
+    VkDescriptorSet dst,
+    uint32_t& timestamp
+) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     assert(!m_textures.empty());
 
-    update_texture_descriptor_sets(m_device, m_textures, dst);
+    update_texture_descriptor_sets(
+        m_device,
+        m_textures,
+        m_slot_timestamps,
+        timestamp,
+        dst
+    );
+
+    timestamp = m_texture_timestamp;
+}
+
+//  ----------------------------------------------------------------------------
+uint32_t DescriptorSetManager::get_texture_timestamp() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_texture_timestamp;
 }
 
 //  ----------------------------------------------------------------------------
@@ -77,10 +121,26 @@ void DescriptorSetManager::update_descriptor_sets(TextureManager& texture_mgr) {
         return;
     }
 
-    m_texture_timestamp = texture_timestamp;
+    //  Copy slots that changed since the last update
+    std::vector<Texture> changed;
+    m_texture_timestamp = texture_mgr.get_changed_textures(
+        m_texture_timestamp,
+        changed
+    );
 
-    texture_mgr.get_textures(m_textures);
+    for (const Texture& texture : changed) {
+        if (texture.id >= m_textures.size()) {
+            m_textures.resize(texture.id + 1);
+            m_slot_timestamps.resize(texture.id + 1, 0);
+        }
 
-    log_debug("Texture descriptor sets require update.");
+        m_textures[texture.id] = texture;
+        m_slot_timestamps[texture.id] = m_texture_timestamp;
+    }
+
+    log_debug(
+        "Texture descriptor sets require update (%zu slots).",
+        changed.size()
+    );
 }
 }
@@ -145,7 +145,8 @@ bool create_logical_device(
     const std::vector<const char*>& device_extensions,
     VkDevice& device,
     VkQueue& graphics_queue,
-    VkQueue& present_queue
+    VkQueue& present_queue,
+    DeviceFeatures& enabled_features
 ) {
     QueueFamilyIndices indices = find_queue_families(physical_device, surface);
 
@@ -186,6 +187,20 @@ bool create_logical_device(
     device_features.features.samplerAnisotropy = VK_TRUE;
     device_features.pNext = &features_12;
 
+    //  Enable optional features used for indirect drawing and compressed
+    //  textures when supported
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+
+    enabled_features = {};
+    enabled_features.multi_draw_indirect = supported_features.multiDrawIndirect;
+    enabled_features.draw_indirect_first_instance = supported_features.drawIndirectFirstInstance;
+    enabled_features.texture_compression_bc = supported_features.textureCompressionBC;
+
+    device_features.features.multiDrawIndirect = supported_features.multiDrawIndirect;
+    device_features.features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+    device_features.features.textureCompressionBC = supported_features.textureCompressionBC;
+
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     create_info.queueCreateInfoCount = 1;
@@ -1,13 +1,15 @@
 #include "render_vk/command_buffer.hpp"
 #include "render_vk/depth.hpp"
+#include "render_vk/image.hpp"
 #include "render_vk/vulkan.hpp"
 #include "render_vk/vulkan_queue.hpp"
+#include <stdexcept>
 
 namespace render_vk
 {
 //  ----------------------------------------------------------------------------
 void create_image(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
     VkDevice device,
     uint32_t width,
     uint32_t height,
@@ -18,7 +20,7 @@ void create_image(
     VkImageUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkImage& image,
-    VkDeviceMemory& image_memory
+    MemoryAllocation& allocation
 ) {
     VkImageCreateInfo image_info{};
     image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -43,20 +45,168 @@ void create_image(
     VkMemoryRequirements mem_requirements;
     vkGetImageMemoryRequirements(device, image, &mem_requirements);
 
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_requirements.size;
-    alloc_info.memoryTypeIndex = find_memory_type(
-        physical_device,
-        mem_requirements.memoryTypeBits,
-        properties
+    //  Optimal tiling images are kept apart from buffers
+    allocator.allocate(
+        mem_requirements,
+        properties,
+        tiling == VK_IMAGE_TILING_OPTIMAL,
+        AllocationStrategy::FreeList,
+        allocation
     );
 
-    if (vkAllocateMemory(device, &alloc_info, nullptr, &image_memory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate image memory!");
+    vkBindImageMemory(device, image, allocation.memory, allocation.offset);
+}
+
+//  ----------------------------------------------------------------------------
+VkDeviceSize get_image_level_size(
+    VkFormat format,
+    uint32_t width,
+    uint32_t height
+) {
+    const VkDeviceSize pixel_count = VkDeviceSize(width) * height;
+    const VkDeviceSize block_count =
+        VkDeviceSize((width + 3) / 4) * ((height + 3) / 4);
+
+    switch (format) {
+        default:
+            throw std::runtime_error("Image format size not implemented.");
+        case VK_FORMAT_R8_UNORM:
+            return pixel_count;
+        case VK_FORMAT_R8G8_UNORM:
+            return pixel_count * 2;
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_R8G8B8A8_UNORM:
+            return pixel_count * 4;
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            return block_count * 8;
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            return block_count * 16;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void destroy_image(
+    MemoryAllocator& allocator,
+    VkDevice device,
+    VkImage& image,
+    MemoryAllocation& allocation
+) {
+    vkDestroyImage(device, image, nullptr);
+    image = VK_NULL_HANDLE;
+
+    allocator.free(allocation);
+    allocation = {};
+}
+
+//  ----------------------------------------------------------------------------
+void record_generate_mipmaps_commands(
+    VkCommandBuffer command_buffer,
+    VkImage image,
+    int32_t texture_width,
+    int32_t texture_height,
+    uint32_t mipmap_levels
+) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.levelCount = 1;
+
+    int32_t mipmap_width = texture_width;
+    int32_t mipmap_height = texture_height;
+
+    for (uint32_t n = 1; n < mipmap_levels; ++n) {
+        barrier.subresourceRange.baseMipLevel = n -1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            command_buffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &barrier
+        );
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = { 0, 0, 0 };
+        blit.srcOffsets[1] = { mipmap_width, mipmap_height, 1 };
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = n - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = { 0, 0, 0 };
+        blit.dstOffsets[1] = { mipmap_width > 1 ? mipmap_width / 2 : 1, mipmap_height > 1 ? mipmap_height / 2 : 1, 1 };
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = n;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(command_buffer,
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1,
+            &blit,
+            VK_FILTER_LINEAR
+        );
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            command_buffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &barrier
+        );
+
+        if (mipmap_width > 1) {
+            mipmap_width /= 2;
+        }
+        if (mipmap_height > 1) {
+            mipmap_height /= 2;
+        }
     }
 
-    vkBindImageMemory(device, image, image_memory, 0);
+    barrier.subresourceRange.baseMipLevel = mipmap_levels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &barrier
+    );
 }
 
 //  ----------------------------------------------------------------------------
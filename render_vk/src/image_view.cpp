@@ -9,7 +9,8 @@ VkImageView create_image_view(
     VkImage image,
     VkFormat format,
     uint32_t mip_levels,
-    VkImageAspectFlags aspect_flags
+    VkImageAspectFlags aspect_flags,
+    const VkComponentMapping& components
 ) {
     VkImageViewCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -18,10 +19,8 @@ VkImageView create_image_view(
     create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
     create_info.format = format;
 
-    create_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-    create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-    create_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-    create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    //  Zero initialized components are VK_COMPONENT_SWIZZLE_IDENTITY
+    create_info.components = components;
 
     create_info.subresourceRange.aspectMask = aspect_flags;
     create_info.subresourceRange.baseMipLevel = 0;
@@ -1,62 +1,34 @@
 #include "render_vk/buffer.hpp"
+#include "render_vk/index_buffer.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan.hpp"
-#include "render_vk/vulkan_queue.hpp"
 #include <cstdint>
-#include <cstring>
 #include <vector>
 
 namespace render_vk
 {
 //  ----------------------------------------------------------------------------
-void create_index_buffer(
-    VkPhysicalDevice physical_device,
+UploadTicket create_index_buffer(
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
     VkDevice device,
-    VulkanQueue& transfer_queue,
-    VkCommandPool command_pool,
     const std::vector<uint32_t>& indices,
     VkBuffer& index_buffer,
-    VkDeviceMemory& index_buffer_memory
+    MemoryAllocation& index_buffer_allocation
 ) {
-    //  Create vertex buffer
+    //  Create index buffer
     VkDeviceSize buffer_size = sizeof(uint32_t) * indices.size();
 
-    VkBuffer staging_buffer;
-    VkDeviceMemory staging_buffer_memory;
-
-    create_buffer(
-        physical_device,
-        device,
-        buffer_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        staging_buffer,
-        staging_buffer_memory
-    );
-
-    void* data;
-    vkMapMemory(device, staging_buffer_memory, 0, buffer_size, 0, &data);
-    memcpy(data, indices.data(), (size_t)buffer_size);
-    vkUnmapMemory(device, staging_buffer_memory);
-
     create_buffer(
-        physical_device,
+        allocator,
         device,
         buffer_size,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         index_buffer,
-        index_buffer_memory
-    );
-
-    transfer_queue.copy_buffer(
-        command_pool,
-        staging_buffer,
-        index_buffer,
-        buffer_size
+        index_buffer_allocation
     );
 
-    //  Free staging buffer
-    vkDestroyBuffer(device, staging_buffer, nullptr);
-    vkFreeMemory(device, staging_buffer_memory, nullptr);
+    return upload_mgr.upload_buffer(index_buffer, indices.data(), buffer_size);
 }
 }
@@ -0,0 +1,406 @@
+#include "common/log.hpp"
+#include "render_vk/memory_allocator.hpp"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+using namespace common;
+
+namespace render_vk
+{
+//  ----------------------------------------------------------------------------
+static VkDeviceSize align_up(const VkDeviceSize value, const VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+//  ----------------------------------------------------------------------------
+//  First fit from the block's free ranges
+static bool allocate_free_list(
+    MemoryBlock& block,
+    const VkMemoryRequirements& requirements,
+    VkDeviceSize& offset
+) {
+    auto& ranges = block.free_ranges;
+    for (auto it = ranges.begin(); it != ranges.end(); ++it) {
+        const VkDeviceSize aligned = align_up(it->offset, requirements.alignment);
+        const VkDeviceSize range_end = it->offset + it->size;
+        if (aligned + requirements.size > range_end) {
+            continue;
+        }
+
+        offset = aligned;
+
+        //  Keep the padding before and the space after the allocation free
+        const MemoryBlock::Range before {it->offset, aligned - it->offset};
+        const MemoryBlock::Range after {
+            aligned + requirements.size,
+            range_end - aligned - requirements.size
+        };
+
+        it = ranges.erase(it);
+        if (after.size > 0) {
+            it = ranges.insert(it, after);
+        }
+        if (before.size > 0) {
+            ranges.insert(it, before);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+//  ----------------------------------------------------------------------------
+static bool allocate_linear(
+    MemoryBlock& block,
+    const VkMemoryRequirements& requirements,
+    VkDeviceSize& offset
+) {
+    const VkDeviceSize aligned = align_up(block.head, requirements.alignment);
+    if (aligned + requirements.size > block.size) {
+        return false;
+    }
+
+    offset = aligned;
+    block.head = aligned + requirements.size;
+    return true;
+}
+
+//  ----------------------------------------------------------------------------
+//  Returns a range to the block's free ranges, merging it with its neighbors
+static void free_range(MemoryBlock& block, const MemoryBlock::Range range) {
+    auto& ranges = block.free_ranges;
+    auto next = std::lower_bound(
+        ranges.begin(),
+        ranges.end(),
+        range.offset,
+        [](const MemoryBlock::Range& r, const VkDeviceSize offset) {
+            return r.offset < offset;
+        }
+    );
+
+    auto it = ranges.insert(next, range);
+
+    //  Merge with next range
+    auto after = it + 1;
+    if (after != ranges.end() && it->offset + it->size == after->offset) {
+        it->size += after->size;
+        ranges.erase(after);
+    }
+
+    //  Merge with previous range
+    if (it != ranges.begin()) {
+        auto before = it - 1;
+        if (before->offset + before->size == it->offset) {
+            before->size += it->size;
+            ranges.erase(it);
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+MemoryAllocator::MemoryAllocator(
+    VkPhysicalDevice physical_device,
+    VkDevice device,
+    const VkDeviceSize block_size
+)
+: m_physical_device(physical_device),
+  m_device(device),
+  m_block_size(block_size) {
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &m_memory_properties);
+}
+
+//  ----------------------------------------------------------------------------
+MemoryAllocator::~MemoryAllocator() {
+    log_stats();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& block : m_blocks) {
+        destroy_block(*block);
+    }
+    m_blocks.clear();
+}
+
+//  ----------------------------------------------------------------------------
+void MemoryAllocator::allocate(
+    const VkMemoryRequirements& requirements,
+    const VkMemoryPropertyFlags properties,
+    const bool images,
+    const AllocationStrategy strategy,
+    MemoryAllocation& allocation
+) {
+    const uint32_t memory_type = find_memory_type(
+        requirements.memoryTypeBits,
+        properties
+    );
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const VkDeviceSize block_size = get_block_size(memory_type);
+    if (requirements.size > block_size / 2) {
+        allocate_dedicated(requirements, memory_type, allocation);
+        return;
+    }
+
+    //  Existing blocks first, then a new block
+    MemoryBlock* block = nullptr;
+    VkDeviceSize offset = 0;
+    for (auto& b : m_blocks) {
+        if (b->memory_type != memory_type ||
+            b->strategy != strategy ||
+            b->images != images
+        ) {
+            continue;
+        }
+
+        const bool allocated = strategy == AllocationStrategy::Linear ?
+            allocate_linear(*b, requirements, offset) :
+            allocate_free_list(*b, requirements, offset);
+
+        if (allocated) {
+            block = b.get();
+            break;
+        }
+    }
+
+    if (block == nullptr) {
+        block = create_block(memory_type, strategy, images, block_size);
+
+        const bool allocated = strategy == AllocationStrategy::Linear ?
+            allocate_linear(*block, requirements, offset) :
+            allocate_free_list(*block, requirements, offset);
+
+        assert(allocated);
+    }
+
+    ++block->allocation_count;
+    block->used += requirements.size;
+
+    allocation.memory = block->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped = block->mapped != nullptr ? block->mapped + offset : nullptr;
+    allocation.block = block;
+}
+
+//  ----------------------------------------------------------------------------
+void MemoryAllocator::allocate_dedicated(
+    const VkMemoryRequirements& requirements,
+    const uint32_t memory_type,
+    MemoryAllocation& allocation
+) {
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = requirements.size;
+    alloc_info.memoryTypeIndex = memory_type;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(m_device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate dedicated device memory.");
+    }
+
+    void* mapped = nullptr;
+    const VkMemoryPropertyFlags flags =
+        m_memory_properties.memoryTypes[memory_type].propertyFlags;
+    if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        vkMapMemory(m_device, memory, 0, requirements.size, 0, &mapped);
+    }
+
+    ++m_dedicated_count;
+    m_dedicated_bytes += requirements.size;
+
+    allocation.memory = memory;
+    allocation.offset = 0;
+    allocation.size = requirements.size;
+    allocation.mapped = mapped;
+    allocation.block = nullptr;
+}
+
+//  ----------------------------------------------------------------------------
+MemoryBlock* MemoryAllocator::create_block(
+    const uint32_t memory_type,
+    const AllocationStrategy strategy,
+    const bool images,
+    const VkDeviceSize size
+) {
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = size;
+    alloc_info.memoryTypeIndex = memory_type;
+
+    auto block = std::make_unique<MemoryBlock>();
+    if (vkAllocateMemory(m_device, &alloc_info, nullptr, &block->memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate device memory block.");
+    }
+
+    //  Host visible blocks stay mapped until destroyed
+    const VkMemoryPropertyFlags flags =
+        m_memory_properties.memoryTypes[memory_type].propertyFlags;
+    if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void* mapped = nullptr;
+        vkMapMemory(m_device, block->memory, 0, size, 0, &mapped);
+        block->mapped = static_cast<char*>(mapped);
+    }
+
+    block->size = size;
+    block->memory_type = memory_type;
+    block->strategy = strategy;
+    block->images = images;
+    if (strategy == AllocationStrategy::FreeList) {
+        block->free_ranges.push_back({0, size});
+    }
+
+    log_debug(
+        "Allocated %llu byte device memory block (type %u).",
+        static_cast<unsigned long long>(size),
+        memory_type
+    );
+
+    m_blocks.push_back(std::move(block));
+    return m_blocks.back().get();
+}
+
+//  ----------------------------------------------------------------------------
+void MemoryAllocator::destroy_block(MemoryBlock& block) {
+    if (block.allocation_count > 0) {
+        log_error(
+            "Device memory block destroyed with %u live allocations.",
+            block.allocation_count
+        );
+    }
+
+    //  Freeing memory implicitly unmaps it
+    vkFreeMemory(m_device, block.memory, nullptr);
+    block.memory = VK_NULL_HANDLE;
+    block.mapped = nullptr;
+}
+
+//  ----------------------------------------------------------------------------
+uint32_t MemoryAllocator::find_memory_type(
+    const uint32_t type_bits,
+    const VkMemoryPropertyFlags properties
+) const {
+    for (uint32_t n = 0; n < m_memory_properties.memoryTypeCount; ++n) {
+        if ((type_bits & (1u << n)) &&
+            (m_memory_properties.memoryTypes[n].propertyFlags & properties) == properties
+        ) {
+            return n;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type.");
+}
+
+//  ----------------------------------------------------------------------------
+void MemoryAllocator::free(const MemoryAllocation& allocation) {
+    if (allocation.memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (allocation.block == nullptr) {
+        vkFreeMemory(m_device, allocation.memory, nullptr);
+        --m_dedicated_count;
+        m_dedicated_bytes -= allocation.size;
+        return;
+    }
+
+    MemoryBlock& block = *allocation.block;
+    assert(block.allocation_count > 0);
+    --block.allocation_count;
+    block.used -= allocation.size;
+
+    if (block.strategy == AllocationStrategy::FreeList) {
+        free_range(block, {allocation.offset, allocation.size});
+    } else if (block.allocation_count == 0) {
+        block.head = 0;
+    }
+
+    if (block.allocation_count > 0) {
+        return;
+    }
+
+    //  Keep one empty block per pool
+    for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+        MemoryBlock& other = **it;
+        if (&other != &block &&
+            other.allocation_count == 0 &&
+            other.memory_type == block.memory_type &&
+            other.strategy == block.strategy &&
+            other.images == block.images
+        ) {
+            destroy_block(other);
+            m_blocks.erase(it);
+            break;
+        }
+    }
+}
+
+//  ----------------------------------------------------------------------------
+VkDeviceSize MemoryAllocator::get_block_size(const uint32_t memory_type) const {
+    //  Small heaps (e.g. host visible device local memory) get smaller blocks
+    const uint32_t heap_index = m_memory_properties.memoryTypes[memory_type].heapIndex;
+    const VkDeviceSize heap_size = m_memory_properties.memoryHeaps[heap_index].size;
+    return std::min(m_block_size, heap_size / 8);
+}
+
+//  ----------------------------------------------------------------------------
+MemoryStats MemoryAllocator::get_stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    MemoryStats stats;
+    stats.block_count = static_cast<uint32_t>(m_blocks.size());
+    stats.dedicated_count = m_dedicated_count;
+    stats.allocation_count = m_dedicated_count;
+    stats.dedicated_bytes = m_dedicated_bytes;
+
+    for (const auto& block : m_blocks) {
+        stats.allocation_count += block->allocation_count;
+        stats.block_bytes += block->size;
+        stats.used_bytes += block->used;
+
+        if (block->strategy == AllocationStrategy::FreeList) {
+            stats.free_range_count += static_cast<uint32_t>(block->free_ranges.size());
+            for (const MemoryBlock::Range& range : block->free_ranges) {
+                stats.largest_free_range = std::max(stats.largest_free_range, range.size);
+            }
+        }
+    }
+
+    return stats;
+}
+
+//  ----------------------------------------------------------------------------
+void MemoryAllocator::log_stats() const {
+    const MemoryStats stats = get_stats();
+    log_debug(
+        "Device memory: %u allocations, %u blocks (%llu of %llu bytes used), "
+        "%u dedicated (%llu bytes), %u free ranges (largest %llu bytes).",
+        stats.allocation_count,
+        stats.block_count,
+        static_cast<unsigned long long>(stats.used_bytes),
+        static_cast<unsigned long long>(stats.block_bytes),
+        stats.dedicated_count,
+        static_cast<unsigned long long>(stats.dedicated_bytes),
+        stats.free_range_count,
+        static_cast<unsigned long long>(stats.largest_free_range)
+    );
+}
+
+//  ----------------------------------------------------------------------------
+void MemoryAllocator::trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_blocks.begin();
+    while (it != m_blocks.end()) {
+        if ((*it)->allocation_count == 0) {
+            destroy_block(**it);
+            it = m_blocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+}
@@ -1,6 +1,7 @@
 #include "assets/asset_id.hpp"
 #include "render_vk/mesh.hpp"
 #include "render_vk/model_manager.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan_model.hpp"
 #include <map>
 #include <memory>
@@ -32,10 +33,9 @@ const VulkanModel& ModelManager::get_glyph_quad() const {
 
 //  ----------------------------------------------------------------------------
 void ModelManager::initialize(
-    VkPhysicalDevice physical_device,
-    VkDevice device,
-    VulkanQueue& graphics_queue,
-    VkCommandPool command_pool
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
+    VkDevice device
 ) {
     //  Billboard quad
     Mesh billboard_mesh;
@@ -69,10 +69,9 @@ void ModelManager::initialize(
     m_billboard_quad = std::make_unique<VulkanModel>(0);
 
     m_billboard_quad->load(
-        physical_device,
+        allocator,
+        upload_mgr,
         device,
-        graphics_queue,
-        command_pool,
         billboard_mesh
     );
 
@@ -110,10 +109,9 @@ void ModelManager::initialize(
     m_sprite_quad = std::make_unique<VulkanModel>(0);
 
     m_sprite_quad->load(
-        physical_device,
+        allocator,
+        upload_mgr,
         device,
-        graphics_queue,
-        command_pool,
         sprite_mesh
     );
 
@@ -149,32 +147,32 @@ void ModelManager::initialize(
     m_glyph_quad = std::make_unique<VulkanModel>(0);
 
     m_glyph_quad->load(
-        physical_device,
+        allocator,
+        upload_mgr,
         device,
-        graphics_queue,
-        command_pool,
         glyph_mesh
     );
+
+    //  Quads are used directly rather than through update_models()
+    upload_mgr.wait(m_glyph_quad->get_upload());
 }
 
 //  ----------------------------------------------------------------------------
 void ModelManager::load_model(
     const AssetId id,
     const std::string& path,
-    VkPhysicalDevice physical_device,
-    VkDevice device,
-    VulkanQueue& graphics_queue,
-    VkCommandPool command_pool
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
+    VkDevice device
 ) {
     Mesh mesh;
     load_mesh(mesh, path);
 
     auto model = std::make_unique<VulkanModel>(id);
     model->load(
-        physical_device,
+        allocator,
+        upload_mgr,
         device,
-        graphics_queue,
-        command_pool,
         mesh
     );
 
@@ -213,13 +211,19 @@ bool ModelManager::model_exists(const AssetId id) const {
 }
 
 //  ----------------------------------------------------------------------------
-void ModelManager::update_models() {
+void ModelManager::update_models(const UploadManager& upload_mgr) {
     std::lock_guard<std::mutex> lock(m_models_mutex);
 
-    for (auto& model : m_added) {
-        m_models[model->get_id()] = std::move(model);
+    //  Add models whose upload has completed
+    auto itr = m_added.begin();
+    while (itr != m_added.end()) {
+        if (upload_mgr.is_complete((*itr)->get_upload())) {
+            m_models[(*itr)->get_id()] = std::move(*itr);
+            itr = m_added.erase(itr);
+        } else {
+            ++itr;
+        }
     }
-    m_added.clear();
 }
 
 //  ----------------------------------------------------------------------------
@@ -18,6 +18,8 @@
 #include "render_vk/texture_manager.hpp"
 #include "render_vk/vulkan_queue.hpp"
 #include "render_vk/vulkan_swapchain.hpp"
+#include <algorithm>
+#include <exception>
 
 using namespace assets;
 using namespace common;
@@ -40,44 +42,76 @@ namespace render_vk
 
 //  ----------------------------------------------------------------------------
 inline void filter_pending_textures(
-    const std::vector<SpriteBatch>& batches,
-    const TextureManager& texture_mgr,
-    std::vector<SpriteBatch>& job_batches
+    std::vector<SpriteBatch>& batches,
+    const TextureManager& texture_mgr
 ) {
-    for (const SpriteBatch& batch : batches) {
-        if (texture_mgr.texture_exists(batch.texture_id)) {
-            job_batches.push_back(batch);
-        }
-    }
+    batches.erase(
+        std::remove_if(
+            batches.begin(),
+            batches.end(),
+            [&texture_mgr](const SpriteBatch& batch) {
+                return !texture_mgr.texture_exists(batch.texture_id);
+            }
+        ),
+        batches.end()
+    );
 }
 
 //  ----------------------------------------------------------------------------
 inline void filter_pending_textures(
-    const std::vector<SpineSpriteBatch>& batches,
-    const TextureManager& texture_mgr,
-    std::vector<SpineSpriteBatch>& job_batches
+    std::vector<SpineSpriteBatch>& batches,
+    const TextureManager& texture_mgr
 ) {
-    for (const SpineSpriteBatch& batch : batches) {
-        if (texture_mgr.texture_exists(batch.texture_id)) {
-            job_batches.push_back(batch);
-        }
-    }
+    batches.erase(
+        std::remove_if(
+            batches.begin(),
+            batches.end(),
+            [&texture_mgr](const SpineSpriteBatch& batch) {
+                return !texture_mgr.texture_exists(batch.texture_id);
+            }
+        ),
+        batches.end()
+    );
 }
 
 //  ----------------------------------------------------------------------------
 inline void filter_pending_textures(
-    const std::vector<ModelBatch>& batches,
+    std::vector<ModelBatch>& batches,
     const ModelManager& model_mgr,
-    const TextureManager& texture_mgr,
-    std::vector<ModelBatch>& job_batches
+    const TextureManager& texture_mgr
 ) {
-    for (const ModelBatch& batch : batches) {
-        if (model_mgr.model_exists(batch.model_id) &&
-            texture_mgr.texture_exists(batch.texture_id)
-        ) {
-            job_batches.push_back(batch);
-        }
+    batches.erase(
+        std::remove_if(
+            batches.begin(),
+            batches.end(),
+            [&model_mgr, &texture_mgr](const ModelBatch& batch) {
+                return
+                    !model_mgr.model_exists(batch.model_id) ||
+                    !texture_mgr.texture_exists(batch.texture_id);
+            }
+        ),
+        batches.end()
+    );
+}
+
+//  ----------------------------------------------------------------------------
+//  Keeps the batches until the end of the frame and hands the caller cleared
+//  batches from an earlier frame in their place
+template <typename Batch>
+static const std::vector<Batch>* keep_batches(
+    std::vector<Batch>& batches,
+    std::deque<std::vector<Batch>>& frame_batches,
+    std::vector<std::vector<Batch>>& free_batches
+) {
+    frame_batches.push_back(std::move(batches));
+
+    batches.clear();
+    if (!free_batches.empty()) {
+        batches = std::move(free_batches.back());
+        free_batches.pop_back();
     }
+
+    return &frame_batches.back();
 }
 
 //  ----------------------------------------------------------------------------
@@ -144,12 +178,14 @@ void update_frame_descriptor_sets(
 void update_glyph_descriptor_sets(
     VkDevice device,
     VkBuffer object_uniform_buffer,
+    const size_t range,
     VkDescriptorSet& descriptor_set
 ) {
+    //  Range must be fixed so it fits after any dynamic offset
     VkDescriptorBufferInfo object_buffer_info{};
     object_buffer_info.buffer = object_uniform_buffer;
     object_buffer_info.offset = 0;
-    object_buffer_info.range = VK_WHOLE_SIZE;
+    object_buffer_info.range = range;
 
     std::array<VkWriteDescriptorSet, 1> descriptor_writes{};
 
@@ -177,12 +213,14 @@ void update_glyph_descriptor_sets(
 void update_spine_descriptor_sets(
     VkDevice device,
     VkBuffer object_uniform_buffer,
+    const size_t range,
     VkDescriptorSet& descriptor_set
 ) {
+    //  Range must be fixed so it fits after any dynamic offset
     VkDescriptorBufferInfo object_buffer_info{};
     object_buffer_info.buffer = object_uniform_buffer;
     object_buffer_info.offset = 0;
-    object_buffer_info.range = VK_WHOLE_SIZE;
+    object_buffer_info.range = range;
 
     std::array<VkWriteDescriptorSet, 1> descriptor_writes{};
 
@@ -347,12 +385,14 @@ static void create_descriptor_objects(
     update_glyph_descriptor_sets(
         device,
         uniform_buffers.glyph.get_buffer(),
+        uniform_buffers.glyph.get_range(),
         descriptor.glyph_set
     );
 
     update_spine_descriptor_sets(
         device,
         uniform_buffers.spine.get_buffer(),
+        uniform_buffers.spine.get_range(),
         descriptor.spine_set
     );
 
@@ -391,14 +431,24 @@ const char* RenderTaskManager::task_id_to_string(TaskId task_id) {
     switch (task_id) {
         default:
             return "?";
+        case TaskId::None:
+            return "none";
         case TaskId::DrawBillboards:
             return "draw_billboards";
+        case TaskId::DrawGlyphMesh:
+            return "draw_glyph_mesh";
+        case TaskId::DrawGlyphs:
+            return "draw_glyphs";
         case TaskId::DrawModels:
             return "draw_models";
+        case TaskId::DrawSpines:
+            return "draw_spines";
         case TaskId::DrawSprites:
             return "draw_sprites";
         case TaskId::UpdateFrameUniforms:
             return "update_frame_uniforms";
+        case TaskId::UpdateGlyphUniforms:
+            return "update_glyph_uniforms";
         case TaskId::UpdateObjectUniforms:
             return "update_object_uniforms";
     }
@@ -414,6 +464,7 @@ bool RenderTaskManager::task_requires_textures(TaskId task_id) {
         case TaskId::DrawGlyphMesh:
         case TaskId::DrawGlyphs:
         case TaskId::DrawModels:
+        case TaskId::DrawSpines:
         case TaskId::DrawSprites:
             return true;
 
@@ -428,10 +479,12 @@ bool RenderTaskManager::task_requires_textures(TaskId task_id) {
 RenderTaskManager::RenderTaskManager(
     VkPhysicalDevice physical_device,
     VkDevice device,
+    MemoryAllocator& allocator,
     DescriptorSetLayouts& descriptor_set_layouts,
     DescriptorSetManager& descriptor_set_mgr,
     ModelManager& model_mgr,
     TextureManager& texture_mgr,
+    ThreadPool& thread_pool,
     uint8_t frame_count,
     uint32_t max_objects
 )
@@ -439,6 +492,10 @@ RenderTaskManager::RenderTaskManager(
   m_max_objects(max_objects),
   m_physical_device(physical_device),
   m_device(device),
+  m_thread_pool(thread_pool),
+  m_jobs(thread_pool),
+  m_job_queue(MAX_QUEUED_JOBS),
+  m_allocator(allocator),
   m_descriptor_set_layouts(descriptor_set_layouts),
   m_descriptor_set_mgr(descriptor_set_mgr),
   m_model_mgr(model_mgr),
@@ -449,10 +506,25 @@ RenderTaskManager::RenderTaskManager(
 
     //  Create uniform buffers for each frame
     for (auto& uniform_buffers : m_uniform_buffers) {
-        uniform_buffers.frame.create(m_physical_device, m_device);
-        uniform_buffers.glyph.create(m_physical_device, m_device, m_max_objects);
-        uniform_buffers.object.create(m_physical_device, m_device, m_max_objects);
-        uniform_buffers.spine.create(m_physical_device, m_device, m_max_objects);
+        uniform_buffers.frame.create(m_allocator, m_device);
+        uniform_buffers.glyph.create(
+            m_physical_device,
+            m_allocator,
+            m_device,
+            m_max_objects,
+            sizeof(GlyphUbo) * MAX_GLYPHS
+        );
+        uniform_buffers.object.create(m_physical_device, m_allocator, m_device, m_max_objects);
+        uniform_buffers.spine.create(m_physical_device, m_allocator, m_device, m_max_objects);
+        uniform_buffers.billboard_instances.create(m_allocator, m_device, m_max_objects);
+        uniform_buffers.model_instances.create(m_allocator, m_device, m_max_objects);
+        uniform_buffers.sprite_instances.create(m_allocator, m_device, m_max_objects);
+        uniform_buffers.model_commands.create(
+            m_allocator,
+            m_device,
+            m_max_objects,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+        );
     }
 }
 
@@ -462,7 +534,7 @@ RenderTaskManager::~RenderTaskManager() {
 }
 
 //  ----------------------------------------------------------------------------
-void RenderTaskManager::add_job(Job& job) {
+void RenderTaskManager::add_job(Job&& job) {
     //  Can't enqueue jobs if frame was discarded.
     if (m_discard_frame) {
         return;
@@ -476,7 +548,25 @@ void RenderTaskManager::add_job(Job& job) {
     //  Track task call
     job.order = m_tasks.add_call(job.task_id);
 
-    m_jobs.push(job);
+    //  Job is kept alive until the end of the frame
+    m_frame_data.jobs.push_back(std::move(job));
+    const Job* queued_job = &m_frame_data.jobs.back();
+
+    //  Each pool task claims whichever queued job is next, so jobs the main
+    //  thread has already processed are not run twice.
+    if (m_job_queue.try_push(queued_job)) {
+        m_jobs.run(
+            [this]() {
+                run_next_job();
+            }
+        );
+    } else {
+        m_jobs.run(
+            [this, queued_job]() {
+                run_job(*queued_job);
+            }
+        );
+    }
 }
 
 //  ----------------------------------------------------------------------------
@@ -490,6 +580,17 @@ void RenderTaskManager::begin_frame(
     m_discard_frame = discard_frame;
     m_tasks.clear();
 
+    //  The frame's fence has been waited on so its instances and UBO's can be
+    //  reused
+    FrameUniformObjects& uniform_buffers = m_uniform_buffers.at(m_current_frame);
+    uniform_buffers.glyph.reset();
+    uniform_buffers.object.reset();
+    uniform_buffers.spine.reset();
+    uniform_buffers.billboard_instances.reset();
+    uniform_buffers.model_instances.reset();
+    uniform_buffers.sprite_instances.reset();
+    uniform_buffers.model_commands.reset();
+
     static bool first_call = true;
     if (first_call) {
         first_call = false;
@@ -499,52 +600,61 @@ void RenderTaskManager::begin_frame(
 
 //  ----------------------------------------------------------------------------
 void RenderTaskManager::cancel_threads() {
-    m_jobs.cancel();
-    for (std::thread& thread : m_threads) {
-        thread.join();
-    }
-    m_threads.clear();
-    m_jobs.resume();
-}
+    m_canceled = true;
+    m_jobs.wait();
+    m_canceled = false;
 
-//  ----------------------------------------------------------------------------
-bool RenderTaskManager::check_tasks_complete() {
-    if (m_discard_frame) {
-        return false;
+    //  Discard jobs the pool tasks skipped
+    const Job* job = nullptr;
+    while (m_job_queue.try_pop(job)) {
     }
 
-    if (m_tasks.is_complete()) {
-        //  Worker threads have completed all tasks for this frame
-        return true;
+    m_frame_data.clear();
+
+    //  Release frame objects
+    for (WorkerState& worker : m_workers) {
+        for (ThreadFrame& frame : worker.frames) {
+            //  Command pool
+            vkDestroyCommandPool(m_device, frame.command.pool, nullptr);
+            //  Descriptors
+            vkDestroyDescriptorPool(m_device, frame.descriptor.pool, nullptr);
+        }
+
+        log_debug("Released render objects for %s.", worker.name.c_str());
     }
 
-    //  Worker threads are still processing tasks for this frame
-    return false;
+    m_workers.clear();
 }
 
 //  ----------------------------------------------------------------------------
 void RenderTaskManager::draw_billboards(
     BillboardRenderer& renderer,
-    const std::vector<SpriteBatch>& batches
+    std::vector<SpriteBatch>& batches
 ) {
     if (batches.empty()) {
         // log_debug("Discarded draw billboards call with zero batches.");
         return;
     }
 
-    Job job{};
-    job.task_id = TaskId::DrawBillboards;
-    job.renderer = &renderer;
-    job.sprite_batches.reserve(batches.size());
+    //  Remove batches with pending assets
+    filter_pending_textures(batches, m_texture_mgr);
 
-    filter_pending_textures(batches, m_texture_mgr, job.sprite_batches);
-
-    if (job.sprite_batches.empty()) {
+    if (batches.empty()) {
         // log_debug("Discarded draw billboards call with zero batches.");
         return;
     }
 
-    add_job(job);
+    Job job{};
+    job.task_id = TaskId::DrawBillboards;
+    job.renderer = &renderer;
+
+    job.sprite_batches = keep_batches(
+        batches,
+        m_frame_data.sprite_batches,
+        m_frame_data.free_sprite_batches
+    );
+
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
@@ -562,7 +672,7 @@ void RenderTaskManager::draw_glyph_mesh(
     job.renderer = &renderer;
     job.asset_id = glyph_mesh_id;
 
-    add_job(job);
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
@@ -587,42 +697,66 @@ void RenderTaskManager::draw_glyphs(
     Job job{};
     job.task_id = TaskId::DrawGlyphs;
     job.renderer = &renderer;
-    job.instance_count = glyph_batch.get_instance_count();
+    job.instance_count = std::min(
+        static_cast<uint32_t>(glyph_batch.get_instance_count()),
+        MAX_GLYPHS
+    );
+
+    //  Reserve the UBO array here so the update and draw jobs agree on it
+    auto& glyph_uniform_buffer = m_uniform_buffers[m_current_frame].glyph;
+    if (!glyph_uniform_buffer.allocate_array(job.instance_count, job.uniform_offset)) {
+        log_debug("Discarded draw glyphs call: glyph uniform buffer is full.");
+        return;
+    }
 
-    update_glyph_uniforms(std::move(glyph_batch));
+    update_glyph_uniforms(std::move(glyph_batch), job.uniform_offset, job.instance_count);
 
-    add_job(job);
+    //  Hand back a batch from an earlier frame so its capacity is reused
+    glyph_batch.clear();
+    auto& free_glyph_batches = m_frame_data.free_glyph_batches;
+    if (!free_glyph_batches.empty()) {
+        glyph_batch = std::move(free_glyph_batches.back());
+        free_glyph_batches.pop_back();
+    }
+
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
 void RenderTaskManager::draw_models(
     ModelRenderer& renderer,
-    const std::vector<ModelBatch>& batches
+    std::vector<ModelBatch>& batches
 ) {
     if (batches.empty()) {
         // log_debug("Discarded draw models call with zero batches.");
         return;
     }
 
-    Job job{};
-    job.task_id = TaskId::DrawModels;
-    job.renderer = &renderer;
-    job.batches.reserve(batches.size());
-
-    filter_pending_textures(batches, m_model_mgr, m_texture_mgr, job.batches);
+    //  Remove batches with pending assets
+    filter_pending_textures(batches, m_model_mgr, m_texture_mgr);
 
-    if (job.batches.empty()) {
+    if (batches.empty()) {
         // log_debug("Discarded draw models call with zero batches.");
         return;
     }
 
-    add_job(job);
+    Job job{};
+    job.task_id = TaskId::DrawModels;
+    job.renderer = &renderer;
+
+    job.batches = keep_batches(
+        batches,
+        m_frame_data.model_batches,
+        m_frame_data.free_model_batches
+    );
+
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
 void RenderTaskManager::draw_spines(
     SpineSpriteRenderer& renderer,
-    const std::vector<SpineSpriteBatch>& batches
+    std::vector<SpineSpriteBatch>& batches
 ) {
     //  Ignore empty batches. Batches with pending assets will have already been
     //  discarded.
@@ -631,50 +765,65 @@ void RenderTaskManager::draw_spines(
         return;
     }
 
-    Job job{};
-    job.task_id = TaskId::DrawSpines;
-    job.renderer = &renderer;
-    job.spine_batches.reserve(batches.size());
-
-    filter_pending_textures(batches, m_texture_mgr, job.spine_batches);
+    //  Remove batches with pending assets
+    filter_pending_textures(batches, m_texture_mgr);
 
-    if (job.spine_batches.empty()) {
+    if (batches.empty()) {
         // log_debug("Discarded draw Spine sprites call with zero batches.");
         return;
     }
 
-    add_job(job);
+    Job job{};
+    job.task_id = TaskId::DrawSpines;
+    job.renderer = &renderer;
+
+    job.spine_batches = keep_batches(
+        batches,
+        m_frame_data.spine_batches,
+        m_frame_data.free_spine_batches
+    );
+
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
 void RenderTaskManager::draw_sprites(
     SpriteRenderer& renderer,
-    const std::vector<SpriteBatch>& batches
+    std::vector<SpriteBatch>& batches
 ) {
     if (batches.empty()) {
         // log_debug("Discarded draw sprites call with zero batches.");
         return;
     }
 
-    Job job{};
-    job.task_id = TaskId::DrawSprites;
-    job.renderer = &renderer;
-    job.sprite_batches.reserve(batches.size());
-
-    filter_pending_textures(batches, m_texture_mgr, job.sprite_batches);
+    //  Remove batches with pending assets
+    filter_pending_textures(batches, m_texture_mgr);
 
-    if (job.sprite_batches.empty()) {
+    if (batches.empty()) {
         // log_debug("Discarded draw sprites call with zero batches.");
         return;
     }
 
-    add_job(job);
+    Job job{};
+    job.task_id = TaskId::DrawSprites;
+    job.renderer = &renderer;
+
+    job.sprite_batches = keep_batches(
+        batches,
+        m_frame_data.sprite_batches,
+        m_frame_data.free_sprite_batches
+    );
+
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
 void RenderTaskManager::end_frame() {
     m_discard_frame = false;
     m_tasks.clear();
+
+    //  All jobs have completed by now
+    m_frame_data.clear();
 }
 
 //  ----------------------------------------------------------------------------
@@ -694,268 +843,305 @@ void RenderTaskManager::post_results(
 }
 
 //  ----------------------------------------------------------------------------
-void RenderTaskManager::start_threads() {
-    assert(m_thread_count > 0);
-    for (auto n = 0; n < m_thread_count; ++n) {
-        m_threads.emplace_back(&RenderTaskManager::thread_main, this, n);
+void RenderTaskManager::record_job(const Job& job) {
+    //  The main thread uses the last worker state
+    size_t worker_index = m_thread_pool.get_worker_index();
+    if (worker_index == ThreadPool::NOT_WORKER) {
+        worker_index = m_workers.size() - 1;
     }
-}
 
-//  ----------------------------------------------------------------------------
-void RenderTaskManager::thread_main(uint8_t thread_id) {
-    Stopwatch stopwatch;
+    assert(worker_index < m_workers.size());
+    WorkerState& worker = m_workers[worker_index];
 
-    log_debug("Render thread %d started (%p).", thread_id, std::this_thread::get_id());
+    //  Check if frame changed or if this worker is working multiple
+    //  times this frame.
+    bool frame_changed = false;
+    if (worker.last_frame != m_cumulative_frame) {
+        worker.last_frame = m_cumulative_frame;
+        frame_changed = true;
+    }
+
+    // log_debug(
+    //     "%s: acquired %s (frame: %d)",
+    //     worker.name.c_str(),
+    //     task_id_to_string(job.task_id),
+    //     m_current_frame
+    // );
 
-    const std::string thread_name = "thread" + std::to_string(thread_id);
+    //  Get data for current frame
+    ThreadFrame& frame = worker.frames.at(m_current_frame);
 
-    //  Initialize frame command objects
-    uint32_t frame_index = 0;
-    std::vector<ThreadFrame> frames(m_frame_count);
-    for (ThreadFrame& frame : frames) {
-        frame.name = thread_name + "_frame" + std::to_string(frame_index);
+    //  Check if frame has changed or if worker is continuing to process
+    //  tasks during the same frame.
+    if (frame_changed) {
+        frame.command_buffer_index = 0;
 
-        create_secondary_command_objects(
+        //  Reset command buffers
+        vkResetCommandPool(
             m_device,
-            m_physical_device,
-            frame.name,
-            frame.command
+            frame.command.pool,
+            VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT
         );
+    } else {
+        ++frame.command_buffer_index;
+    }
 
-        create_descriptor_objects(
+    //  Create more command buffers if needed
+    while (frame.command_buffer_index >= frame.command.buffers.size()) {
+        VkCommandBuffer command_buffer;
+        create_secondary_command_buffer(
             m_device,
-            m_descriptor_set_layouts,
-            m_uniform_buffers[frame_index],
-            frame.name,
-            frame.descriptor
+            frame.command.pool,
+            command_buffer,
+            (frame.name+"_command_buffer"+std::to_string(frame.command.buffers.size())).c_str()
         );
-
-        ++frame_index;
+        frame.command.buffers.push_back(command_buffer);
     }
 
-    bool frame_changed = false;
-    uint32_t last_frame =  UINT32_MAX;
-
-    //  Main loop
-    while (true) {
-        // log_debug(
-        //     "%s: waiting (frame %d)",
-        //     thread_name.c_str(),
-        //     m_current_frame
-        // );
-
-        //  Wait for a job to process
-        Job job{};
-        if (!m_jobs.wait_and_pop(job)) {
-            break;
-        }
+    //  Update texture descriptors on the first task that requires them this frame.
+    //  Textures are loaded on separate threads but new textures are not available
+    //  until the start of a frame. Descriptors only need to be loaded to match
+    //  textures changed since the start of the frame, as textures pending after
+    //  the start of the frame will be removed from draw batches.
+    if (task_requires_textures(job.task_id)) {
+        //  After this task completes, the texture descriptors will be bound
+        //  and cannot change again this frame.
+        //  Texture timestamp should only change at the start of frames.
+        //  Only slots changed since this frame's set was last written are
+        //  copied.
+        const auto texture_timestamp = m_descriptor_set_mgr.get_texture_timestamp();
+        if (frame.texture_timestamp != texture_timestamp) {
+            log_debug(
+                "%s: updating texture descriptor sets (frame: %d, timestamp: %d -> %d).",
+                worker.name.c_str(),
+                m_current_frame,
+                frame.texture_timestamp,
+                texture_timestamp
+            );
 
-        //  Check if frame changed or if this thread is working multiple
-        //  times this frame.
-        //  Note that the frame this thread starts waiting for a job on is
-        //  likely not the frame it will acquire and process a job on.
-        if (last_frame != m_cumulative_frame) {
-            last_frame = m_cumulative_frame;
-            frame_changed = true;
+            m_descriptor_set_mgr.copy_texture_descriptor_set(
+                frame.descriptor.texture_set,
+                frame.texture_timestamp
+            );
         }
+    }
 
-        // log_debug(
-        //     "%s: acquired %s (frame: %d)",
-        //     thread_name.c_str(),
-        //     task_id_to_string(job.task_id),
-        //     m_current_frame
-        // );
+    assert(frame.command_buffer_index < frame.command.buffers.size());
 
-        //  Get data for current frame
-        ThreadFrame& frame = frames.at(m_current_frame);
+    //  Get command buffer to use
+    VkCommandBuffer command_buffer = frame.command.buffers.at(frame.command_buffer_index);
 
-        //  Check if frame has changed or if thread is continuing to process
-        //  tasks during the same frame.
-        if (frame_changed) {
-            frame_changed = false;
-            frame.command_buffer_index = 0;
+    // log_debug(
+    //     "%s:  execute %s",
+    //     worker.name.c_str(),
+    //     task_id_to_string(job.task_id)
+    // );
 
-            //  Reset command buffers
-            vkResetCommandPool(
-                m_device,
-                frame.command.pool,
-                VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT
+    //  Process job
+    switch (job.task_id) {
+        case TaskId::DrawBillboards: {
+            worker.stopwatch.start(worker.name+"_draw_billboards");
+            BillboardRenderer* billboard_renderer = static_cast<BillboardRenderer*>(job.renderer);
+            billboard_renderer->draw_billboards(
+                *job.sprite_batches,
+                frame.descriptor,
+                m_uniform_buffers[m_current_frame].billboard_instances,
+                command_buffer
             );
-        } else {
-            ++frame.command_buffer_index;
+            worker.stopwatch.stop(worker.name+"_draw_billboards");
+            break;
         }
 
-        //  Create more command buffers if needed
-        while (frame.command_buffer_index >= frame.command.buffers.size()) {
-            VkCommandBuffer command_buffer;
-            create_secondary_command_buffer(
-                m_device,
-                frame.command.pool,
-                command_buffer,
-                (frame.name+"_command_buffer"+std::to_string(frame.command.buffers.size())).c_str()
+        case TaskId::DrawGlyphMesh: {
+            worker.stopwatch.start(worker.name+"_draw_glyph_mesh");
+            GlyphRenderer* glyph_renderer = static_cast<GlyphRenderer*>(job.renderer);
+            glyph_renderer->draw_glyph_mesh(
+                job.asset_id,
+                frame.descriptor,
+                m_uniform_buffers[m_current_frame],
+                command_buffer
             );
-            frame.command.buffers.push_back(command_buffer);
+            worker.stopwatch.stop(worker.name+"_draw_glyph_mesh");
+            break;
         }
 
-        //  Update texture descriptors on the first task that requires them this frame.
-        //  Textures are loaded on separate threads but new textures are not available
-        //  until the start of a frame. Descriptors only need to be loaded to match
-        //  textures changed since the start of the frame, as textures pending after
-        //  the start of the frame will be removed from draw batches.
-        if (task_requires_textures(job.task_id)) {
-            //  After this task completes, the texture descriptors will be bound
-            //  and cannot change again this frame.
-            //  Texture timestamp should only change at the start of frames.
-            const auto texture_timestamp = m_texture_mgr.get_timestamp();
-            if (frame.texture_timestamp != texture_timestamp) {
-                log_debug(
-                    "%s: updating texture descriptor sets (frame: %d, timestamp: %d -> %d).",
-                    thread_name.c_str(),
-                    m_current_frame,
-                    frame.texture_timestamp,
-                    texture_timestamp
-                );
-
-                m_descriptor_set_mgr.copy_texture_descriptor_set(frame.descriptor.texture_set);
-
-                frame.texture_timestamp = texture_timestamp;
-            }
+        case TaskId::DrawGlyphs: {
+            worker.stopwatch.start(worker.name+"_draw_glyphs");
+            GlyphRenderer* glyph_renderer = static_cast<GlyphRenderer*>(job.renderer);
+            glyph_renderer->draw_glyphs(
+                job.instance_count,
+                job.uniform_offset,
+                frame.descriptor,
+                m_uniform_buffers[m_current_frame],
+                command_buffer
+            );
+            worker.stopwatch.stop(worker.name+"_draw_glyphs");
+            break;
         }
 
-        assert(frame.command_buffer_index < frame.command.buffers.size());
-
-        //  Get command buffer to use
-        VkCommandBuffer command_buffer = frame.command.buffers.at(frame.command_buffer_index);
-
-        // log_debug(
-        //     "%s:  execute %s",
-        //     thread_name.c_str(),
-        //     task_id_to_string(job.task_id)
-        // );
-
-        //  Process job
-        switch (job.task_id) {
-            case TaskId::DrawBillboards: {
-                stopwatch.start(thread_name+"_draw_billboards");
-                BillboardRenderer* billboard_renderer = static_cast<BillboardRenderer*>(job.renderer);
-                billboard_renderer->draw_billboards(
-                    job.sprite_batches,
-                    frame.descriptor,
-                    command_buffer
-                );
-                stopwatch.stop(thread_name+"_draw_billboards");
-                break;
-            }
+        case TaskId::DrawModels: {
+            worker.stopwatch.start(worker.name+"_draw_models");
+            ModelRenderer* model_renderer = static_cast<ModelRenderer*>(job.renderer);
+            model_renderer->draw_models(
+                *job.batches,
+                frame.descriptor,
+                m_uniform_buffers[m_current_frame].model_instances,
+                m_uniform_buffers[m_current_frame].model_commands,
+                command_buffer
+            );
+            worker.stopwatch.stop(worker.name+"_draw_models");
+            break;
+        }
 
-            case TaskId::DrawGlyphMesh: {
-                stopwatch.start(thread_name+"_draw_glyph_mesh");
-                GlyphRenderer* glyph_renderer = static_cast<GlyphRenderer*>(job.renderer);
-                glyph_renderer->draw_glyph_mesh(
-                    job.asset_id,
-                    frame.descriptor,
-                    m_uniform_buffers[m_current_frame],
-                    command_buffer
-                );
-                stopwatch.stop(thread_name+"_draw_glyph_mesh");
-                break;
-            }
+        case TaskId::DrawSprites: {
+            worker.stopwatch.start(worker.name+"_draw_sprites");
+            SpriteRenderer* sprite_renderer = static_cast<SpriteRenderer*>(job.renderer);
+            sprite_renderer->draw_sprites(
+                *job.sprite_batches,
+                frame.descriptor,
+                m_uniform_buffers[m_current_frame].sprite_instances,
+                command_buffer
+            );
+            worker.stopwatch.stop(worker.name+"_draw_sprites");
+            break;
+        }
 
-            case TaskId::DrawGlyphs: {
-                stopwatch.start(thread_name+"_draw_glyphs");
-                GlyphRenderer* glyph_renderer = static_cast<GlyphRenderer*>(job.renderer);
-                glyph_renderer->draw_glyphs(
-                    job.instance_count,
-                    frame.descriptor,
-                    m_uniform_buffers[m_current_frame],
-                    command_buffer
-                );
-                stopwatch.stop(thread_name+"_draw_glyphs");
-                break;
-            }
+        case TaskId::DrawSpines: {
+            worker.stopwatch.start(worker.name+"_draw_spines");
+            SpineSpriteRenderer* spine_renderer = static_cast<SpineSpriteRenderer*>(job.renderer);
+            auto& spine_uniform_buffer = m_uniform_buffers[m_current_frame].spine;
+            uint32_t uniform_offset = 0;
+            const bool uniforms_updated = spine_renderer->update_object_uniforms(
+                *job.spine_batches,
+                spine_uniform_buffer,
+                uniform_offset
+            );
+            //  Nothing is drawn if the uniform buffer is full
+            const std::vector<SpineSpriteBatch> no_batches;
+            spine_renderer->draw_sprites(
+                uniforms_updated ? *job.spine_batches : no_batches,
+                frame.descriptor,
+                spine_uniform_buffer,
+                uniform_offset,
+                command_buffer
+            );
+            worker.stopwatch.stop(worker.name+"_draw_spines");
+            break;
+        }
 
-            case TaskId::DrawModels: {
-                stopwatch.start(thread_name+"_draw_models");
-                ModelRenderer* model_renderer = static_cast<ModelRenderer*>(job.renderer);
-                model_renderer->draw_models(
-                    job.batches,
-                    frame.descriptor,
-                    command_buffer
-                );
-                stopwatch.stop(thread_name+"_draw_models");
-                break;
-            }
+        case TaskId::UpdateFrameUniforms: {
+            worker.stopwatch.start(worker.name+"_update_frame_uniforms");
+            auto& frame_uniform_buffer = m_uniform_buffers[m_current_frame].frame;
+            task_update_frame_uniforms(job.frame_ubo, frame_uniform_buffer);
+            worker.stopwatch.stop(worker.name+"_update_frame_uniforms");
+            break;
+        }
 
-            case TaskId::DrawSprites: {
-                stopwatch.start(thread_name+"_draw_sprites");
-                SpriteRenderer* sprite_renderer = static_cast<SpriteRenderer*>(job.renderer);
-                sprite_renderer->draw_sprites(
-                    job.sprite_batches,
-                    frame.descriptor,
-                    command_buffer
-                );
-                stopwatch.stop(thread_name+"_draw_sprites");
-                break;
-            }
+        case TaskId::UpdateGlyphUniforms: {
+            worker.stopwatch.start(worker.name+"_update_glyph_uniforms");
+            auto& glyph_uniform_buffer = m_uniform_buffers[m_current_frame].glyph;
+            task_update_glyph_uniforms(
+                *job.glyph_batch,
+                glyph_uniform_buffer,
+                job.uniform_offset,
+                job.instance_count
+            );
+            worker.stopwatch.stop(worker.name+"_update_glyph_uniforms");
+            break;
+        }
 
-            case TaskId::DrawSpines: {
-                stopwatch.start(thread_name+"_draw_spines");
-                SpineSpriteRenderer* spine_renderer = static_cast<SpineSpriteRenderer*>(job.renderer);
-                auto& spine_uniform_buffer = m_uniform_buffers[m_current_frame].spine;
-                spine_renderer->update_object_uniforms(job.spine_batches, spine_uniform_buffer);
-                spine_renderer->draw_sprites(
-                    job.spine_batches,
-                    frame.descriptor,
-                    spine_uniform_buffer,
-                    command_buffer
-                );
-                stopwatch.stop(thread_name+"_draw_spines");
-                break;
-            }
+        case TaskId::UpdateObjectUniforms: {
+            worker.stopwatch.start(worker.name+"_update_object_uniforms");
+            auto& object_uniform_buffer = m_uniform_buffers[m_current_frame].object;
+            task_update_object_uniforms(*job.batches, object_uniform_buffer);
+            worker.stopwatch.stop(worker.name+"_update_object_uniforms");
+            break;
+        }
+    }
 
-            case TaskId::UpdateFrameUniforms: {
-                stopwatch.start(thread_name+"_update_frame_uniforms");
-                auto& frame_uniform_buffer = m_uniform_buffers[m_current_frame].frame;
-                task_update_frame_uniforms(job.frame_ubo, frame_uniform_buffer);
-                stopwatch.stop(thread_name+"_update_frame_uniforms");
-                break;
-            }
+    // log_debug(
+    //     "%s: finished %s",
+    //     worker.name.c_str(),
+    //     task_id_to_string(job.task_id)
+    // );
 
-            case TaskId::UpdateGlyphUniforms: {
-                stopwatch.start(thread_name+"_update_glyph_uniforms");
-                auto& glyph_uniform_buffer = m_uniform_buffers[m_current_frame].glyph;
-                task_update_glyph_uniforms(job.glyph_batch, glyph_uniform_buffer);
-                stopwatch.stop(thread_name+"_update_glyph_uniforms");
-                break;
-            }
+    //  Post completed work
+    post_results(job.task_id, job.order, command_buffer);
+}
 
-            case TaskId::UpdateObjectUniforms: {
-                stopwatch.start(thread_name+"_update_object_uniforms");
-                auto& object_uniform_buffer = m_uniform_buffers[m_current_frame].object;
-                task_update_object_uniforms(job.batches, object_uniform_buffer);
-                stopwatch.stop(thread_name+"_update_object_uniforms");
-                break;
+//  ----------------------------------------------------------------------------
+void RenderTaskManager::run_job(const Job& job) {
+    if (m_canceled) {
+        return;
+    }
+
+    try {
+        record_job(job);
+    } catch (...) {
+        //  Kept for wait_for_tasks to rethrow on the main thread
+        {
+            std::lock_guard<std::mutex> lock(m_exception_mutex);
+            if (!m_exception) {
+                m_exception = std::current_exception();
             }
         }
 
-        // log_debug(
-        //     "%s: finished %s",
-        //     thread_name.c_str(),
-        //     task_id_to_string(job.task_id)
-        // );
+        //  Post an empty result so waiting for the frame completes
+        post_results(job.task_id, job.order, VK_NULL_HANDLE);
+    }
+}
 
-        //  Post completed work
-        post_results(job.task_id, job.order, command_buffer);
+//  ----------------------------------------------------------------------------
+bool RenderTaskManager::run_next_job() {
+    const Job* job = nullptr;
+    if (!m_job_queue.try_pop(job)) {
+        return false;
     }
 
-    //  Release frame objects
-    for (ThreadFrame& frame : frames) {
-        //  Command pool
-        vkDestroyCommandPool(m_device, frame.command.pool, nullptr);
-        //  Descriptors
-        vkDestroyDescriptorPool(m_device, frame.descriptor.pool, nullptr);
+    run_job(*job);
+    return true;
+}
+
+//  ----------------------------------------------------------------------------
+void RenderTaskManager::start_threads() {
+    assert(m_workers.empty());
+
+    const size_t thread_count = m_thread_pool.get_thread_count();
+    if (thread_count == 0) {
+        throw std::runtime_error("Render tasks require thread pool workers.");
     }
 
-    log_debug("Thread %d exited.", thread_id);
+    //  One more for the main thread
+    m_workers.resize(thread_count + 1);
+
+    for (size_t n = 0; n < m_workers.size(); ++n) {
+        WorkerState& worker = m_workers[n];
+        worker.name = n < thread_count ? "thread" + std::to_string(n) : "main";
+
+        //  Initialize frame command objects
+        uint32_t frame_index = 0;
+        worker.frames.resize(m_frame_count);
+        for (ThreadFrame& frame : worker.frames) {
+            frame.name = worker.name + "_frame" + std::to_string(frame_index);
+
+            create_secondary_command_objects(
+                m_device,
+                m_physical_device,
+                frame.name,
+                frame.command
+            );
+
+            create_descriptor_objects(
+                m_device,
+                m_descriptor_set_layouts,
+                m_uniform_buffers[frame_index],
+                frame.name,
+                frame.descriptor
+            );
+
+            ++frame_index;
+        }
+    }
 }
 
 //  ----------------------------------------------------------------------------
@@ -966,6 +1152,10 @@ void RenderTaskManager::shutdown() {
         uniform_buffer.glyph.destroy();
         uniform_buffer.object.destroy();
         uniform_buffer.spine.destroy();
+        uniform_buffer.billboard_instances.destroy();
+        uniform_buffer.model_instances.destroy();
+        uniform_buffer.sprite_instances.destroy();
+        uniform_buffer.model_commands.destroy();
     }
 }
 
@@ -983,15 +1173,44 @@ void RenderTaskManager::update_frame_uniforms(
     job.frame_ubo.proj = proj;
     job.frame_ubo.ortho_view = ortho_view;
     job.frame_ubo.ortho_proj = ortho_proj;
-    add_job(job);
+    add_job(std::move(job));
 }
 
 //  ----------------------------------------------------------------------------
-void RenderTaskManager::update_glyph_uniforms(GlyphBatch&& glyph_batch) {
+void RenderTaskManager::update_glyph_uniforms(
+    GlyphBatch&& glyph_batch,
+    const uint32_t uniform_offset,
+    const uint32_t instance_count
+) {
     //  Update uniform data
+    m_frame_data.glyph_batches.push_back(std::move(glyph_batch));
+
     Job job{};
     job.task_id = TaskId::UpdateGlyphUniforms;
-    job.glyph_batch = std::move(glyph_batch);
-    add_job(job);
+    job.glyph_batch = &m_frame_data.glyph_batches.back();
+    job.uniform_offset = uniform_offset;
+    job.instance_count = instance_count;
+    add_job(std::move(job));
+}
+
+//  ----------------------------------------------------------------------------
+void RenderTaskManager::wait_for_tasks() {
+    //  Help with recording instead of sleeping
+    while (run_next_job()) {
+    }
+
+    //  Wait for jobs already claimed by workers. Failed jobs post empty
+    //  results, so this completes.
+    m_tasks.wait_complete();
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(m_exception_mutex);
+        std::swap(exception, m_exception);
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
 }
 }
@@ -7,6 +7,7 @@
 #include "render_vk/uniform_buffer.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 
+using namespace common;
 using namespace render;
 
 namespace render_vk
@@ -26,38 +27,39 @@ void task_update_frame_uniforms(
 //  ----------------------------------------------------------------------------
 void task_update_glyph_uniforms(
     const GlyphBatch& glyph_batch,
-    DynamicUniformBuffer<GlyphUbo>& glyph_uniform
+    DynamicUniformBuffer<GlyphUbo>& glyph_uniform,
+    const uint32_t offset,
+    const uint32_t instance_count
 ) {
-    size_t object_count = glyph_batch.get_instance_count();
-    assert(object_count > 0);
+    assert(instance_count > 0);
 
-    std::vector<GlyphUbo> data(object_count);
+    //  Write UBO structs straight to the allocated mapped memory
+    GlyphUbo* ubos = &glyph_uniform.at(offset);
 
     const auto& batches = glyph_batch.get_batches();
     const std::vector<GlyphBatch::Glyph>& glyphs = glyph_batch.get_glyphs();
 
-    size_t ubo_index = 0;
+    uint32_t ubo_index = 0;
     const glm::mat4 identity(1.0f);
     for (const auto& batch : batches) {
-        for (size_t n = batch.start; n < batch.end; ++n) {
+        for (size_t n = batch.start; n < batch.end && ubo_index < instance_count; ++n) {
             const GlyphBatch::Glyph& glyph = glyphs[n];
+            GlyphUbo& ubo = ubos[ubo_index];
 
-            data[ubo_index].texture_index = batch.texture_id;
+            ubo.texture_index = batch.texture_id;
 
-            data[ubo_index].model = glm::scale(
+            ubo.model = glm::scale(
                 glm::translate(identity, glyph.position),
                 glm::vec3(glyph.size, 1.0f)
             );
 
-            data[ubo_index].bg_color = glyph.bg_color;
-            data[ubo_index].fg_color = glyph.fg_color;
+            ubo.bg_color = glyph.bg_color;
+            ubo.fg_color = glyph.fg_color;
+            ubo.uv_rect = glyph.uv_rect;
 
             ++ubo_index;
         }
     }
-
-    //  Copy object UBO structs to dynamic uniform buffer
-    glyph_uniform.copy(data);
 }
 
 //  ----------------------------------------------------------------------------
@@ -65,31 +67,29 @@ void task_update_object_uniforms(
     const std::vector<ModelBatch>& batches,
     DynamicUniformBuffer<ObjectUbo>& object_uniform
 ) {
-    //   Build vectors for uniform buffers
-    std::vector<glm::vec3> positions;
-    std::vector<uint32_t> texture_ids;
+    uint32_t object_count = 0;
     for (const ModelBatch& batch : batches) {
-        positions.insert(
-            positions.end(),
-            batch.positions.begin(),
-            batch.positions.end()
-        );
-
-        texture_ids = std::vector<uint32_t>(positions.size(), batch.texture_id);
+        object_count += static_cast<uint32_t>(batch.positions.size());
     }
 
-    assert(positions.size() == texture_ids.size());
-
-    const size_t object_count = positions.size();
     assert(object_count > 0);
 
-    std::vector<ObjectUbo> data(object_count);
-    for (size_t n = 0; n < object_count; ++n)  {
-        data[n].texture_index = texture_ids[n];
-        data[n].model = glm::translate(glm::mat4(1.0f), positions[n]);
+    uint32_t offset = 0;
+    if (!object_uniform.allocate(object_count, offset)) {
+        log_debug("Object uniform buffer is full.");
+        return;
     }
 
-    //  Copy object UBO structs to dynamic uniform buffer
-    object_uniform.copy(data);
+    //  Write UBO structs straight to the allocated mapped memory
+    const uint32_t align = static_cast<uint32_t>(object_uniform.get_align());
+    const glm::mat4 identity(1.0f);
+    for (const ModelBatch& batch : batches) {
+        for (const glm::vec3& position : batch.positions) {
+            ObjectUbo& ubo = object_uniform.at(offset);
+            ubo.texture_index = batch.texture_id;
+            ubo.model = glm::translate(identity, position);
+            offset += align;
+        }
+    }
 }
 }
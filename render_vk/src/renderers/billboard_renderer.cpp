@@ -5,9 +5,10 @@
 #include "render_vk/model_manager.hpp"
 #include "render_vk/renderers/billboard_renderer.hpp"
 #include "render_vk/shader.hpp"
+#include "render_vk/sprite_instance.hpp"
 #include "render_vk/vertex.hpp"
 #include "render_vk/vulkan_model.hpp"
-#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <vector>
 
 using namespace render;
@@ -68,6 +69,7 @@ void BillboardRenderer::destroy_objects() {
 void BillboardRenderer::draw_billboards(
     const std::vector<SpriteBatch>& batches,
     const FrameDescriptorObjects& descriptors,
+    InstanceBuffer<SpriteInstance>& instances,
     VkCommandBuffer command_buffer
 ) {
     VkCommandBufferInheritanceInfo inherit_info{};
@@ -130,10 +132,38 @@ void BillboardRenderer::draw_billboards(
     //  Get sprite quad
     const VulkanModel& quad = m_model_mgr.get_billboard_quad();
 
-    //  Bind vertex buffer
-    VkBuffer vertex_buffers[] = { quad.get_vertex_buffer() };
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
+    //  Copy instance data to the frame's instance buffer
+    uint32_t instance_count = 0;
+    for (const SpriteBatch& batch : batches) {
+        instance_count += static_cast<uint32_t>(batch.positions.size());
+    }
+
+    uint32_t first_instance = 0;
+    SpriteInstance* instance = instances.allocate(instance_count, first_instance);
+
+    const glm::vec4 full_rect(0.0f, 0.0f, 1.0f, 1.0f);
+
+    uint32_t remaining = instance_count;
+    for (const SpriteBatch& batch : batches) {
+        const size_t count = std::min<size_t>(batch.positions.size(), remaining);
+        const bool has_uv_rects = !batch.uv_rects.empty();
+        for (size_t n = 0; n < count; ++n) {
+            instance->position = batch.positions[n];
+            instance->size = batch.sizes[n];
+            instance->texture_index = batch.texture_id;
+            instance->uv_rect = has_uv_rects ? batch.uv_rects[n] : full_rect;
+            ++instance;
+        }
+        remaining -= static_cast<uint32_t>(count);
+    }
+
+    //  Bind quad vertex buffer and instance buffer
+    VkBuffer vertex_buffers[] = {
+        quad.get_vertex_buffer(),
+        instances.get_buffer()
+    };
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(command_buffer, 0, 2, vertex_buffers, offsets);
 
     //  Bind index buffer
     vkCmdBindIndexBuffer(
@@ -143,45 +173,16 @@ void BillboardRenderer::draw_billboards(
         VK_INDEX_TYPE_UINT32
     );
 
-    const uint32_t index_count = quad.get_index_count();
-
-    //  Draw each batch
-    for (const SpriteBatch& batch : batches) {
-        //  Texture ID
-        vkCmdPushConstants(
+    //  Texture indices are per-instance, so every batch is drawn at once
+    if (instance_count > 0) {
+        vkCmdDrawIndexed(
             command_buffer,
-            m_pipeline_layout,
-            VK_SHADER_STAGE_FRAGMENT_BIT,
-            sizeof(glm::mat4),
-            sizeof(uint32_t),
-            &batch.texture_id
+            quad.get_index_count(),
+            instance_count,
+            0,
+            0,
+            first_instance
         );
-
-        //  Draw each object
-        for (uint32_t n = 0; n < batch.positions.size(); ++n) {
-            glm::mat4 model =
-                glm::translate(glm::mat4(1.0f), batch.positions[n]) *
-                glm::scale(glm::mat4(1.0f), batch.sizes[n]);
-
-            vkCmdPushConstants(
-                command_buffer,
-                m_pipeline_layout,
-                VK_SHADER_STAGE_VERTEX_BIT,
-                0,
-                sizeof(glm::mat4),
-                &model
-            );
-
-            //  Draw
-            vkCmdDrawIndexed(
-                command_buffer,
-                index_count,
-                1,
-                0,
-                0,
-                1
-            );
-        }
     }
 
     if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
@@ -225,15 +226,33 @@ static void create_billboard_pipeline(
         frag_shader_stage_info
     };
 
-    //  Vertex input
-    auto attrib_descs = Vertex::get_attribute_descriptions();
-    auto binding_desc = Vertex::get_binding_description();
+    //  Vertex input. Quad vertices are binding 0 and instances binding 1.
+    auto vertex_attrib_descs = Vertex::get_attribute_descriptions();
+    auto instance_attrib_descs = SpriteInstance::get_attribute_descriptions();
+
+    std::vector<VkVertexInputAttributeDescription> attrib_descs;
+    attrib_descs.insert(
+        attrib_descs.end(),
+        vertex_attrib_descs.begin(),
+        vertex_attrib_descs.end()
+    );
+    attrib_descs.insert(
+        attrib_descs.end(),
+        instance_attrib_descs.begin(),
+        instance_attrib_descs.end()
+    );
+
+    std::array<VkVertexInputBindingDescription, 2> binding_descs = {
+        Vertex::get_binding_description(),
+        SpriteInstance::get_binding_description(),
+    };
+
     VkPipelineVertexInputStateCreateInfo vertex_input_info{};
     vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrib_descs.size());
     vertex_input_info.pVertexAttributeDescriptions = attrib_descs.data();
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.pVertexBindingDescriptions = &binding_desc;
+    vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descs.size());
+    vertex_input_info.pVertexBindingDescriptions = binding_descs.data();
 
     //  Input assembly
     VkPipelineInputAssemblyStateCreateInfo input_assembly{};
@@ -335,23 +354,13 @@ static void create_billboard_pipeline(
         descriptor_set_layouts.texture_sampler,
     };
 
-    //  Push constants
-    std::array<VkPushConstantRange, 2> push_constant_range;
-    push_constant_range[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    push_constant_range[0].offset = 0;
-    push_constant_range[0].size = sizeof(glm::mat4);
-
-    push_constant_range[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    push_constant_range[1].offset = sizeof(glm::mat4);
-    push_constant_range[1].size = sizeof(uint32_t);
-
     //  Pipeline layout
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
     pipeline_layout_info.pSetLayouts = set_layouts.data();
-    pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_range.size());
-    pipeline_layout_info.pPushConstantRanges = push_constant_range.data();
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
 
     if (vkCreatePipelineLayout(
         device,
@@ -179,6 +179,7 @@ void GlyphRenderer::draw_glyph_mesh(
 //  ----------------------------------------------------------------------------
 void GlyphRenderer::draw_glyphs(
     const uint32_t instance_count,
+    const uint32_t uniform_offset,
     const FrameDescriptorObjects& descriptors,
     const FrameUniformObjects& uniform_buffers,
     VkCommandBuffer command_buffer
@@ -222,7 +223,7 @@ void GlyphRenderer::draw_glyphs(
         descriptors.texture_set,
         descriptors.glyph_set,
     };
-    std::array<uint32_t, 1> dynamic_offsets {0};
+    std::array<uint32_t, 1> dynamic_offsets {uniform_offset};
     vkCmdBindDescriptorSets(
         command_buffer,
         VK_PIPELINE_BIND_POINT_GRAPHICS,
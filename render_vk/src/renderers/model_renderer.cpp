@@ -8,6 +8,7 @@
 #include "render_vk/vertex.hpp"
 #include "render_vk/vulkan_model.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <vector>
 
 using namespace render;
@@ -36,10 +37,12 @@ void ModelRenderer::create_objects(
     const VulkanSwapchain& swapchain,
     VkRenderPass render_pass,
     const VkSampleCountFlagBits msaa_sample_count,
-    const DescriptorSetLayouts& descriptor_set_layouts
+    const DescriptorSetLayouts& descriptor_set_layouts,
+    const DeviceFeatures& device_features
 ) {
     m_device = device;
     m_render_pass = render_pass;
+    m_device_features = device_features;
 
     create_model_pipeline(
         device,
@@ -64,10 +67,67 @@ void ModelRenderer::destroy_objects() {
     m_device = VK_NULL_HANDLE;
 }
 
+//  ----------------------------------------------------------------------------
+void ModelRenderer::draw_indirect(
+    const InstanceBuffer<VkDrawIndexedIndirectCommand>& commands,
+    const VkDrawIndexedIndirectCommand* first_command,
+    uint32_t first_command_index,
+    uint32_t command_count,
+    VkCommandBuffer command_buffer
+) {
+    if (command_count == 0) {
+        return;
+    }
+
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+    //  Indirect commands must have a first instance of zero without this
+    //  feature, so record the commands directly instead.
+    if (!m_device_features.draw_indirect_first_instance) {
+        for (uint32_t n = 0; n < command_count; ++n) {
+            const VkDrawIndexedIndirectCommand& command = first_command[n];
+            vkCmdDrawIndexed(
+                command_buffer,
+                command.indexCount,
+                command.instanceCount,
+                command.firstIndex,
+                command.vertexOffset,
+                command.firstInstance
+            );
+        }
+        return;
+    }
+
+    const VkDeviceSize offset = static_cast<VkDeviceSize>(first_command_index) * stride;
+
+    if (m_device_features.multi_draw_indirect) {
+        vkCmdDrawIndexedIndirect(
+            command_buffer,
+            commands.get_buffer(),
+            offset,
+            command_count,
+            stride
+        );
+    } else {
+        //  Draw count is limited to one
+        for (uint32_t n = 0; n < command_count; ++n) {
+            vkCmdDrawIndexedIndirect(
+                command_buffer,
+                commands.get_buffer(),
+                offset + n * stride,
+                1,
+                stride
+            );
+        }
+    }
+}
+
 //  ----------------------------------------------------------------------------
 void ModelRenderer::draw_models(
     const std::vector<ModelBatch>& batches,
     const FrameDescriptorObjects& descriptors,
+    InstanceBuffer<ModelInstance>& instances,
+    InstanceBuffer<VkDrawIndexedIndirectCommand>& commands,
     VkCommandBuffer command_buffer
 ) {
     VkCommandBufferInheritanceInfo inherit_info{};
@@ -127,7 +187,47 @@ void ModelRenderer::draw_models(
         nullptr
     );
 
-    //  Keep track of model index because of dynamic buffer alignment
+    //  Count instances and draw commands. Models without submeshes are
+    //  drawn with a single command.
+    uint32_t instance_count = 0;
+    uint32_t command_count = 0;
+    for (const ModelBatch& batch : batches) {
+        const VulkanModel* model = m_model_mgr.get_model(batch.model_id);
+        if (model == nullptr) {
+            continue;
+        }
+
+        instance_count += static_cast<uint32_t>(batch.positions.size());
+        command_count += std::max<uint32_t>(
+            static_cast<uint32_t>(model->get_meshes().size()),
+            1
+        );
+    }
+
+    //  Allocate from the frame's buffers. Counts are reduced if full.
+    uint32_t first_instance = 0;
+    ModelInstance* instance = instances.allocate(instance_count, first_instance);
+
+    uint32_t first_command_index = 0;
+    VkDrawIndexedIndirectCommand* command = commands.allocate(
+        command_count,
+        first_command_index
+    );
+
+    //  Instances are bound once, models as they change
+    VkBuffer instance_buffers[] = { instances.get_buffer() };
+    VkDeviceSize instance_offsets[] = {0};
+    vkCmdBindVertexBuffers(command_buffer, 1, 1, instance_buffers, instance_offsets);
+
+    const VulkanModel* bound_model = nullptr;
+    const VkDrawIndexedIndirectCommand* group_command = command;
+    uint32_t group_index = first_command_index;
+    uint32_t group_count = 0;
+
+    uint32_t instance_index = first_instance;
+    uint32_t instances_left = instance_count;
+    uint32_t commands_left = command_count;
+
     for (const ModelBatch& batch : batches) {
         //  Get model
         VulkanModel* model = m_model_mgr.get_model(batch.model_id);
@@ -135,72 +235,75 @@ void ModelRenderer::draw_models(
             continue;
         }
 
-        //  Bind vertex buffer
-        VkBuffer vertex_buffers[] = { model->get_vertex_buffer() };
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-
-        //  Bind index buffer
-        vkCmdBindIndexBuffer(
-            command_buffer,
-            model->get_index_buffer(),
-            0,
-            VK_INDEX_TYPE_UINT32
+        const std::vector<ModelMesh>& meshes = model->get_meshes();
+        const uint32_t batch_instances = static_cast<uint32_t>(batch.positions.size());
+        const uint32_t batch_commands = std::max<uint32_t>(
+            static_cast<uint32_t>(meshes.size()),
+            1
         );
 
-        // const uint32_t dynamic_align = static_cast<uint32_t>(m_object_uniform.get_align());
-        const uint32_t index_count = model->get_index_count();
-
-        // vkCmdBindDescriptorSets(
-        //     command_buffer,
-        //     VK_PIPELINE_BIND_POINT_GRAPHICS,
-        //     m_pipeline_layout,
-        //     1,
-        //     1,
-        //     &descriptor.object_set,
-        //     1,
-        //     &dynamic_align
-        // );
-
-        //  Texture ID
-        vkCmdPushConstants(
-            command_buffer,
-            m_pipeline_layout,
-            VK_SHADER_STAGE_FRAGMENT_BIT,
-            sizeof(glm::mat4),
-            sizeof(uint32_t),
-            &batch.texture_id
-        );
+        //  Out of space this frame
+        if (batch_instances > instances_left || batch_commands > commands_left) {
+            break;
+        }
 
-        //  Draw each object
-        for (uint32_t n = 0; n < batch.positions.size(); ++n) {
-            //  One dynamic offset per dynamic descriptor to offset into the ubo
-            //  containing all model matrices
-            // const uint32_t dynamic_offset = n * dynamic_align;
+        //  Draw the previous model's commands before binding this model
+        if (model != bound_model) {
+            draw_indirect(commands, group_command, group_index, group_count, command_buffer);
+            group_command = command;
+            group_index += group_count;
+            group_count = 0;
 
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), batch.positions[n]);
+            //  Bind vertex buffer
+            VkBuffer vertex_buffers[] = { model->get_vertex_buffer() };
+            VkDeviceSize offsets[] = {0};
+            vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
 
-            vkCmdPushConstants(
+            //  Bind index buffer
+            vkCmdBindIndexBuffer(
                 command_buffer,
-                m_pipeline_layout,
-                VK_SHADER_STAGE_VERTEX_BIT,
+                model->get_index_buffer(),
                 0,
-                sizeof(glm::mat4),
-                &model
+                VK_INDEX_TYPE_UINT32
             );
 
-            //  Draw
-            vkCmdDrawIndexed(
-                command_buffer,
-                index_count,
-                1,
-                0,
-                0,
-                1
-            );
+            bound_model = model;
+        }
+
+        //  Instance transforms
+        for (const glm::vec3& position : batch.positions) {
+            instance->model = glm::translate(glm::mat4(1.0f), position);
+            instance->texture_index = batch.texture_id;
+            ++instance;
         }
+
+        //  One command per mesh
+        if (meshes.empty()) {
+            command->indexCount = model->get_index_count();
+            command->instanceCount = batch_instances;
+            command->firstIndex = 0;
+            command->vertexOffset = 0;
+            command->firstInstance = instance_index;
+            ++command;
+        } else {
+            for (const ModelMesh& mesh : meshes) {
+                command->indexCount = mesh.index_count;
+                command->instanceCount = batch_instances;
+                command->firstIndex = mesh.index_offset;
+                command->vertexOffset = static_cast<int32_t>(mesh.vertex_offset);
+                command->firstInstance = instance_index;
+                ++command;
+            }
+        }
+
+        instance_index += batch_instances;
+        instances_left -= batch_instances;
+        commands_left -= batch_commands;
+        group_count += batch_commands;
     }
 
+    draw_indirect(commands, group_command, group_index, group_count, command_buffer);
+
     if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to record secondary command buffer.");
     }
@@ -242,15 +345,33 @@ static void create_model_pipeline(
         frag_shader_stage_info
     };
 
-    //  Vertex input
-    auto attrib_descs = Vertex::get_attribute_descriptions();
-    auto binding_desc = Vertex::get_binding_description();
+    //  Vertex input. Model vertices are binding 0 and instances binding 1.
+    auto vertex_attrib_descs = Vertex::get_attribute_descriptions();
+    auto instance_attrib_descs = ModelInstance::get_attribute_descriptions();
+
+    std::vector<VkVertexInputAttributeDescription> attrib_descs;
+    attrib_descs.insert(
+        attrib_descs.end(),
+        vertex_attrib_descs.begin(),
+        vertex_attrib_descs.end()
+    );
+    attrib_descs.insert(
+        attrib_descs.end(),
+        instance_attrib_descs.begin(),
+        instance_attrib_descs.end()
+    );
+
+    std::array<VkVertexInputBindingDescription, 2> binding_descs = {
+        Vertex::get_binding_description(),
+        ModelInstance::get_binding_description(),
+    };
+
     VkPipelineVertexInputStateCreateInfo vertex_input_info{};
     vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrib_descs.size());
     vertex_input_info.pVertexAttributeDescriptions = attrib_descs.data();
-    vertex_input_info.vertexBindingDescriptionCount = 1;
-    vertex_input_info.pVertexBindingDescriptions = &binding_desc;
+    vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descs.size());
+    vertex_input_info.pVertexBindingDescriptions = binding_descs.data();
 
     //  Input assembly
     VkPipelineInputAssemblyStateCreateInfo input_assembly{};
@@ -363,23 +484,13 @@ static void create_model_pipeline(
         descriptor_set_layouts.texture_sampler,
     };
 
-    //  Push constants
-    std::array<VkPushConstantRange, 2> push_constant_range;
-    push_constant_range[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    push_constant_range[0].offset = 0;
-    push_constant_range[0].size = sizeof(glm::mat4);
-
-    push_constant_range[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    push_constant_range[1].offset = sizeof(glm::mat4);
-    push_constant_range[1].size = sizeof(uint32_t);
-
     //  Pipeline layout
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
     pipeline_layout_info.pSetLayouts = set_layouts.data();
-    pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_range.size());
-    pipeline_layout_info.pPushConstantRanges = push_constant_range.data();
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
 
     if (vkCreatePipelineLayout(
         device,
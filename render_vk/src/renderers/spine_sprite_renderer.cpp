@@ -97,6 +97,7 @@ void SpineSpriteRenderer::draw_sprites(
     const std::vector<SpineSpriteBatch>& batches,
     const FrameDescriptorObjects& descriptors,
     const DynamicUniformBuffer<SpineUbo>& uniform_buffer,
+    const uint32_t uniform_offset,
     VkCommandBuffer command_buffer
 ) {
     VkCommandBufferInheritanceInfo inherit_info{};
@@ -156,7 +157,11 @@ void SpineSpriteRenderer::draw_sprites(
         nullptr
     );
 
+    const uint32_t align = static_cast<uint32_t>(uniform_buffer.get_align());
+
     uint32_t dynamic_object = 0;
+    //  Index of the first UBO of the current instance
+    uint32_t instance_object = 0;
 
     for (const SpineSpriteBatch& batch : batches) {
         //  Get model
@@ -229,8 +234,9 @@ void SpineSpriteRenderer::draw_sprites(
 
                 const ModelMesh& mesh = model.get_meshes()[attachment_info.index];
 
+                //  UBO's are written in attachment order
                 const uint32_t dynamic_align =
-                    static_cast<uint32_t>(dynamic_object * uniform_buffer.get_align());
+                    uniform_offset + (instance_object + attachment_index) * align;
 
                 vkCmdBindDescriptorSets(
                     command_buffer,
@@ -257,6 +263,8 @@ void SpineSpriteRenderer::draw_sprites(
 
                 ++dynamic_object;
             }
+
+            instance_object += static_cast<uint32_t>(spine_model->attachment_infos.size());
         }
     }
 
@@ -270,9 +278,11 @@ void SpineSpriteRenderer::draw_sprites(
 //  ----------------------------------------------------------------------------
 void calculate_transform(
     SpineModel& model,
-    std::vector<SpineUbo>& ubos,
-    size_t& offset
+    DynamicUniformBuffer<SpineUbo>& spine_uniform,
+    uint32_t& offset
 ) {
+    const uint32_t align = static_cast<uint32_t>(spine_uniform.get_align());
+
     // auto skeleton_data = model.skeleton_data;
     // auto& skins = skeleton_data->getSkins();
     // const auto skin_count = skins.size();
@@ -296,39 +306,52 @@ void calculate_transform(
         transform[0][1] = bone.getC();
         transform[1][1] = bone.getD();
 
-        ubos[offset + n].transform = transform;
+        spine_uniform.at(offset + static_cast<uint32_t>(n) * align).transform = transform;
     }
 
-    offset += model.attachment_infos.size();
+    offset += static_cast<uint32_t>(model.attachment_infos.size()) * align;
 }
 
 //  ----------------------------------------------------------------------------
-void SpineSpriteRenderer::update_object_uniforms(
+bool SpineSpriteRenderer::update_object_uniforms(
     const std::vector<SpineSpriteBatch>& batches,
-    DynamicUniformBuffer<SpineUbo>& spine_uniform
+    DynamicUniformBuffer<SpineUbo>& spine_uniform,
+    uint32_t& uniform_offset
 ) {
-    //   Build vectors for uniform buffers
+    //  Batches whose model is still loading are skipped here and by
+    //  draw_sprites, so UBO offsets match
     size_t object_count = 0;
     for (const SpineSpriteBatch& batch : batches) {
-        SpineModel* model = m_spine_mgr.get_spine_model(batch.spine_id);
-        assert(model != nullptr);
-        object_count += (model->attachment_infos.size()) * batch.positions.size();
+        const SpineModel* model = m_spine_mgr.get_spine_model(batch.spine_id);
+        if (model != nullptr) {
+            object_count += (model->attachment_infos.size()) * batch.positions.size();
+        }
     }
-    assert(object_count > 0);
     assert(object_count < MAX_OBJECTS);
 
-    size_t offset = 0;
-    std::vector<SpineUbo> data(object_count);
+    if (object_count == 0) {
+        return false;
+    }
+
+    if (!spine_uniform.allocate(static_cast<uint32_t>(object_count), uniform_offset)) {
+        return false;
+    }
+
+    //  Write UBO structs straight to the allocated mapped memory, one per
+    //  attachment of each instance
+    uint32_t offset = uniform_offset;
     for (const SpineSpriteBatch& batch : batches) {
-        for (const auto& pos : batch.positions)  {
-            SpineModel* model = m_spine_mgr.get_spine_model(batch.spine_id);
-            assert(model != nullptr);
-            calculate_transform(*model, data, offset);
+        SpineModel* model = m_spine_mgr.get_spine_model(batch.spine_id);
+        if (model == nullptr) {
+            continue;
+        }
+
+        for (size_t n = 0; n < batch.positions.size(); ++n) {
+            calculate_transform(*model, spine_uniform, offset);
         }
     }
 
-    //  Copy object UBO structs to dynamic uniform buffer
-    spine_uniform.copy(data);
+    return true;
 }
 
 //  ----------------------------------------------------------------------------
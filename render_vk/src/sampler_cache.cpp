@@ -0,0 +1,126 @@
+#include "assets/texture_create_args.hpp"
+#include "common/log.hpp"
+#include "render_vk/debug_utils.hpp"
+#include "render_vk/sampler_cache.hpp"
+#include <stdexcept>
+#include <string>
+
+using namespace assets;
+using namespace common;
+
+namespace render_vk
+{
+//  ----------------------------------------------------------------------------
+static VkSamplerAddressMode texture_address_mode_to_vk(
+    const TextureAddressMode address_mode
+) {
+    switch (address_mode) {
+        default:
+            throw std::runtime_error("Not implemented.");
+        case TextureAddressMode::Clamp:
+            return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        case TextureAddressMode::Repeat:
+            return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+static VkFilter texture_filter_to_vk(const TextureFilter filter) {
+    switch (filter) {
+        default:
+            throw std::runtime_error("Not implemented.");
+        case TextureFilter::Linear:
+            return VK_FILTER_LINEAR;
+        case TextureFilter::Nearest:
+            return VK_FILTER_NEAREST;
+    }
+}
+
+//  ----------------------------------------------------------------------------
+static void create_texture_sampler(
+    VkDevice device,
+    VkSampler& texture_sampler,
+    VkSamplerAddressMode address_mode,
+    VkFilter mag_filter,
+    VkFilter min_filter
+) {
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = mag_filter;
+    sampler_info.minFilter = min_filter;
+
+    sampler_info.addressModeU = address_mode;
+    sampler_info.addressModeV = address_mode;
+    sampler_info.addressModeW = address_mode;
+
+    sampler_info.anisotropyEnable = VK_TRUE;
+    sampler_info.maxAnisotropy = 16.0f;
+
+    sampler_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    sampler_info.unnormalizedCoordinates = VK_FALSE;
+
+    sampler_info.compareEnable = VK_FALSE;
+    sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
+
+    //  Mip levels are limited by each texture's image view so the sampler
+    //  can be shared between textures with different mip counts
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.mipLodBias = 0.0f;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &texture_sampler) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create texture sampler.");
+    }
+}
+
+//  ----------------------------------------------------------------------------
+SamplerCache::SamplerCache(VkDevice device)
+: m_device(device) {
+}
+
+//  ----------------------------------------------------------------------------
+SamplerCache::~SamplerCache() {
+    destroy_samplers();
+}
+
+//  ----------------------------------------------------------------------------
+void SamplerCache::destroy_samplers() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& pair : m_samplers) {
+        vkDestroySampler(m_device, pair.second, nullptr);
+    }
+    m_samplers.clear();
+}
+
+//  ----------------------------------------------------------------------------
+VkSampler SamplerCache::get_sampler(const TextureCreateArgs& args) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Key key {args.address_mode, args.mag_filter, args.min_filter};
+
+    const auto find = m_samplers.find(key);
+    if (find != m_samplers.end()) {
+        return find->second;
+    }
+
+    VkSampler sampler {VK_NULL_HANDLE};
+    create_texture_sampler(
+        m_device,
+        sampler,
+        texture_address_mode_to_vk(args.address_mode),
+        texture_filter_to_vk(args.mag_filter),
+        texture_filter_to_vk(args.min_filter)
+    );
+
+    const std::string name = "texture_sampler" + std::to_string(m_samplers.size());
+    set_debug_name(m_device, VK_OBJECT_TYPE_SAMPLER, sampler, name.c_str());
+
+    m_samplers[key] = sampler;
+
+    log_debug("Created %s.", name.c_str());
+
+    return sampler;
+}
+}
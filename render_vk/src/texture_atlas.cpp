@@ -0,0 +1,93 @@
+#include "assets/atlas_packer.hpp"
+#include "common/log.hpp"
+#include "render_vk/texture.hpp"
+#include "render_vk/texture_atlas.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+using namespace assets;
+using namespace common;
+
+namespace render_vk
+{
+//  ----------------------------------------------------------------------------
+void build_texture_atlas(
+    const std::vector<std::string>& paths,
+    const uint32_t width,
+    const uint32_t height,
+    TextureAtlas& atlas
+) {
+    struct Image
+    {
+        uint32_t width {0};
+        uint32_t height {0};
+        std::vector<unsigned char> pixels;
+    };
+
+    std::vector<Image> images(paths.size());
+    for (size_t n = 0; n < paths.size(); ++n) {
+        Image& image = images[n];
+        load_png(paths[n], image.pixels, image.width, image.height);
+    }
+
+    //  Pack tallest images first
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&images](const size_t a, const size_t b) {
+            if (images[a].height != images[b].height) {
+                return images[a].height > images[b].height;
+            }
+            return images[a].width > images[b].width;
+        }
+    );
+
+    atlas.width = width;
+    atlas.height = height;
+    atlas.pixels.assign(size_t(width) * height * 4, 0);
+    atlas.uv_rects.resize(images.size());
+
+    //  Leave a gutter so linear filtering doesn't sample neighboring images
+    AtlasPacker packer(width, height, 1);
+
+    const float inv_width = 1.0f / width;
+    const float inv_height = 1.0f / height;
+
+    for (const size_t index : order) {
+        const Image& image = images[index];
+
+        AtlasRect rect {};
+        if (!packer.pack(image.width, image.height, rect)) {
+            log_error(
+                "Texture atlas %dx%d is full at '%s'.",
+                width,
+                height,
+                paths[index].c_str()
+            );
+
+            throw std::runtime_error("Failed to pack texture atlas.");
+        }
+
+        //  Copy rows into the page
+        const size_t row_size = size_t(image.width) * 4;
+        for (uint32_t y = 0; y < image.height; ++y) {
+            std::memcpy(
+                &atlas.pixels[((size_t(rect.y) + y) * width + rect.x) * 4],
+                &image.pixels[y * row_size],
+                row_size
+            );
+        }
+
+        atlas.uv_rects[index] = glm::vec4(
+            rect.x * inv_width,
+            rect.y * inv_height,
+            rect.width * inv_width,
+            rect.height * inv_height
+        );
+    }
+}
+}
@@ -1,8 +1,9 @@
 #include "assets/texture_create_args.hpp"
+#include "assets/texture_encoder.hpp"
 #include "common/log.hpp"
 #include "render_vk/texture_manager.hpp"
-#include "render_vk/vulkan_queue.hpp"
 #include <algorithm>
+#include <cassert>
 
 using namespace assets;
 using namespace common;
@@ -11,12 +12,18 @@ namespace render_vk
 {
 //  ----------------------------------------------------------------------------
 TextureManager::TextureManager(
-    VkPhysicalDevice physical_device,
-    VkDevice device
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
+    VkDevice device,
+    const DeviceFeatures& device_features
 )
-: m_physical_device(physical_device),
-  m_device(device) {
+: m_allocator(allocator),
+  m_upload_mgr(upload_mgr),
+  m_device(device),
+  m_device_features(device_features),
+  m_sampler_cache(device) {
     m_textures.resize(MAX_TEXTURES);
+    m_slot_timestamps.resize(MAX_TEXTURES, m_timestamp);
 }
 
 //  ----------------------------------------------------------------------------
@@ -25,40 +32,143 @@ void TextureManager::add_texture(const Texture& texture) {
     m_added.push_back(texture);
 }
 
+//  ----------------------------------------------------------------------------
+Texture TextureManager::create_texture(
+    const TextureId texture_id,
+    const std::string& name,
+    const uint32_t width,
+    const uint32_t height,
+    const std::vector<unsigned char>& image,
+    const TextureCreateArgs& args
+) {
+    Texture texture{};
+    render_vk::create_texture(
+        m_allocator,
+        m_upload_mgr,
+        m_sampler_cache,
+        m_device,
+        name,
+        width,
+        height,
+        image,
+        get_supported_args(args),
+        texture
+    );
+
+    texture.id = texture_id;
+
+    add_texture(texture);
+
+    log_debug("Created texture '%s' (%d).", name.c_str(), texture_id);
+
+    return texture;
+}
+
+//  ----------------------------------------------------------------------------
+Texture TextureManager::create_texture_from_levels(
+    const TextureId texture_id,
+    const std::string& name,
+    const uint32_t width,
+    const uint32_t height,
+    const uint32_t mip_levels,
+    const unsigned char* data,
+    const size_t size,
+    const TextureCreateArgs& args
+) {
+    Texture texture{};
+    render_vk::create_texture_from_levels(
+        m_allocator,
+        m_upload_mgr,
+        m_sampler_cache,
+        m_device,
+        name,
+        width,
+        height,
+        mip_levels,
+        data,
+        size,
+        args,
+        texture
+    );
+
+    texture.id = texture_id;
+
+    add_texture(texture);
+
+    return texture;
+}
+
 //  ----------------------------------------------------------------------------
 void TextureManager::destroy_textures() {
-    destroy_texture(m_device, m_empty_texture);
+    destroy_texture(m_allocator, m_device, m_empty_texture);
 
     for (Texture& texture : m_textures) {
         if (texture.image != m_empty_texture.image) {
-            destroy_texture(m_device, texture);
+            destroy_texture(m_allocator, m_device, texture);
         }
     }
     m_textures.clear();
+    m_slot_timestamps.clear();
 
     for (Texture& texture : m_added) {
-        destroy_texture(m_device, texture);
+        destroy_texture(m_allocator, m_device, texture);
     }
     m_added.clear();
+
+    for (RetiredTexture& retired : m_retired) {
+        destroy_texture(m_allocator, m_device, retired.texture);
+    }
+    m_retired.clear();
+
+    for (auto& bits : m_resident) {
+        bits.store(0, std::memory_order_relaxed);
+    }
+
+    m_sampler_cache.destroy_samplers();
 }
 
 //  ----------------------------------------------------------------------------
-void TextureManager::get_textures(std::vector<Texture>& textures) const {
+uint32_t TextureManager::get_changed_textures(
+    const uint32_t timestamp,
+    std::vector<Texture>& textures
+) const {
     std::lock_guard<std::mutex> lock(m_mutex);
-    textures = m_textures;
+
+    textures.clear();
+    for (size_t n = 0; n < m_textures.size(); ++n) {
+        if (m_slot_timestamps[n] > timestamp) {
+            textures.push_back(m_textures[n]);
+        }
+    }
+
+    return m_timestamp;
+}
+
+//  ----------------------------------------------------------------------------
+TextureCreateArgs TextureManager::get_supported_args(
+    const TextureCreateArgs& args
+) const {
+    TextureCreateArgs supported_args = args;
+    if (
+        is_block_compressed(args.format) &&
+        !m_device_features.texture_compression_bc
+    ) {
+        supported_args.format = TextureFormat::Rgba8;
+    }
+    return supported_args;
 }
 
 //  ----------------------------------------------------------------------------
-void TextureManager::initialize(VulkanQueue& queue, VkCommandPool command_pool) {
-    //  Load empty texture
+void TextureManager::initialize() {
+    //  Load empty texture. Slots are filled with it immediately, so wait for
+    //  the upload.
     TextureCreateArgs args {};
     m_empty_texture = load_texture(
         0,
         "assets/textures/missing.png",
-        queue,
-        command_pool,
         args
     );
+    m_upload_mgr.wait(m_empty_texture.upload);
 
     //  Fill slots with copy of empty texture
     for (size_t n = 0; n < m_textures.size(); ++n) {
@@ -71,18 +181,16 @@ void TextureManager::initialize(VulkanQueue& queue, VkCommandPool command_pool)
 Texture TextureManager::load_texture(
     const TextureId texture_id,
     const std::string& path,
-    VulkanQueue& queue,
-    VkCommandPool command_pool,
     const TextureCreateArgs& args
 ) {
     Texture texture{};
-    create_texture(
-        m_physical_device,
+    render_vk::create_texture(
+        m_allocator,
+        m_upload_mgr,
+        m_sampler_cache,
         m_device,
-        queue,
-        command_pool,
         path,
-        args,
+        get_supported_args(args),
         texture
     );
 
@@ -96,26 +204,47 @@ Texture TextureManager::load_texture(
 }
 
 //  ----------------------------------------------------------------------------
-bool TextureManager::texture_exists(const TextureId texture_id) const {
+void TextureManager::update_textures(
+    const uint32_t frame,
+    const uint32_t frames_in_flight
+) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    return std::find_if(
-        m_textures.begin(),
-        m_textures.end(),
-        [texture_id](const Texture& texture) {
-            return texture.id == texture_id;
-        }
-    ) != m_textures.end();
-}
+    //  Destroy replaced textures once every frame that could sample them has
+    //  completed. Frames submitted after the replacement use the new texture.
+    m_retired.erase(
+        std::remove_if(
+            m_retired.begin(),
+            m_retired.end(),
+            [this, frame, frames_in_flight](const RetiredTexture& retired) {
+                if (retired.frame + frames_in_flight > frame + 1) {
+                    return false;
+                }
+                destroy_texture(m_allocator, m_device, retired.texture);
+                return true;
+            }
+        ),
+        m_retired.end()
+    );
 
-//  ----------------------------------------------------------------------------
-void TextureManager::update_textures() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    //  Move textures whose upload has completed to the end
+    const auto ready_begin = std::stable_partition(
+        m_added.begin(),
+        m_added.end(),
+        [this](const Texture& texture) {
+            return !m_upload_mgr.is_complete(texture.upload);
+        }
+    );
 
-    if (m_added.empty()) {
+    if (ready_begin == m_added.end()) {
         return;
     }
 
+    std::vector<Texture> ready(ready_begin, m_added.end());
+    m_added.erase(ready_begin, m_added.end());
+
+    const uint32_t timestamp = m_timestamp + 1;
+
     //  Texture vector needs to match shader texture array.
     //  Textures need to be in correct order matching texture IDs.
     //  Any missing textures should be filled in with a placeholder
@@ -124,8 +253,8 @@ void TextureManager::update_textures() {
 
     //  Get last ID of new textures
     const uint32_t last_id = std::max_element(
-        m_added.begin(),
-        m_added.end(),
+        ready.begin(),
+        ready.end(),
         [](const Texture& a, const Texture& b){
             return a.id < b.id;
         }
@@ -136,13 +265,14 @@ void TextureManager::update_textures() {
     if (last_id >= count) {
         //  Resize textures vector
         m_textures.resize(last_id + 1);
+        m_slot_timestamps.resize(last_id + 1, timestamp);
         const size_t new_count = m_textures.size();
 
         //  TODO: Texture for missing textures should be loaded separately
         //  For now, use the first available texture.
         const Texture empty_texture =
             count == 0 ?
-            m_added.at(0) :
+            ready.at(0) :
             m_textures.at(0);
 
         //  Fill new slots with copy of empty texture
@@ -153,12 +283,26 @@ void TextureManager::update_textures() {
     }
 
     //  Add new textures
-    for (const Texture& texture : m_added) {
+    for (const Texture& texture : ready) {
+        //  Textures streamed at a different resolution replace the previous
+        //  one, which may still be in use
+        const Texture& previous = m_textures.at(texture.id);
+        if (previous.image != m_empty_texture.image) {
+            m_retired.push_back({previous, frame});
+        }
+
         m_textures.at(texture.id) = texture;
+        m_slot_timestamps.at(texture.id) = timestamp;
     }
 
-    //  Clear added textures
-    m_added.clear();
+    //  Publish residency once the slots are written
+    for (const Texture& texture : ready) {
+        assert(texture.id < MAX_TEXTURES);
+        m_resident[texture.id / 64].fetch_or(
+            uint64_t(1) << (texture.id % 64),
+            std::memory_order_release
+        );
+    }
 
     //  Sort textures by ID
     // std::sort(
@@ -169,7 +313,7 @@ void TextureManager::update_textures() {
     //     }
     // );
 
-    ++m_timestamp;
+    m_timestamp = timestamp;
 
     log_debug("Textures updated.");
 }
@@ -0,0 +1,301 @@
+#include "assets/texture_encoder.hpp"
+#include "common/log.hpp"
+#include "render_vk/texture_manager.hpp"
+#include "render_vk/texture_streamer.hpp"
+#include <algorithm>
+#include <cassert>
+
+using namespace assets;
+using namespace common;
+
+namespace render_vk
+{
+//  ----------------------------------------------------------------------------
+TextureStreamer::TextureStreamer(
+    TextureManager& texture_mgr,
+    UploadManager& upload_mgr
+)
+: m_texture_mgr(texture_mgr),
+  m_upload_mgr(upload_mgr) {
+}
+
+//  ----------------------------------------------------------------------------
+void TextureStreamer::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_resident_size = 0;
+}
+
+//  ----------------------------------------------------------------------------
+void TextureStreamer::evict(const VkDeviceSize needed) {
+    //  Unused textures drop to the coarse level. Textures used last frame
+    //  only drop to the level they were drawn at.
+    std::vector<std::pair<Entry*, uint32_t>> candidates;
+    for (auto& pair : m_entries) {
+        Entry& entry = pair.second;
+        if (entry.pending_level != entry.resident_level) {
+            continue;
+        }
+
+        const uint32_t level =
+            entry.last_used_frame == m_frame ?
+            entry.wanted_level :
+            entry.coarse_level;
+
+        if (level > entry.resident_level) {
+            candidates.push_back({&entry, level});
+        }
+    }
+
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const auto& a, const auto& b) {
+            return a.first->last_used_frame < b.first->last_used_frame;
+        }
+    );
+
+    for (const auto& candidate : candidates) {
+        if (m_resident_size + needed <= m_budget) {
+            break;
+        }
+
+        stream(*candidate.first, candidate.second);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+Texture TextureStreamer::load_texture(
+    const TextureId texture_id,
+    const std::string& path,
+    const TextureCreateArgs& args
+) {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<unsigned char> image;
+    load_png(path, image, width, height);
+
+    Entry entry {};
+    entry.id = texture_id;
+    entry.name = path;
+    entry.args = m_texture_mgr.get_supported_args(args);
+    entry.width = width;
+    entry.height = height;
+    entry.mip_levels = get_texture_mip_levels(width, height);
+
+    //  Find the first level small enough to upload straight away
+    while (
+        entry.coarse_level + 1 < entry.mip_levels &&
+        (std::max(width, height) >> entry.coarse_level) > COARSE_SIZE
+    ) {
+        ++entry.coarse_level;
+    }
+
+    //  Small textures and textures without mipmaps are always fully resident
+    if (!args.mipmaps || entry.coarse_level == 0) {
+        return m_texture_mgr.create_texture(
+            texture_id,
+            path,
+            width,
+            height,
+            image,
+            args
+        );
+    }
+
+    encode_texture(
+        image,
+        width,
+        height,
+        entry.args.format,
+        entry.mip_levels,
+        entry.data
+    );
+
+    size_t offset = 0;
+    for (uint32_t n = 0; n < entry.mip_levels; ++n) {
+        entry.level_offsets.push_back(offset);
+        offset += get_texture_level_size(
+            entry.args.format,
+            std::max(width >> n, 1u),
+            std::max(height >> n, 1u)
+        );
+    }
+    entry.level_offsets.push_back(offset);
+
+    const uint32_t level = entry.coarse_level;
+    entry.resident_level = level;
+    entry.pending_level = level;
+    entry.wanted_level = level;
+
+    Texture texture = m_texture_mgr.create_texture_from_levels(
+        texture_id,
+        path,
+        std::max(width >> level, 1u),
+        std::max(height >> level, 1u),
+        entry.mip_levels - level,
+        &entry.data[entry.level_offsets[level]],
+        get_size(entry, level),
+        entry.args
+    );
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_resident_size += get_size(entry, level);
+        entry.last_used_frame = m_frame;
+        m_entries[texture_id] = std::move(entry);
+    }
+
+    log_debug(
+        "Streaming texture '%s' (%d) starting at %dx%d.",
+        path.c_str(),
+        texture_id,
+        texture.width,
+        texture.height
+    );
+
+    texture.width = width;
+    texture.height = height;
+    return texture;
+}
+
+//  ----------------------------------------------------------------------------
+void TextureStreamer::request_texture(
+    const TextureId texture_id,
+    const float screen_size
+) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const auto find = m_entries.find(texture_id);
+    if (find == m_entries.end()) {
+        return;
+    }
+
+    Entry& entry = find->second;
+
+    //  Smallest level still covering the screen size
+    uint32_t level = 0;
+    if (screen_size > 0.0f) {
+        const uint32_t size = std::max(entry.width, entry.height);
+        while (
+            level < entry.coarse_level &&
+            static_cast<float>(size >> (level + 1)) >= screen_size
+        ) {
+            ++level;
+        }
+    }
+
+    if (entry.last_used_frame != m_frame) {
+        entry.last_used_frame = m_frame;
+        entry.wanted_level = level;
+    } else {
+        entry.wanted_level = std::min(entry.wanted_level, level);
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void TextureStreamer::set_budget(const VkDeviceSize budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+}
+
+//  ----------------------------------------------------------------------------
+void TextureStreamer::stream(Entry& entry, const uint32_t level) {
+    assert(level < entry.mip_levels);
+
+    m_resident_size -= get_size(entry, entry.pending_level);
+    m_resident_size += get_size(entry, level);
+
+    const Texture texture = m_texture_mgr.create_texture_from_levels(
+        entry.id,
+        entry.name,
+        std::max(entry.width >> level, 1u),
+        std::max(entry.height >> level, 1u),
+        entry.mip_levels - level,
+        &entry.data[entry.level_offsets[level]],
+        get_size(entry, level),
+        entry.args
+    );
+
+    entry.pending_level = level;
+    entry.pending_upload = texture.upload;
+
+    log_debug(
+        "Streaming texture '%s' (%d) at %dx%d.",
+        entry.name.c_str(),
+        entry.id,
+        texture.width,
+        texture.height
+    );
+}
+
+//  ----------------------------------------------------------------------------
+void TextureStreamer::update() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //  Completed uploads replace the resident level
+    std::vector<Entry*> upgrades;
+    for (auto& pair : m_entries) {
+        Entry& entry = pair.second;
+        if (
+            entry.pending_level != entry.resident_level &&
+            m_upload_mgr.is_complete(entry.pending_upload)
+        ) {
+            entry.resident_level = entry.pending_level;
+        }
+
+        if (
+            entry.last_used_frame == m_frame &&
+            entry.pending_level == entry.resident_level &&
+            entry.wanted_level < entry.resident_level
+        ) {
+            upgrades.push_back(&entry);
+        }
+    }
+
+    //  Raise the resolution of textures used last frame, largest change first
+    std::sort(
+        upgrades.begin(),
+        upgrades.end(),
+        [](const Entry* a, const Entry* b) {
+            return
+                a->resident_level - a->wanted_level >
+                b->resident_level - b->wanted_level;
+        }
+    );
+
+    VkDeviceSize frame_upload = 0;
+    for (Entry* entry : upgrades) {
+        if (frame_upload >= MAX_FRAME_UPLOAD) {
+            break;
+        }
+
+        const VkDeviceSize resident_size = get_size(*entry, entry->resident_level);
+        const VkDeviceSize wanted_size = get_size(*entry, entry->wanted_level);
+        evict(wanted_size - resident_size);
+
+        //  Step towards the wanted level if it doesn't fit
+        uint32_t level = entry->wanted_level;
+        while (
+            level < entry->resident_level &&
+            m_resident_size - resident_size + get_size(*entry, level) > m_budget
+        ) {
+            ++level;
+        }
+
+        if (level == entry->resident_level) {
+            continue;
+        }
+
+        stream(*entry, level);
+        frame_upload += get_size(*entry, level);
+    }
+
+    //  A lowered budget may need evictions without any upgrades
+    if (m_resident_size > m_budget) {
+        evict(0);
+    }
+
+    ++m_frame;
+}
+}
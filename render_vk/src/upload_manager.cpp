@@ -0,0 +1,460 @@
+#include "common/log.hpp"
+#include "render_vk/buffer.hpp"
+#include "render_vk/command_pool.hpp"
+#include "render_vk/debug_utils.hpp"
+#include "render_vk/image.hpp"
+#include "render_vk/upload_manager.hpp"
+#include "render_vk/vulkan_queue.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+using namespace common;
+
+namespace render_vk
+{
+//  ----------------------------------------------------------------------------
+static VkDeviceSize align_up(const VkDeviceSize value, const VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+//  ----------------------------------------------------------------------------
+static void record_copy_buffer_to_image_commands(
+    VkCommandBuffer command_buffer,
+    VkBuffer buffer,
+    VkDeviceSize buffer_offset,
+    VkImage image,
+    VkFormat format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t level_count
+) {
+    std::vector<VkBufferImageCopy> regions(level_count);
+
+    for (uint32_t n = 0; n < level_count; ++n) {
+        const uint32_t level_width = std::max(width >> n, 1u);
+        const uint32_t level_height = std::max(height >> n, 1u);
+
+        VkBufferImageCopy& region = regions[n];
+        region.bufferOffset = buffer_offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = n;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {
+            level_width,
+            level_height,
+            1
+        };
+
+        buffer_offset += get_image_level_size(format, level_width, level_height);
+    }
+
+    vkCmdCopyBufferToImage(
+        command_buffer,
+        buffer,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        level_count,
+        regions.data()
+    );
+}
+
+//  ----------------------------------------------------------------------------
+UploadManager::UploadManager(
+    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
+    VkDevice device,
+    VulkanQueue& queue,
+    const VkDeviceSize ring_size
+)
+: m_allocator(allocator),
+  m_device(device),
+  m_queue(queue) {
+    create_command_pool(
+        device,
+        physical_device,
+        m_command_pool,
+        "upload_command_pool"
+    );
+
+    //  Copy offsets must be a multiple of the texel or block size (at most
+    //  16 bytes for BC3)
+    VkPhysicalDeviceProperties device_props;
+    vkGetPhysicalDeviceProperties(physical_device, &device_props);
+    m_ring_align = std::max<VkDeviceSize>(
+        16,
+        device_props.limits.optimalBufferCopyOffsetAlignment
+    );
+    m_ring_size = align_up(ring_size, m_ring_align);
+
+    create_buffer(
+        allocator,
+        device,
+        m_ring_size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        m_ring_buffer,
+        m_ring_allocation
+    );
+
+    set_debug_name(
+        device,
+        VK_OBJECT_TYPE_BUFFER,
+        m_ring_buffer,
+        "upload_staging_ring"
+    );
+
+    m_ring = static_cast<char*>(m_ring_allocation.mapped);
+    assert(m_ring != nullptr);
+}
+
+//  ----------------------------------------------------------------------------
+UploadManager::~UploadManager() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    //  Copies that were never submitted
+    for (StagingBuffer& staging : m_staging_buffers) {
+        destroy_buffer(m_allocator, m_device, staging.buffer, staging.allocation);
+    }
+
+    while (!m_batches.empty()) {
+        retire_batch();
+    }
+
+    for (VkFence fence : m_free_fences) {
+        vkDestroyFence(m_device, fence, nullptr);
+    }
+
+    vkDestroyCommandPool(m_device, m_command_pool, nullptr);
+
+    destroy_buffer(m_allocator, m_device, m_ring_buffer, m_ring_allocation);
+}
+
+//  ----------------------------------------------------------------------------
+//  Claims a range of the ring. Returns false if the range is still in use by
+//  submitted or pending copies.
+bool UploadManager::reserve_ring(const VkDeviceSize size, VkDeviceSize& offset) {
+    uint64_t position = align_up(m_ring_head, m_ring_align);
+
+    //  Ranges never wrap around the end of the buffer
+    VkDeviceSize start = position % m_ring_size;
+    if (start + size > m_ring_size) {
+        position += m_ring_size - start;
+        start = 0;
+    }
+
+    if (position + size - m_ring_tail > m_ring_size) {
+        return false;
+    }
+
+    m_ring_head = position + size;
+    offset = start;
+    return true;
+}
+
+//  ----------------------------------------------------------------------------
+//  Waits for the oldest batch and releases its resources
+void UploadManager::retire_batch() {
+    assert(!m_batches.empty());
+    Batch& batch = m_batches.front();
+
+    VK_CHECK_RESULT(vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK_RESULT(vkResetFences(m_device, 1, &batch.fence));
+
+    m_free_fences.push_back(batch.fence);
+    m_free_command_buffers.push_back(batch.command_buffer);
+
+    for (StagingBuffer& staging : batch.staging_buffers) {
+        destroy_buffer(m_allocator, m_device, staging.buffer, staging.allocation);
+    }
+
+    m_ring_tail = batch.ring_end;
+    m_completed.store(batch.ticket, std::memory_order_release);
+
+    m_batches.pop_front();
+}
+
+//  ----------------------------------------------------------------------------
+void UploadManager::retire_completed() {
+    while (
+        !m_batches.empty() &&
+        vkGetFenceStatus(m_device, m_batches.front().fence) == VK_SUCCESS
+    ) {
+        retire_batch();
+    }
+}
+
+//  ----------------------------------------------------------------------------
+//  Copies data to staging memory. Called with the mutex held so ring ranges
+//  are always filled in the order they were claimed.
+void UploadManager::stage(
+    const void* data,
+    const VkDeviceSize size,
+    VkBuffer& buffer,
+    VkDeviceSize& offset
+) {
+    if (size > m_ring_size) {
+        //  Too large for the ring, use a temporary staging buffer
+        StagingBuffer staging;
+        create_buffer(
+            m_allocator,
+            m_device,
+            size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            staging.buffer,
+            staging.allocation,
+            AllocationStrategy::Linear
+        );
+
+        memcpy(staging.allocation.mapped, data, static_cast<size_t>(size));
+
+        buffer = staging.buffer;
+        offset = 0;
+        m_staging_buffers.push_back(staging);
+        return;
+    }
+
+    while (!reserve_ring(size, offset)) {
+        //  Ring is full. Submit pending copies so their space can be
+        //  released, then wait for the oldest batch.
+        submit_pending();
+
+        if (m_batches.empty()) {
+            //  Nothing in flight: restart at the beginning of the buffer
+            m_ring_head = align_up(m_ring_head, m_ring_size);
+            m_ring_tail = m_ring_head;
+        } else {
+            retire_batch();
+        }
+    }
+
+    memcpy(m_ring + offset, data, static_cast<size_t>(size));
+    buffer = m_ring_buffer;
+}
+
+//  ----------------------------------------------------------------------------
+void UploadManager::submit_pending() {
+    if (m_buffer_copies.empty() && m_image_copies.empty()) {
+        return;
+    }
+
+    Batch batch;
+    batch.ticket = m_next_ticket++;
+    batch.ring_end = m_ring_head;
+    batch.staging_buffers = std::move(m_staging_buffers);
+    m_staging_buffers.clear();
+
+    //  Reuse command buffer and fence from a completed batch
+    if (m_free_command_buffers.empty()) {
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = m_command_pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &alloc_info, &batch.command_buffer));
+    } else {
+        batch.command_buffer = m_free_command_buffers.back();
+        m_free_command_buffers.pop_back();
+    }
+
+    if (m_free_fences.empty()) {
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VK_CHECK_RESULT(vkCreateFence(m_device, &fence_info, nullptr, &batch.fence));
+    } else {
+        batch.fence = m_free_fences.back();
+        m_free_fences.pop_back();
+    }
+
+    VkCommandBuffer command_buffer = batch.command_buffer;
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(command_buffer, &begin_info));
+
+    //  Buffer copies
+    for (const BufferCopy& copy : m_buffer_copies) {
+        VkBufferCopy region{};
+        region.srcOffset = copy.src_offset;
+        region.dstOffset = 0;
+        region.size = copy.size;
+        vkCmdCopyBuffer(command_buffer, copy.src, copy.dst, 1, &region);
+    }
+
+    if (!m_buffer_copies.empty()) {
+        //  Make vertex and index data visible to draws
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask =
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+            VK_ACCESS_INDEX_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            command_buffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            0,
+            1,
+            &barrier,
+            0,
+            nullptr,
+            0,
+            nullptr
+        );
+    }
+
+    //  Image copies
+    for (const ImageCopy& copy : m_image_copies) {
+        record_transition_image_layout_commands(
+            command_buffer,
+            copy.dst,
+            copy.format,
+            copy.mip_levels,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+        );
+
+        record_copy_buffer_to_image_commands(
+            command_buffer,
+            copy.src,
+            copy.src_offset,
+            copy.dst,
+            copy.format,
+            copy.width,
+            copy.height,
+            copy.data_levels
+        );
+
+        if (copy.mip_levels > copy.data_levels) {
+            record_generate_mipmaps_commands(
+                command_buffer,
+                copy.dst,
+                copy.width,
+                copy.height,
+                copy.mip_levels
+            );
+        } else {
+            record_transition_image_layout_commands(
+                command_buffer,
+                copy.dst,
+                copy.format,
+                copy.mip_levels,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            );
+        }
+    }
+
+    VK_CHECK_RESULT(vkEndCommandBuffer(command_buffer));
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+
+    if (m_queue.submit(1, submit_info, batch.fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit upload command buffer.");
+    }
+
+    log_debug(
+        "Submitted upload batch %llu (%zu buffers, %zu images).",
+        static_cast<unsigned long long>(batch.ticket),
+        m_buffer_copies.size(),
+        m_image_copies.size()
+    );
+
+    m_buffer_copies.clear();
+    m_image_copies.clear();
+    m_batches.push_back(std::move(batch));
+}
+
+//  ----------------------------------------------------------------------------
+void UploadManager::update() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    retire_completed();
+    submit_pending();
+}
+
+//  ----------------------------------------------------------------------------
+UploadTicket UploadManager::upload_buffer(
+    VkBuffer buffer,
+    const void* data,
+    const VkDeviceSize size
+) {
+    if (size == 0) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    BufferCopy copy {};
+    stage(data, size, copy.src, copy.src_offset);
+    copy.dst = buffer;
+    copy.size = size;
+    m_buffer_copies.push_back(copy);
+
+    return m_next_ticket;
+}
+
+//  ----------------------------------------------------------------------------
+UploadTicket UploadManager::upload_image(
+    VkImage image,
+    const VkFormat format,
+    const uint32_t width,
+    const uint32_t height,
+    const uint32_t mip_levels,
+    const uint32_t data_levels,
+    const void* data,
+    const VkDeviceSize size
+) {
+    assert(data_levels > 0 && data_levels <= mip_levels);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ImageCopy copy {};
+    stage(data, size, copy.src, copy.src_offset);
+    copy.dst = image;
+    copy.format = format;
+    copy.width = width;
+    copy.height = height;
+    copy.mip_levels = mip_levels;
+    copy.data_levels = data_levels;
+    m_image_copies.push_back(copy);
+
+    return m_next_ticket;
+}
+
+//  ----------------------------------------------------------------------------
+void UploadManager::wait(const UploadTicket ticket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (ticket >= m_next_ticket) {
+        submit_pending();
+    }
+
+    while (m_completed.load(std::memory_order_relaxed) < ticket) {
+        retire_batch();
+    }
+}
+
+//  ----------------------------------------------------------------------------
+void UploadManager::wait_idle() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    submit_pending();
+
+    while (!m_batches.empty()) {
+        retire_batch();
+    }
+}
+}
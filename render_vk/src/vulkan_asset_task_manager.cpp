@@ -2,18 +2,18 @@
 #include "assets/texture_create_args.hpp"
 #include "common/log.hpp"
 #include "common/stopwatch.hpp"
-#include "render_vk/command_buffer.hpp"
-#include "render_vk/command_pool.hpp"
 #include "render_vk/debug_utils.hpp"
 #include "render_vk/mesh.hpp"
 #include "render_vk/model_manager.hpp"
 #include "render_vk/spine.hpp"
 #include "render_vk/spine_model.hpp"
 #include "render_vk/texture.hpp"
+#include "render_vk/texture_atlas.hpp"
 #include "render_vk/texture_manager.hpp"
+#include "render_vk/texture_streamer.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan_asset_task_manager.hpp"
 #include "render_vk/vulkan_model.hpp"
-#include "render_vk/vulkan_queue.hpp"
 #include "render_vk/vulkan_spine_manager.hpp"
 
 using namespace assets;
@@ -54,6 +54,32 @@ struct TextureJob : VulkanAssetTaskManager::Job
     TextureCreateArgs create_args {};
 };
 
+struct TextureAtlasJob : VulkanAssetTaskManager::Job
+{
+    std::vector<std::string> paths;
+    uint32_t width {0};
+    uint32_t height {0};
+    TextureAtlasAssetPromise promise;
+    TextureCreateArgs create_args {};
+};
+
+//  ----------------------------------------------------------------------------
+template <typename Promise>
+static void set_promise_exception(
+    Promise& promise,
+    const std::exception_ptr exception
+) {
+    if (!promise.has_value()) {
+        return;
+    }
+
+    try {
+        promise.value().set_exception(exception);
+    } catch (const std::future_error&) {
+        //  The job failed after fulfilling the promise
+    }
+}
+
 //  ----------------------------------------------------------------------------
 const char* VulkanAssetTaskManager::task_id_to_string(TaskId task_id) {
     switch (task_id) {
@@ -63,24 +89,31 @@ const char* VulkanAssetTaskManager::task_id_to_string(TaskId task_id) {
             return "load_model";
         case TaskId::LoadTexture:
             return "load_texture";
+        case TaskId::LoadTextureAtlas:
+            return "load_texture_atlas";
     }
 }
 
 //  ----------------------------------------------------------------------------
 VulkanAssetTaskManager::VulkanAssetTaskManager(
-    VkPhysicalDevice physical_device,
     VkDevice device,
-    VulkanQueue& queue,
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
     ModelManager& model_mgr,
     VulkanSpineManager& spine_mgr,
-    TextureManager& texture_mgr
+    TextureManager& texture_mgr,
+    TextureStreamer& texture_streamer,
+    ThreadPool& thread_pool
 )
-: m_physical_device(physical_device),
-  m_device(device),
-  m_queue(queue),
+: m_device(device),
+  m_thread_pool(thread_pool),
+  m_jobs(thread_pool),
+  m_allocator(allocator),
+  m_upload_mgr(upload_mgr),
   m_model_mgr(model_mgr),
   m_spine_mgr(spine_mgr),
-  m_texture_mgr(texture_mgr) {
+  m_texture_mgr(texture_mgr),
+  m_texture_streamer(texture_streamer) {
 }
 
 //  ----------------------------------------------------------------------------
@@ -95,18 +128,34 @@ void VulkanAssetTaskManager::add_job(std::unique_ptr<Job> job) {
         throw std::runtime_error("Invalid job task ID.");
     }
 
-    //  Enqueue job
-    m_jobs.push(std::move(job));
+    //  Enqueue job. Tasks must be copyable so share ownership with the task.
+    std::shared_ptr<Job> shared_job = std::move(job);
+    m_jobs.run(
+        [this, shared_job]() {
+            run_job(shared_job.get());
+        }
+    );
 }
 
 //  ----------------------------------------------------------------------------
 void VulkanAssetTaskManager::cancel_threads() {
-    m_jobs.cancel();
-    for (std::thread& thread : m_threads) {
-        thread.join();
+    m_canceled = true;
+    try {
+        m_jobs.wait();
+    } catch (const std::exception& e) {
+        //  Also called by the destructor, so errors are only logged
+        log_error("Asset job failed: %s", e.what());
+    } catch (...) {
+        log_error("Asset job failed.");
+    }
+    m_canceled = false;
+
+    //  Release thread state objects
+    for (ThreadState& state : m_workers) {
+        log_debug("Released asset objects for %s.", state.name.c_str());
     }
-    m_threads.clear();
-    m_jobs.resume();
+
+    m_workers.clear();
 }
 
 //  ----------------------------------------------------------------------------
@@ -169,6 +218,47 @@ void VulkanAssetTaskManager::load_texture(
     add_job(std::move(job));
 }
 
+//  ----------------------------------------------------------------------------
+void VulkanAssetTaskManager::load_texture_atlas(
+    AssetId id,
+    TextureAtlasLoadArgs& load_args,
+    const TextureCreateArgs& create_args
+) {
+    auto job = std::make_unique<TextureAtlasJob>();
+    job->task_id = TaskId::LoadTextureAtlas;
+    job->asset_id = id;
+    job->path = load_args.name;
+    job->paths = load_args.paths;
+    job->width = load_args.width;
+    job->height = load_args.height;
+    job->create_args = create_args;
+    job->promise = std::move(load_args.promise);
+    add_job(std::move(job));
+}
+
+//  ----------------------------------------------------------------------------
+void VulkanAssetTaskManager::set_job_exception(
+    Job* job,
+    const std::exception_ptr exception
+) {
+    switch (job->task_id) {
+        default:
+            break;
+        case TaskId::LoadMesh:
+            set_promise_exception(static_cast<MeshJob*>(job)->promise, exception);
+            break;
+        case TaskId::LoadSpine:
+            set_promise_exception(static_cast<SpineJob*>(job)->promise, exception);
+            break;
+        case TaskId::LoadTexture:
+            set_promise_exception(static_cast<TextureJob*>(job)->promise, exception);
+            break;
+        case TaskId::LoadTextureAtlas:
+            set_promise_exception(static_cast<TextureAtlasJob*>(job)->promise, exception);
+            break;
+    }
+}
+
 //  ----------------------------------------------------------------------------
 void VulkanAssetTaskManager::shutdown() {
     cancel_threads();
@@ -176,9 +266,18 @@ void VulkanAssetTaskManager::shutdown() {
 
 //  ----------------------------------------------------------------------------
 void VulkanAssetTaskManager::start_threads() {
-    assert(m_thread_count > 0);
-    for (auto n = 0; n < m_thread_count; ++n) {
-        m_threads.emplace_back(&VulkanAssetTaskManager::thread_main, this, n);
+    assert(m_workers.empty());
+
+    const size_t thread_count = m_thread_pool.get_thread_count();
+    if (thread_count == 0) {
+        throw std::runtime_error("Asset tasks require thread pool workers.");
+    }
+
+    m_workers.resize(thread_count);
+
+    for (size_t n = 0; n < thread_count; ++n) {
+        ThreadState& state = m_workers[n];
+        state.name = "asset_worker" + std::to_string(n);
     }
 }
 
@@ -214,7 +313,9 @@ void VulkanAssetTaskManager::thread_create_glyph_mesh(ThreadState& state, Job* j
             vertex.position = glyph.position + POSITIONS[n] * size;
             vertex.bg_color = glyph.bg_color;
             vertex.fg_color = glyph.fg_color;
-            vertex.tex_coord = TEX_COORDS[n];
+            vertex.tex_coord =
+                glm::vec2(glyph.uv_rect) +
+                TEX_COORDS[n] * glm::vec2(glyph.uv_rect.z, glyph.uv_rect.w);
             vertex.texture_id = glyph.texture_id;
 
             mesh.vertices.push_back(vertex);
@@ -228,7 +329,7 @@ void VulkanAssetTaskManager::thread_create_glyph_mesh(ThreadState& state, Job* j
     }
 
     auto model = std::make_unique<VulkanModel>(create_job->asset_id);
-    model->load(m_physical_device, m_device, m_queue, state.command_pool, mesh);
+    model->load(m_allocator, m_upload_mgr, m_device, mesh);
 
     m_model_mgr.add_model(std::move(model));
 }
@@ -238,13 +339,46 @@ void VulkanAssetTaskManager::thread_load_model(ThreadState& state, Job* job) {
     m_model_mgr.load_model(
         job->asset_id,
         job->path,
-        m_physical_device,
-        m_device,
-        m_queue,
-        state.command_pool
+        m_allocator,
+        m_upload_mgr,
+        m_device
     );
 }
 
+//  ----------------------------------------------------------------------------
+void VulkanAssetTaskManager::thread_load_texture_atlas(
+    ThreadState& state,
+    Job* job
+) {
+    TextureAtlasJob* atlas_job = static_cast<TextureAtlasJob*>(job);
+
+    TextureAtlas atlas {};
+    build_texture_atlas(
+        atlas_job->paths,
+        atlas_job->width,
+        atlas_job->height,
+        atlas
+    );
+
+    const Texture texture = m_texture_mgr.create_texture(
+        job->asset_id,
+        job->path,
+        atlas.width,
+        atlas.height,
+        atlas.pixels,
+        atlas_job->create_args
+    );
+
+    if (atlas_job->promise.has_value()) {
+        TextureAtlasAsset atlas_asset {};
+        atlas_asset.texture_id = texture.id;
+        atlas_asset.width = texture.width;
+        atlas_asset.height = texture.height;
+        atlas_asset.uv_rects = std::move(atlas.uv_rects);
+        atlas_job->promise.value().set_value(std::move(atlas_asset));
+    }
+}
+
 //  ----------------------------------------------------------------------------
 Texture VulkanAssetTaskManager::thread_load_texture(
     const TextureId texture_id,
@@ -252,134 +386,135 @@ Texture VulkanAssetTaskManager::thread_load_texture(
     const TextureCreateArgs& create_args,
     ThreadState& state
 ) {
-    return m_texture_mgr.load_texture(
+    return m_texture_streamer.load_texture(
         texture_id,
         path,
-        m_queue,
-        state.command_pool,
         create_args
     );
 }
 
 //  ----------------------------------------------------------------------------
-void VulkanAssetTaskManager::thread_main(uint8_t thread_id) {
-    Stopwatch stopwatch;
-
-    log_debug("Asset thread %d started (%p).", thread_id, std::this_thread::get_id());
-
-    const std::string thread_name = "asset_worker" + std::to_string(thread_id);
-
-    //  Initialize thread objects
-    ThreadState state{};
-
-    create_transient_command_pool(
-        m_device,
-        m_physical_device,
-        state.command_pool,
-        (thread_name + "_command_pool").c_str()
+void VulkanAssetTaskManager::process_job(ThreadState& state, Job* job) {
+    log_debug(
+        "%s: execute %s",
+        state.name.c_str(),
+        task_id_to_string(job->task_id)
     );
 
-    //  Main loop
-    while (true) {
-        std::unique_ptr<Job> job;
-        //  Sleep until job is available
-        if (!m_jobs.wait_and_pop(job)) {
+    //  Process job
+    switch (job->task_id) {
+        case TaskId::CreateGlyphMesh: {
+            state.stopwatch.start(state.name+"_create_glyph_mesh");
+            thread_create_glyph_mesh(state, job);
+            state.stopwatch.stop(state.name+"_create_glyph_mesh");
             break;
         }
 
-        log_debug(
-            "%s: execute %s",
-            thread_name.c_str(),
-            task_id_to_string(job->task_id)
-        );
+        case TaskId::LoadModel: {
+            state.stopwatch.start(state.name+"_load_model");
+            thread_load_model(state, job);
+            state.stopwatch.stop(state.name+"_load_model");
+            break;
+        }
 
-        //  Process job
-        switch (job->task_id) {
-            case TaskId::CreateGlyphMesh: {
-                stopwatch.start(thread_name+"_create_glyph_mesh");
-                thread_create_glyph_mesh(state, job.get());
-                stopwatch.stop(thread_name+"_create_glyph_mesh");
-                break;
-            }
+        case TaskId::LoadSpine: {
+            state.stopwatch.start(state.name+"_load_spine");
 
-            case TaskId::LoadModel: {
-                stopwatch.start(thread_name+"_load_model");
-                thread_load_model(state, job.get());
-                stopwatch.stop(thread_name+"_load_model");
-                break;
-            }
+            SpineJob* spine_job = static_cast<SpineJob*>(job);
 
-            case TaskId::LoadSpine: {
-                stopwatch.start(thread_name+"_load_spine");
-
-                SpineJob* spine_job = static_cast<SpineJob*>(job.get());
+            //  If the texture wasn't already loaded, AssetManager will have
+            //  enqueued a job for it. Wait for the texture to finish loading.
+            //  Jobs added from outside the pool are started in the order they
+            //  were added, so the texture job is already running or done.
+            TextureAsset texture_asset {};
+            if (spine_job->texture_future.valid()) {
+                texture_asset = spine_job->texture_future.get();
+            } else {
+                throw std::runtime_error("Fetch texture asset not implemented.");
+            }
 
-                //  If the texture wasn't already loaded, AssetManager will have
-                //  enqueued a job for it. Wait for the texture to finish loading.
-                TextureAsset texture_asset {};
-                if (spine_job->texture_future.valid()) {
-                    texture_asset = spine_job->texture_future.get();
-                } else {
-                    throw std::runtime_error("Fetch texture asset not implemented.");
-                }
-
-                //  Load Spine data
-                auto spine_model = render_vk::load_spine(job->path, texture_asset);
-
-                //  Create model using mesh data
-                spine_model->model.load(
-                    m_physical_device,
-                    m_device,
-                    m_queue,
-                    state.command_pool,
-                    spine_model->meshes
-                );
-
-                //  Fulfill optional promise
-                if (spine_job->promise.has_value()) {
-                    SpineAsset spine_asset {};
-                    spine_asset.id = job->asset_id;
-                    spine_job->promise.value().set_value(spine_asset);
-                }
-
-                m_spine_mgr.add_spine_model(std::move(spine_model), texture_asset.id);
-
-                stopwatch.stop(thread_name+"_load_spine");
-                break;
+            //  Load Spine data
+            auto spine_model = render_vk::load_spine(job->path, texture_asset);
+
+            //  Create model using mesh data
+            spine_model->model.load(
+                m_allocator,
+                m_upload_mgr,
+                m_device,
+                spine_model->meshes
+            );
+
+            //  Fulfill optional promise
+            if (spine_job->promise.has_value()) {
+                SpineAsset spine_asset {};
+                spine_asset.id = job->asset_id;
+                spine_job->promise.value().set_value(spine_asset);
             }
 
-            case TaskId::LoadTexture: {
-                stopwatch.start(thread_name+"_load_texture");
+            m_spine_mgr.add_spine_model(std::move(spine_model), texture_asset.id);
+
+            state.stopwatch.stop(state.name+"_load_spine");
+            break;
+        }
 
-                TextureJob* texture_job = static_cast<TextureJob*>(job.get());
+        case TaskId::LoadTexture: {
+            state.stopwatch.start(state.name+"_load_texture");
 
-                Texture texture = thread_load_texture(
-                    job->asset_id,
-                    job->path,
-                    texture_job->create_args,
-                    state
-                );
+            TextureJob* texture_job = static_cast<TextureJob*>(job);
 
-                if (texture_job->promise.has_value()) {
-                    TextureAsset texture_asset {};
-                    texture_asset.id = texture.id;
-                    texture_asset.width = texture.width;
-                    texture_asset.height = texture.height;
-                    texture_job->promise.value().set_value(texture_asset);
-                }
+            Texture texture = thread_load_texture(
+                job->asset_id,
+                job->path,
+                texture_job->create_args,
+                state
+            );
 
-                stopwatch.stop(thread_name+"_load_texture");
-                break;
+            if (texture_job->promise.has_value()) {
+                TextureAsset texture_asset {};
+                texture_asset.id = texture.id;
+                texture_asset.width = texture.width;
+                texture_asset.height = texture.height;
+                texture_job->promise.value().set_value(texture_asset);
             }
 
-            default:
-                throw std::runtime_error("Asset worker thread task not implemented.");
+            state.stopwatch.stop(state.name+"_load_texture");
+            break;
+        }
+
+        case TaskId::LoadTextureAtlas: {
+            state.stopwatch.start(state.name+"_load_texture_atlas");
+            thread_load_texture_atlas(state, job);
+            state.stopwatch.stop(state.name+"_load_texture_atlas");
+            break;
         }
+
+        default:
+            throw std::runtime_error("Asset worker thread task not implemented.");
     }
+}
 
-    //  Release thread state objects
-    vkDestroyCommandPool(m_device, state.command_pool, nullptr);
+//  ----------------------------------------------------------------------------
+void VulkanAssetTaskManager::run_job(Job* job) {
+    if (m_canceled) {
+        return;
+    }
 
-    log_debug("Asset worker thread %d exited.", thread_id);
+    const size_t worker_index = m_thread_pool.get_worker_index();
+    assert(worker_index < m_workers.size());
+    ThreadState& state = m_workers[worker_index];
+
+    try {
+        process_job(state, job);
+    } catch (const std::exception& e) {
+        log_error(
+            "%s: %s '%s' failed: %s",
+            state.name.c_str(),
+            task_id_to_string(job->task_id),
+            job->path.c_str(),
+            e.what()
+        );
+
+        set_job_exception(job, std::current_exception());
+    }
 }
 }
@@ -1,3 +1,4 @@
+#include "render_vk/buffer.hpp"
 #include "render_vk/mesh.hpp"
 #include "render_vk/vulkan.hpp"
 #include "render_vk/index_buffer.hpp"
@@ -8,10 +9,9 @@ namespace render_vk
 {
 //  ----------------------------------------------------------------------------
 void VulkanModel::load(
-    VkPhysicalDevice physical_device,
+    MemoryAllocator& allocator,
+    UploadManager& upload_mgr,
     VkDevice device,
-    VulkanQueue& graphics_queue,
-    VkCommandPool command_pool,
     std::vector<Mesh>& meshes
 ) {
     Mesh mesh;
@@ -40,18 +40,27 @@ void VulkanModel::load(
         index_offset += m.indices.size();
     }
 
-    load(physical_device, device, graphics_queue, command_pool, mesh);
+    load(allocator, upload_mgr, device, mesh);
 }
 
 //  ----------------------------------------------------------------------------
 void VulkanModel::unload() {
     if (m_device != nullptr) {
-        vkDestroyBuffer(m_device, m_index_buffer, nullptr);
-        vkFreeMemory(m_device, m_index_buffer_memory, nullptr);
+        destroy_buffer(
+            *m_allocator,
+            m_device,
+            m_index_buffer,
+            m_index_buffer_allocation
+        );
 
-        vkDestroyBuffer(m_device, m_vertex_buffer, nullptr);
-        vkFreeMemory(m_device, m_vertex_buffer_memory, nullptr);
+        destroy_buffer(
+            *m_allocator,
+            m_device,
+            m_vertex_buffer,
+            m_vertex_buffer_allocation
+        );
 
+        m_allocator = nullptr;
         m_device = nullptr;
     }
 }
@@ -4,24 +4,6 @@
 
 namespace render_vk
 {
-//  ----------------------------------------------------------------------------
-void VulkanQueue::copy_buffer(
-    VkCommandPool command_pool,
-    VkBuffer src,
-    VkBuffer dst,
-    VkDeviceSize size
-) {
-    VkCommandBuffer command_buffer = begin_single_time_commands(m_device, command_pool);
-
-    VkBufferCopy copy_region{};
-    copy_region.srcOffset = 0; // Optional
-    copy_region.dstOffset = 0; // Optional
-    copy_region.size = size;
-    vkCmdCopyBuffer(command_buffer, src, dst, 1, &copy_region);
-
-    end_single_time_commands(command_pool, command_buffer);
-}
-
 //  ----------------------------------------------------------------------------
 void VulkanQueue::end_single_time_commands(
     VkCommandPool command_pool,
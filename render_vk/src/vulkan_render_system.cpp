@@ -9,13 +9,17 @@
 #include "render_vk/descriptor_set_manager.hpp"
 #include "render_vk/devices.hpp"
 #include "render_vk/framebuffers.hpp"
+#include "render_vk/image.hpp"
 #include "render_vk/imgui/imgui_vk.hpp"
 #include "render_vk/instance.hpp"
+#include "render_vk/memory_allocator.hpp"
 #include "render_vk/mesh.hpp"
 #include "render_vk/model_manager.hpp"
 #include "render_vk/render_pass.hpp"
 #include "render_vk/texture.hpp"
 #include "render_vk/texture_manager.hpp"
+#include "render_vk/texture_streamer.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan.hpp"
 #include "render_vk/render_task_manager.hpp"
 #include "render_vk/renderers/billboard_renderer.hpp"
@@ -29,7 +33,6 @@
 #include "render_vk/vulkan_spine_manager.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <cassert>
-#include <thread>
 
 using namespace assets;
 using namespace common;
@@ -108,9 +111,13 @@ static void create_primary_command_objects(
 }
 
 //  ----------------------------------------------------------------------------
-VulkanRenderSystem::VulkanRenderSystem(const uint32_t max_objects)
+VulkanRenderSystem::VulkanRenderSystem(
+    const uint32_t max_objects,
+    ThreadPool& thread_pool
+)
 : Renderer(RenderApi::Vulkan),
   m_max_objects(max_objects),
+  m_thread_pool(thread_pool),
   m_frames(m_frame_count),
   m_glfw_window(nullptr) {
     assert(m_frames.size() > 0);
@@ -141,10 +148,14 @@ void VulkanRenderSystem::begin_frame() {
 
     // log_debug("begin_frame: %d", m_current_frame);
 
+    //  Submit queued uploads and release completed ones
+    m_upload_mgr->update();
+
     //  Add recently loaded assets to active sets
-    m_model_mgr->update_models();
-    m_texture_mgr->update_textures();
-    m_spine_mgr->update_models();
+    m_model_mgr->update_models(*m_upload_mgr);
+    m_texture_streamer->update();
+    m_texture_mgr->update_textures(m_submitted_frames, m_frame_count);
+    m_spine_mgr->update_models(*m_upload_mgr);
 
     //  Update descriptor sets
     m_descriptor_set_mgr->update_descriptor_sets(*m_texture_mgr);
@@ -188,23 +199,6 @@ void VulkanRenderSystem::begin_frame() {
     STOPWATCH.stop("VulkanRenderSystem::begin_frame()");
 }
 
-//  ----------------------------------------------------------------------------
-bool VulkanRenderSystem::check_render_tasks_complete() {
-    if (m_frame_status != FrameStatus::Busy) {
-        //  Worker threads are not processing tasks this frame
-        return true;
-    }
-
-    if (m_render_task_mgr->check_tasks_complete()) {
-        //  Worker threads have completed all tasks for this frame
-        m_frame_status = FrameStatus::Ready;
-        return true;
-    }
-
-    //  Worker threads are still processing tasks for this frame
-    return false;
-}
-
 //  ----------------------------------------------------------------------------
 void VulkanRenderSystem::create_frame_resources() {
     //  Create frame resources
@@ -278,7 +272,8 @@ void VulkanRenderSystem::create_swapchain_dependents() {
         m_swapchain,
         m_render_pass,
         m_msaa_samples,
-        m_descriptor_set_layouts
+        m_descriptor_set_layouts,
+        m_device_features
     );
 
     m_spine_sprite_renderer->create_objects(
@@ -299,7 +294,7 @@ void VulkanRenderSystem::create_swapchain_dependents() {
     );
 
     create_color_resources(
-        m_physical_device,
+        *m_memory_allocator,
         m_device,
         m_swapchain,
         m_msaa_samples,
@@ -308,6 +303,7 @@ void VulkanRenderSystem::create_swapchain_dependents() {
 
     create_depth_resources(
         m_physical_device,
+        *m_memory_allocator,
         m_device,
         *m_graphics_queue,
         m_resource_command_pool,
@@ -354,13 +350,21 @@ void VulkanRenderSystem::destroy_swapchain() {
 
     //  MSAA buffer
     vkDestroyImageView(m_device, m_color_image.view, nullptr);
-    vkDestroyImage(m_device, m_color_image.image, nullptr);
-    vkFreeMemory(m_device, m_color_image.memory, nullptr);
+    destroy_image(
+        *m_memory_allocator,
+        m_device,
+        m_color_image.image,
+        m_color_image.allocation
+    );
 
     //  Depth testing
     vkDestroyImageView(m_device, m_depth_image.view, nullptr);
-    vkDestroyImage(m_device, m_depth_image.image, nullptr);
-    vkFreeMemory(m_device, m_depth_image.memory, nullptr);
+    destroy_image(
+        *m_memory_allocator,
+        m_device,
+        m_depth_image.image,
+        m_depth_image.allocation
+    );
 
     //  Destroy framebuffers before respective images views and render pass
     for (auto framebuffer : m_swapchain.framebuffers) {
@@ -390,6 +394,10 @@ void VulkanRenderSystem::destroy_swapchain() {
 void VulkanRenderSystem::draw_billboards(
     std::vector<render::SpriteBatch>& batches
 ) {
+    for (const render::SpriteBatch& batch : batches) {
+        m_texture_streamer->request_texture(batch.texture_id, batch.screen_size);
+    }
+
     m_render_task_mgr->draw_billboards(*m_billboard_renderer, batches);
 }
 
@@ -407,6 +415,10 @@ void VulkanRenderSystem::draw_glyphs(GlyphBatch& glyph_batch) {
 void VulkanRenderSystem::draw_models(
     std::vector<render::ModelBatch>& batches
 ) {
+    for (const render::ModelBatch& batch : batches) {
+        m_texture_streamer->request_texture(batch.texture_id, batch.screen_size);
+    }
+
     m_render_task_mgr->draw_models(*m_model_renderer, batches);
 }
 
@@ -421,6 +433,10 @@ void VulkanRenderSystem::draw_spines(
 void VulkanRenderSystem::draw_sprites(
     std::vector<render::SpriteBatch>& batches
 ) {
+    for (const render::SpriteBatch& batch : batches) {
+        m_texture_streamer->request_texture(batch.texture_id, batch.screen_size);
+    }
+
     m_render_task_mgr->draw_sprites(*m_sprite_renderer, batches);
 }
 
@@ -431,9 +447,7 @@ void VulkanRenderSystem::end_frame() {
     // log_debug("end_frame: %d (waiting for render tasks)", m_current_frame);
 
     //  Wait for worker threads to complete
-    while (!check_render_tasks_complete()) {
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
-    }
+    wait_for_render_tasks();
 
     //  Check that frame is OK to continue with
     if (m_frame_status != FrameStatus::Ready) {
@@ -519,6 +533,7 @@ void VulkanRenderSystem::end_frame() {
 
     //  Advance frame counter
     m_current_frame = (m_current_frame + 1) % m_frame_count;
+    ++m_submitted_frames;
 
     m_render_task_mgr->end_frame();
 
@@ -610,7 +625,8 @@ bool VulkanRenderSystem::initialize(GLFWwindow* glfw_window) {
         device_extensions,
         m_device,
         graphics_queue,
-        present_queue
+        present_queue,
+        m_device_features
     )) {
         return false;
     }
@@ -625,6 +641,11 @@ bool VulkanRenderSystem::initialize(GLFWwindow* glfw_window) {
     //  Optimize device calls
     volkLoadDevice(m_device);
 
+    m_memory_allocator = std::make_unique<MemoryAllocator>(
+        m_physical_device,
+        m_device
+    );
+
     //  Create graphics queue wrapper
     m_graphics_queue = std::make_unique<VulkanQueue>(
         m_physical_device,
@@ -643,6 +664,13 @@ bool VulkanRenderSystem::initialize(GLFWwindow* glfw_window) {
         );
     }
 
+    m_upload_mgr = std::make_unique<UploadManager>(
+        m_physical_device,
+        *m_memory_allocator,
+        m_device,
+        *m_graphics_queue
+    );
+
     create_descriptor_set_layouts(m_device, MAX_TEXTURES, m_descriptor_set_layouts);
 
     m_descriptor_set_mgr = std::make_unique<DescriptorSetManager>(
@@ -652,7 +680,16 @@ bool VulkanRenderSystem::initialize(GLFWwindow* glfw_window) {
 
     m_model_mgr = std::make_unique<ModelManager>();
     m_spine_mgr = std::make_shared<VulkanSpineManager>();
-    m_texture_mgr = std::make_unique<TextureManager>(m_physical_device, m_device);
+    m_texture_mgr = std::make_unique<TextureManager>(
+        *m_memory_allocator,
+        *m_upload_mgr,
+        m_device,
+        m_device_features
+    );
+    m_texture_streamer = std::make_unique<TextureStreamer>(
+        *m_texture_mgr,
+        *m_upload_mgr
+    );
 
     m_billboard_renderer = std::make_unique<BillboardRenderer>(*m_model_mgr);
     m_glyph_renderer = std::make_unique<GlyphRenderer>(*m_model_mgr);
@@ -667,19 +704,20 @@ bool VulkanRenderSystem::initialize(GLFWwindow* glfw_window) {
     create_frame_resources();
 
     m_model_mgr->initialize(
-        m_physical_device,
-        m_device,
-        *m_graphics_queue,
-        m_resource_command_pool
+        *m_memory_allocator,
+        *m_upload_mgr,
+        m_device
     );
 
     m_asset_task_mgr = std::make_shared<VulkanAssetTaskManager>(
-        m_physical_device,
         m_device,
-        *m_graphics_queue,
+        *m_memory_allocator,
+        *m_upload_mgr,
         *m_model_mgr,
         *m_spine_mgr,
-        *m_texture_mgr
+        *m_texture_mgr,
+        *m_texture_streamer,
+        m_thread_pool
     );
 
     m_asset_task_mgr->start_threads();
@@ -687,15 +725,17 @@ bool VulkanRenderSystem::initialize(GLFWwindow* glfw_window) {
     m_render_task_mgr = std::make_unique<RenderTaskManager>(
         m_physical_device,
         m_device,
+        *m_memory_allocator,
         m_descriptor_set_layouts,
         *m_descriptor_set_mgr,
         *m_model_mgr,
         *m_texture_mgr,
+        m_thread_pool,
         m_frame_count,
         m_max_objects
     );
 
-    m_texture_mgr->initialize(*m_graphics_queue, m_resource_command_pool);
+    m_texture_mgr->initialize();
 
     return true;
 }
@@ -736,6 +776,11 @@ void VulkanRenderSystem::resize() {
     m_framebuffer_resized = true;
 }
 
+//  ----------------------------------------------------------------------------
+void VulkanRenderSystem::set_texture_budget(const size_t bytes) {
+    m_texture_streamer->set_budget(bytes);
+}
+
 //  ----------------------------------------------------------------------------
 void VulkanRenderSystem::shutdown() {
     log_debug("Shutting down Vulkan renderer...");
@@ -759,12 +804,19 @@ void VulkanRenderSystem::shutdown() {
     //  Unload models
     m_model_mgr->unload(m_device);
 
+    m_texture_streamer->clear();
     m_texture_mgr->destroy_textures();
 
     m_spine_mgr->unload();
 
     m_render_task_mgr->shutdown();
 
+    //  Release staging memory and upload command buffers
+    m_upload_mgr.reset();
+
+    //  Free device memory blocks
+    m_memory_allocator.reset();
+
     vkDestroyDevice(m_device, nullptr);
     vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
 
@@ -784,4 +836,16 @@ void VulkanRenderSystem::update_frame_uniforms(
 ) {
     m_render_task_mgr->update_frame_uniforms(view, proj, ortho_view, ortho_proj);
 }
+
+//  ----------------------------------------------------------------------------
+void VulkanRenderSystem::wait_for_render_tasks() {
+    if (m_frame_status != FrameStatus::Busy) {
+        //  Worker threads are not processing tasks this frame
+        return;
+    }
+
+    //  Main thread helps record the remaining jobs
+    m_render_task_mgr->wait_for_tasks();
+    m_frame_status = FrameStatus::Ready;
+}
 }
@@ -1,5 +1,6 @@
 #include "assets/spine_asset.hpp"
 #include "render_vk/spine_model.hpp"
+#include "render_vk/upload_manager.hpp"
 #include "render_vk/vulkan_spine_manager.hpp"
 
 using namespace assets;
@@ -91,12 +92,18 @@ void VulkanSpineManager::unload() {
 }
 
 //  ----------------------------------------------------------------------------
-void VulkanSpineManager::update_models() {
+void VulkanSpineManager::update_models(const UploadManager& upload_mgr) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    for (auto& model : m_added) {
-        m_models[model->model.get_id()] = std::move(model);
+    //  Add models whose upload has completed
+    auto itr = m_added.begin();
+    while (itr != m_added.end()) {
+        if (upload_mgr.is_complete((*itr)->model.get_upload())) {
+            m_models[(*itr)->model.get_id()] = std::move(*itr);
+            itr = m_added.erase(itr);
+        } else {
+            ++itr;
+        }
     }
-    m_added.clear();
 }
 }
@@ -9,6 +9,7 @@
 namespace engine
 {
 class Game;
+struct SystemAccess;
 }
 
 namespace systems
@@ -89,6 +90,9 @@ public:
         return get_component_data(cmpnt).target_entity;
     }
 
+    //  Systems read and written by update()
+    static engine::SystemAccess get_update_access();
+
     glm::mat4 get_view_matrix(const Component cmpnt) const {
         return get_component_data(cmpnt).view;
     }
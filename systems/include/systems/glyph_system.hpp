@@ -4,6 +4,7 @@
 #include "systems/system_ids.hpp"
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
+#include <vector>
 
 namespace systems
 {
@@ -32,6 +33,9 @@ class GlyphSystem : public ecs::EntitySystem<GlyphComponentData>
         uint32_t texture_id;
         uint32_t width;
         uint32_t height;
+        //  Texture coordinates of each glyph in an atlas texture. If empty,
+        //  each glyph has its own texture following texture_id.
+        std::vector<glm::vec4> uv_rects;
     };
 
     std::vector<GlyphSet> m_glyph_sets;
@@ -46,7 +50,17 @@ public:
         const uint32_t width,
         const uint32_t height
     ) {
-        m_glyph_sets.push_back({ texture_id, width, height });
+        m_glyph_sets.push_back({ texture_id, width, height, {} });
+    }
+
+    //  Adds a glyph set drawn from a single atlas texture
+    void add_glyph_set(
+        const uint32_t texture_id,
+        const uint32_t width,
+        const uint32_t height,
+        std::vector<glm::vec4> uv_rects
+    ) {
+        m_glyph_sets.push_back({ texture_id, width, height, std::move(uv_rects) });
     }
 
     glm::vec4 get_bg_color(const Component cmpnt) const {
@@ -58,19 +72,36 @@ public:
     }
 
     glm::vec2 get_size(const Component cmpnt) const {
-        const uint32_t glyph_set_id = get_component_data(cmpnt).glyph_set_id;
-        const GlyphSet& glyph_set = m_glyph_sets.at(glyph_set_id);
+        return get_size(get_component_data(cmpnt));
+    }
+
+    glm::vec2 get_size(const GlyphComponentData& data) const {
+        const GlyphSet& glyph_set = m_glyph_sets.at(data.glyph_set_id);
         return { glyph_set.width, glyph_set.height };
     }
 
     uint32_t get_texture_id(const Component cmpnt) const {
-        const auto& data = get_component_data(cmpnt);
+        return get_texture_id(get_component_data(cmpnt));
+    }
+
+    uint32_t get_texture_id(const GlyphComponentData& data) const {
         const uint32_t glyph = data.ch;
         const uint32_t glyph_set_id = data.glyph_set_id;
         const GlyphSet& glyph_set = m_glyph_sets.at(glyph_set_id);
+        if (!glyph_set.uv_rects.empty()) {
+            return glyph_set.texture_id;
+        }
         return glyph_set.texture_id + glyph;
     }
 
+    glm::vec4 get_uv_rect(const GlyphComponentData& data) const {
+        const GlyphSet& glyph_set = m_glyph_sets.at(data.glyph_set_id);
+        if (glyph_set.uv_rects.empty()) {
+            return { 0.0f, 0.0f, 1.0f, 1.0f };
+        }
+        return glyph_set.uv_rects.at(data.ch);
+    }
+
     static const common::SystemId Id = SYSTEM_ID_GLYPH;
 
     void set_bg(const Component cmpnt, const glm::vec4 bg) {
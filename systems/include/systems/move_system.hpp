@@ -8,6 +8,7 @@
 namespace engine
 {
 class Game;
+struct SystemAccess;
 }
 
 namespace systems
@@ -28,7 +29,18 @@ struct MoveComponentData
     }
 };
 
-class MoveSystem : public ecs::EntitySystem<MoveComponentData>
+//  Fields are stored in separate arrays so the update loops only stream the
+//  fields they use.
+using MoveComponentLayout = ecs::SoaLayout<
+    &MoveComponentData::direction,
+    &MoveComponentData::move_speed,
+    &MoveComponentData::turn_speed,
+    &MoveComponentData::turn,
+    &MoveComponentData::move
+>;
+
+class MoveSystem
+: public ecs::EntitySystem<MoveComponentData, MoveComponentLayout>
 {
     virtual void initialize_component_data(
         size_t index,
@@ -43,52 +55,49 @@ public:
     static const common::SystemId Id = SYSTEM_ID_MOVE;
 
     float get_direction(const Component cmpnt) const {
-        return get_component_data(cmpnt).direction;
+        return get_field<&MoveComponentData::direction>(cmpnt);
     }
 
     //  Gets a normalized vector representing current heading
     glm::vec3 get_facing(const Component cmpnt) const;
+    static glm::vec3 get_facing(const MoveComponentData& data);
+    //  Systems read and written by update()
+    static engine::SystemAccess get_update_access();
 
     float get_speed(const Component cmpnt) const {
-        return get_component_data(cmpnt).move_speed;
+        return get_field<&MoveComponentData::move_speed>(cmpnt);
     }
 
     void move_backward(const Component cmpnt, float amount) {
-        auto& data = get_component_data(cmpnt);
-        data.move.y = std::clamp(-amount, -1.0f, 1.0f);
+        get_field<&MoveComponentData::move>(cmpnt).y = std::clamp(-amount, -1.0f, 1.0f);
     }
 
     void move_forward(const Component cmpnt, float amount) {
-        auto& data = get_component_data(cmpnt);
-        data.move.y = std::clamp(amount, -1.0f, 1.0f);
+        get_field<&MoveComponentData::move>(cmpnt).y = std::clamp(amount, -1.0f, 1.0f);
     }
 
     void move_left(const Component cmpnt, float amount) {
-        auto& data = get_component_data(cmpnt);
-        data.move.x = std::clamp(-amount, -1.0f, 1.0f);
+        get_field<&MoveComponentData::move>(cmpnt).x = std::clamp(-amount, -1.0f, 1.0f);
     }
 
     void move_right(const Component cmpnt, float amount) {
-        auto& data = get_component_data(cmpnt);
-        data.move.x = std::clamp(amount, -1.0f, 1.0f);
+        get_field<&MoveComponentData::move>(cmpnt).x = std::clamp(amount, -1.0f, 1.0f);
     }
 
     void set_move_speed(const Component cmpnt, float move_speed) {
-        get_component_data(cmpnt).move_speed = move_speed;
+        get_field<&MoveComponentData::move_speed>(cmpnt) = move_speed;
     }
 
     void set_turn_speed(const Component cmpnt, float turn_speed) {
-        get_component_data(cmpnt).turn_speed = turn_speed;
+        get_field<&MoveComponentData::turn_speed>(cmpnt) = turn_speed;
     }
 
     void turn_left(const Component cmpnt, float amount) {
-        auto& data = get_component_data(cmpnt);
-        data.turn = std::clamp(amount, -1.0f, 1.0f);
+        get_field<&MoveComponentData::turn>(cmpnt) = std::clamp(amount, -1.0f, 1.0f);
     }
 
     void turn_right(const Component cmpnt, float amount) {
-        auto& data = get_component_data(cmpnt);
-        data.turn = std::clamp(-amount, -1.0f, 1.0f);
+        get_field<&MoveComponentData::turn>(cmpnt) = std::clamp(-amount, -1.0f, 1.0f);
     }
 
     void update(engine::Game& game);
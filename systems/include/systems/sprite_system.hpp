@@ -3,6 +3,7 @@
 #include "ecs/entity_system.hpp"
 #include "systems/system_ids.hpp"
 #include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
 
 namespace systems
 {
@@ -10,12 +11,15 @@ struct SpriteComponentData
 {
     uint32_t texture_id;
     glm::vec2 size;
+    //  Texture coordinate offset in xy and size in zw
+    glm::vec4 uv_rect {0.0f, 0.0f, 1.0f, 1.0f};
 
     template <typename Archive>
     void archive(Archive& ar) {
         ar(
             texture_id,
-            size
+            size,
+            uv_rect
         );
     }
 };
@@ -35,6 +39,10 @@ public:
         return get_component_data(cmpnt).texture_id;
     }
 
+    glm::vec4 get_uv_rect(const Component cmpnt) const {
+        return get_component_data(cmpnt).uv_rect;
+    }
+
     static const common::SystemId Id = SYSTEM_ID_SPRITE;
 
     void set_size(const Component cmpnt, const glm::vec2 size)  {
@@ -44,5 +52,9 @@ public:
     void set_texture_id(const Component cmpnt, const uint32_t texture_id) {
         get_component_data(cmpnt).texture_id = texture_id;
     }
+
+    void set_uv_rect(const Component cmpnt, const glm::vec4 uv_rect) {
+        get_component_data(cmpnt).uv_rect = uv_rect;
+    }
 };
 }
@@ -77,7 +77,8 @@ void add_sprite_component(
     const ecs::Entity entity,
     SpriteSystem& sprite_sys,
     uint32_t texture_id,
-    const glm::vec2 size
+    const glm::vec2 size,
+    const glm::vec4 uv_rect = {0.0f, 0.0f, 1.0f, 1.0f}
 );
 
 BillboardSystem& get_billboard_system(engine::SystemManager& sys_mgr);
@@ -1,9 +1,11 @@
 #include "ecs/ecs_root.hpp"
+#include "ecs/view.hpp"
 #include "systems/camera_system.hpp"
 #include "systems/move_system.hpp"
 #include "systems/position_system.hpp"
 #include "systems/system_util.hpp"
 #include "engine/game.hpp"
+#include "engine/system_scheduler.hpp"
 #include "engine/time.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -14,6 +16,14 @@ using namespace engine;
 
 namespace systems
 {
+//  ----------------------------------------------------------------------------
+SystemAccess CameraSystem::get_update_access() {
+    return SystemAccess()
+        .read(MoveSystem::Id)
+        .read(PositionSystem::Id)
+        .write(CameraSystem::Id);
+}
+
 //  ----------------------------------------------------------------------------
 void CameraSystem::initialize_component_data(size_t index, CameraComponentData& data) {
     data.ortho = false;
@@ -28,19 +38,23 @@ void CameraSystem::update(Game& game) {
     MoveSystem& move_sys = get_move_system(sys_mgr);
     PositionSystem& pos_sys = get_position_system(sys_mgr);
 
-    const auto cmpnt_count = get_component_count();
-    for (auto cmpnt_index = 0; cmpnt_index < cmpnt_count; ++cmpnt_index) {
-        const Entity camera = get_entity_by_component_index(cmpnt_index);
+    View<CameraSystem, PositionSystem> view(*this, pos_sys);
+    view.for_each([elapsed_seconds, &move_sys, &pos_sys](
+        const Entity camera,
+        CameraComponentData& data,
+        const PositionComponentData& pos_data
+    ) {
+        //  Move system uses SoaLayout so it is not part of the view
+        if (!move_sys.has_component(camera)) {
+            return;
+        }
 
         //  Get camera direction (rotation)
-        const auto camera_move_cmpnt = move_sys.get_component(camera);
-        glm::vec3 facing = move_sys.get_facing(camera_move_cmpnt);
+        const auto move_cmpnt = move_sys.get_component(camera);
+        glm::vec3 facing = move_sys.get_facing(move_cmpnt);
 
         //  Get camera position
-        const auto camera_pos_cmpnt = pos_sys.get_component(camera);
-        glm::vec3 camera_pos = pos_sys.get_position(camera_pos_cmpnt);
-
-        auto& data = get_component_data(cmpnt_index);
+        glm::vec3 camera_pos = pos_data.position;
 
         //  Update zoom
         data.distance = std::clamp(
@@ -92,6 +106,6 @@ void CameraSystem::update(Game& game) {
         }
 
         data.zoom_direction = 0;
-    }
+    });
 }
 }
@@ -1,21 +1,39 @@
+#include "common/thread_pool.hpp"
+#include "engine/engine.hpp"
 #include "engine/game.hpp"
+#include "engine/system_scheduler.hpp"
 #include "engine/time.hpp"
 #include "systems/move_system.hpp"
 #include "systems/position_system.hpp"
 #include "systems/system_util.hpp"
 #include <glm/gtx/rotate_vector.hpp>
+#include <algorithm>
 
 using namespace ecs;
 using namespace engine;
 
 namespace systems
 {
+//  Number of entities processed per worker thread task
+static const size_t UPDATE_CHUNK_SIZE = 4096;
+
 //  ----------------------------------------------------------------------------
 glm::vec3 MoveSystem::get_facing(const Component cmpnt) const {
-    auto& data = get_component_data(cmpnt.index);
+    return glm::rotateZ(glm::vec3(0.0f, 1.0f, 0.0f), get_direction(cmpnt));
+}
+
+//  ----------------------------------------------------------------------------
+glm::vec3 MoveSystem::get_facing(const MoveComponentData& data) {
     return glm::rotateZ(glm::vec3(0.0f, 1.0f, 0.0f), data.direction);
 }
 
+//  ----------------------------------------------------------------------------
+SystemAccess MoveSystem::get_update_access() {
+    return SystemAccess()
+        .write(MoveSystem::Id)
+        .write(PositionSystem::Id);
+}
+
 //  ----------------------------------------------------------------------------
 void MoveSystem::initialize_component_data(
     size_t index,
@@ -31,27 +49,42 @@ void MoveSystem::update(engine::Game& game) {
 
     SystemManager& sys_mgr = game.get_system_manager();
     PositionSystem& pos_sys = get_position_system(sys_mgr);
+    common::ThreadPool& thread_pool = game.get_engine().get_thread_pool();
 
-    const auto cmpnt_count = get_component_count();
-    for (auto cmpnt_index = 0; cmpnt_index < cmpnt_count; ++cmpnt_index) {
-        const Entity entity = get_entity_by_component_index(cmpnt_index);
-
-        auto& data = get_component_data(cmpnt_index);
+    const std::vector<Entity>& entities = get_entities();
+    auto& directions = get_field_array<&MoveComponentData::direction>();
+    auto& moves = get_field_array<&MoveComponentData::move>();
+    auto& move_speeds = get_field_array<&MoveComponentData::move_speed>();
+    auto& turns = get_field_array<&MoveComponentData::turn>();
+    auto& turn_speeds = get_field_array<&MoveComponentData::turn_speed>();
 
-        //  Update direction
-        data.direction += data.turn * data.turn_speed * elapsed_seconds;
+    //  Each entity only writes its own move and position components so
+    //  chunks can be updated in parallel.
+    thread_pool.parallel_for(
+        get_component_count(),
+        UPDATE_CHUNK_SIZE,
+        [&](const size_t begin, const size_t end) {
+            //  Update direction
+            for (size_t n = begin; n < end; ++n) {
+                directions[n] += turns[n] * turn_speeds[n] * elapsed_seconds;
+            }
 
-        //  Get position
-        const auto pos_cmpnt = pos_sys.get_component(entity);
-        glm::vec3 position = pos_sys.get_position(pos_cmpnt);
+            //  Update position
+            for (size_t n = begin; n < end; ++n) {
+                const Entity entity = entities[n];
+                if (!pos_sys.has_component(entity)) {
+                    continue;
+                }
 
-        //  Update position
-        glm::vec3 delta = glm::rotateZ(data.move, data.direction) * data.move_speed * elapsed_seconds;
-        pos_sys.set_position(pos_cmpnt, position + delta);
+                const auto pos_cmpnt = pos_sys.get_component(entity);
+                glm::vec3 delta = glm::rotateZ(moves[n], directions[n]) * move_speeds[n] * elapsed_seconds;
+                pos_sys.get_position(pos_cmpnt) += delta;
+            }
 
-        //  Reset for next frame
-        data.move = glm::vec3(0);
-        data.turn = 0;
-    }
+            //  Reset for next frame
+            std::fill(moves.begin() + begin, moves.begin() + end, glm::vec3(0));
+            std::fill(turns.begin() + begin, turns.begin() + end, 0.0f);
+        }
+    );
 }
 }
@@ -135,7 +135,8 @@ void add_sprite_component(
     const Entity entity,
     SpriteSystem& sprite_sys,
     uint32_t texture_id,
-    const glm::vec2 size
+    const glm::vec2 size,
+    const glm::vec4 uv_rect
 ) {
     if (!sprite_sys.has_component(entity)) {
         sprite_sys.add_component(entity);
@@ -144,6 +145,7 @@ void add_sprite_component(
     const auto sprite_cmpnt = sprite_sys.get_component(entity);
     sprite_sys.set_texture_id(sprite_cmpnt, texture_id);
     sprite_sys.set_size(sprite_cmpnt, size);
+    sprite_sys.set_uv_rect(sprite_cmpnt, uv_rect);
 }
 
 //  ----------------------------------------------------------------------------